@@ -0,0 +1,117 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "MappedFile.h"
+
+#if WINDOWS
+#include "windows.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Surge
+{
+namespace Storage
+{
+std::shared_ptr<MappedFile> MappedFile::map(const fs::path &p)
+{
+    // the constructor is private, so no make_shared
+    auto res = std::shared_ptr<MappedFile>(new MappedFile());
+
+#if WINDOWS
+    auto fh = CreateFileW(p.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                          OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (fh == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    LARGE_INTEGER sz;
+
+    if (!GetFileSizeEx(fh, &sz) || sz.QuadPart <= 0)
+    {
+        CloseHandle(fh);
+        return nullptr;
+    }
+
+    // the view keeps the file open, so we can let go of our handle straight away
+    auto mh = CreateFileMappingW(fh, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    CloseHandle(fh);
+
+    if (!mh)
+        return nullptr;
+
+    auto view = MapViewOfFile(mh, FILE_MAP_COPY, 0, 0, 0);
+
+    if (!view)
+    {
+        CloseHandle(mh);
+        return nullptr;
+    }
+
+    res->mapHandle = mh;
+    res->ptr = static_cast<char *>(view);
+    res->len = (size_t)sz.QuadPart;
+#else
+    auto fd = open(p.c_str(), O_RDONLY);
+
+    if (fd < 0)
+        return nullptr;
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    // likewise the mapping outlives the descriptor
+    auto addr = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (addr == MAP_FAILED)
+        return nullptr;
+
+    res->ptr = static_cast<char *>(addr);
+    res->len = (size_t)st.st_size;
+#endif
+
+    return res;
+}
+
+MappedFile::~MappedFile()
+{
+    if (!ptr)
+        return;
+
+#if WINDOWS
+    UnmapViewOfFile(ptr);
+    CloseHandle(mapHandle);
+#else
+    munmap(ptr, len);
+#endif
+}
+} // namespace Storage
+} // namespace Surge
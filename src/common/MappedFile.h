@@ -0,0 +1,68 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_MAPPEDFILE_H
+#define SURGE_SRC_COMMON_MAPPEDFILE_H
+
+#include <cstddef>
+#include <memory>
+#include "filesystem/import.h"
+
+namespace Surge
+{
+namespace Storage
+{
+/*
+ * A whole file mapped into memory, for the loaders which can use file contents in place.
+ *
+ * The mapping is copy on write, so a stray write through it costs a page copy and never
+ * reaches the file. The usual caveat applies though: if the file is truncated while mapped,
+ * touching the lost pages faults on POSIX systems (Windows refuses the truncation instead),
+ * so only map files which we expect to be left alone while in use (in practice, factory
+ * content).
+ */
+class MappedFile
+{
+  public:
+    // returns nullptr if the file can't be opened or mapped, or is empty
+    static std::shared_ptr<MappedFile> map(const fs::path &p);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    char *data() const { return ptr; }
+    size_t size() const { return len; }
+
+  private:
+    MappedFile() = default;
+
+    char *ptr{nullptr};
+    size_t len{0};
+#if WINDOWS
+    void *mapHandle{nullptr};
+#endif
+};
+} // namespace Storage
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_MAPPEDFILE_H
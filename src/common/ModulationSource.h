@@ -26,6 +26,7 @@
 #include <random>
 #include <cassert>
 
+#include "globals.h"
 #include "basic_dsp.h"
 
 enum modsrctype
@@ -581,6 +582,91 @@ template <int NDX = 1> class ControllerModulationSourceVector : public Modulatio
         return res;
     }
 
+    /*
+     * Steps up to four controllers at once. Those smoothing exponentially share one pass, each in
+     * a lane of the SSE registers, and the rest step on their own. With untilClose this is
+     * process_block_until_close(closeSigma) on each, setting cont to what each returns, and
+     * otherwise it is the base class process_block on each. The result is the same either way.
+     */
+    static void processSmoothingQuad(ControllerModulationSourceVector *const *c, int n,
+                                     bool untilClose, float closeSigma = 0.f,
+                                     bool *cont = nullptr)
+    {
+        static_assert(NDX == 1, "Only single output controllers step in quads");
+
+        float v alignas(16)[4]{}, t alignas(16)[4]{}, rate alignas(16)[4]{},
+            sigma alignas(16)[4]{};
+        int lane[4];
+        int nl = 0;
+
+        for (int i = 0; i < n; ++i)
+        {
+            auto *s = c[i];
+            auto mode = s->smoothingMode;
+            float sg = (mode == Modulator::SmoothingMode::FAST_EXP) ? 0.005f : 0.0025f;
+
+            if (untilClose)
+            {
+                sg = closeSigma;
+
+                if (mode == Modulator::SmoothingMode::LEGACY)
+                {
+                    mode = Modulator::SmoothingMode::SLOW_EXP;
+                }
+            }
+
+            if (mode == Modulator::SmoothingMode::LEGACY ||
+                mode == Modulator::SmoothingMode::SLOW_EXP ||
+                mode == Modulator::SmoothingMode::FAST_EXP)
+            {
+                assert(s->samplerate > 1000);
+
+                v[nl] = s->value[0];
+                t[nl] = s->target[0];
+                rate[nl] =
+                    (mode == Modulator::SmoothingMode::FAST_EXP ? 0.99f : 0.9f) * 44100 *
+                    s->samplerate_inv;
+                // the legacy mode never snaps to the target, and no distance is below -1
+                sigma[nl] = (mode == Modulator::SmoothingMode::LEGACY) ? -1.f : sg;
+                lane[nl++] = i;
+            }
+            else
+            {
+                s->processSmoothing(mode, sg);
+            }
+        }
+
+        if (nl)
+        {
+            const auto zero = _mm_setzero_ps(), one = _mm_set1_ps(1.f);
+            auto vv = _mm_load_ps(v), tv = _mm_load_ps(t);
+
+            auto b = _mm_andnot_ps(_mm_set1_ps(-0.f), _mm_sub_ps(tv, vv));
+            auto a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_load_ps(rate), b), zero), one);
+            auto smoothed = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(one, a), vv), _mm_mul_ps(a, tv));
+
+            auto snap = _mm_cmplt_ps(b, _mm_load_ps(sigma));
+            _mm_store_ps(v, _mm_or_ps(_mm_and_ps(snap, tv), _mm_andnot_ps(snap, smoothed)));
+
+            for (int l = 0; l < nl; ++l)
+            {
+                auto *s = c[lane[l]];
+                s->value[0] = v[l];
+
+                // Just in case #6835 sneaks back
+                assert(!std::isnan(s->value[0]) && !std::isinf(s->value[0]));
+            }
+        }
+
+        if (untilClose && cont)
+        {
+            for (int i = 0; i < n; ++i)
+            {
+                cont[i] = (c[i]->value[0] != c[i]->target[0]);
+            }
+        }
+    }
+
     virtual bool is_bipolar() override { return bipolar; }
     virtual void set_bipolar(bool b) override { bipolar = b; }
 
@@ -26,14 +26,133 @@
 #include "SurgeStorage.h"
 #include "MemoryPool.h"
 #include "SSESincDelayLine.h"
+#include "Oscillator.h"
+#include "TwistOscillator.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace Surge
 {
 namespace Memory
 {
+/*
+ * How a StagedMemoryPool wakes SurgeMemoryPools' grower thread. post is called from the audio
+ * thread, so it notifies without taking the lock.
+ */
+struct PoolGrowerSignal
+{
+    std::mutex lock;
+    std::condition_variable cv;
+    std::atomic<bool> posted{false};
+
+    void post()
+    {
+        posted = true;
+        cv.notify_one();
+    }
+};
+
+/*
+ * A MemoryPool which the audio thread draws from, plus a staging area which another thread
+ * tops up. When the audio thread sees the pool running low it flags that it wants more,
+ * posts the grower signal the first time it does, and takes whatever has been staged, but
+ * only if it can get the staging lock without waiting; growOffAudioThread (called from
+ * SurgeMemoryPools' grower thread) does the actual allocation. If nobody grows the pool in
+ * time it still grows itself on getItem like any MemoryPool.
+ */
+template <typename T, size_t preAlloc, size_t growBy, size_t capacity> struct StagedMemoryPool
+{
+    static constexpr size_t lowWater = 2 * growBy;
+
+    template <typename... Args> StagedMemoryPool(Args &&...args) : pool(args...) {}
+    ~StagedMemoryPool()
+    {
+        for (auto t : staged)
+            delete t;
+    }
+
+    template <typename... Args> T *getItem(Args &&...args)
+    {
+        if (pool.position <= lowWater)
+        {
+            std::unique_lock<std::mutex> g(stagingLock, std::try_to_lock);
+
+            if (g.owns_lock())
+            {
+                while (!staged.empty() && pool.position < capacity)
+                {
+                    pool.returnItem(staged.back());
+                    staged.pop_back();
+                }
+            }
+
+            if (!wantsMore.exchange(true) && grower)
+                grower->post();
+        }
+
+        return pool.getItem(std::forward<Args>(args)...);
+    }
+    void returnItem(T *t) { pool.returnItem(t); }
+
+    template <typename... Args> void growOffAudioThread(Args &&...args)
+    {
+        if (!wantsMore.exchange(false))
+            return;
+
+        T *fresh[lowWater];
+        for (auto &f : fresh)
+            f = new T(args...);
+
+        std::lock_guard<std::mutex> g(stagingLock);
+        staged.insert(staged.end(), std::begin(fresh), std::end(fresh));
+    }
+
+    template <typename... Args> void setupPoolToSize(size_t upTo, Args &&...args)
+    {
+        pool.setupPoolToSize(upTo, std::forward<Args>(args)...);
+    }
+    void returnToPreAllocSize() { pool.returnToPreAllocSize(); }
+
+    size_t itemsHeld()
+    {
+        std::lock_guard<std::mutex> g(stagingLock);
+        return pool.position + staged.size();
+    }
+
+    MemoryPool<T, preAlloc, growBy, capacity> pool;
+    std::mutex stagingLock;
+    std::vector<T *> staged;
+    std::atomic<bool> wantsMore{false};
+    PoolGrowerSignal *grower{nullptr};
+};
+
 struct SurgeMemoryPools
 {
-    SurgeMemoryPools(SurgeStorage *s) : stringDelayLines(s->sinctable) {}
+    SurgeMemoryPools(SurgeStorage *s)
+        : stringDelayLinesShort(s->sinctable), stringDelayLinesMedium(s->sinctable),
+          stringDelayLinesLong(s->sinctable)
+    {
+        stringDelayLinesShort.grower = &growerSignal;
+        stringDelayLinesMedium.grower = &growerSignal;
+        stringDelayLinesLong.grower = &growerSignal;
+        twistResources.grower = &growerSignal;
+
+        grower = std::thread([this, s]() { growerLoop(s); });
+    }
+
+    ~SurgeMemoryPools()
+    {
+        {
+            std::lock_guard<std::mutex> g(growerSignal.lock);
+            keepGrowing = false;
+        }
+        growerSignal.cv.notify_all();
+        grower.join();
+    }
 
     /*
      * The largest number of oscillator instances of a particular
@@ -42,16 +161,99 @@ struct SurgeMemoryPools
     static constexpr int maxosc = n_scenes * n_oscs * (MAX_VOICES + 8);
 
     /*
-     * The string needs 2 delay lines per oscillator
+     * The string needs 2 delay lines per oscillator. They come in three lengths and a voice
+     * picks the shortest which fits the lowest pitch it expects to play (see
+     * StringOscillator::init), since most notes need far less than the 16k taps which
+     * the lowest notes and FM need.
+     */
+    using stringDelayShort_t = SSESincDelayLine<1024>;
+    using stringDelayMedium_t = SSESincDelayLine<4096>;
+    using stringDelayLong_t = SSESincDelayLine<16384>;
+
+    StagedMemoryPool<stringDelayShort_t, 8, 4, 2 * maxosc + 100> stringDelayLinesShort;
+    StagedMemoryPool<stringDelayMedium_t, 8, 4, 2 * maxosc + 100> stringDelayLinesMedium;
+    StagedMemoryPool<stringDelayLong_t, 8, 4, 2 * maxosc + 100> stringDelayLinesLong;
+
+    template <typename DL> auto &stringDelayLines()
+    {
+        if constexpr (std::is_same_v<DL, stringDelayShort_t>)
+            return stringDelayLinesShort;
+        else if constexpr (std::is_same_v<DL, stringDelayMedium_t>)
+            return stringDelayLinesMedium;
+        else
+            return stringDelayLinesLong;
+    }
+
+    /*
+     * The plaits voice, its scratch memory and the resamplers for each Twist oscillator.
+     * These are large, so we only hold one until a patch uses Twist.
+     */
+    StagedMemoryPool<TwistOscillator::Resources, 1, 2, maxosc + 100> twistResources;
+
+    /*
+     * The oscillators voices copy at note on; see OscillatorPrototype. They are rebuilt when
+     * a patch loads and otherwise lazily, by the first voice to find theirs stale.
      */
-    MemoryPool<SSESincDelayLine<16384>, 8, 4, 2 * maxosc + 100> stringDelayLines;
+    OscillatorPrototype oscPrototypes[n_scenes][n_oscs];
+
+    // the bytes held by the string delay pools, in and out of use
+    size_t stringDelayLineBytes()
+    {
+        return stringDelayLinesShort.itemsHeld() * sizeof(stringDelayShort_t) +
+               stringDelayLinesMedium.itemsHeld() * sizeof(stringDelayMedium_t) +
+               stringDelayLinesLong.itemsHeld() * sizeof(stringDelayLong_t);
+    }
+
+    // call this from a thread other than the audio thread
+    void growPoolsOffAudioThread(SurgeStorage *storage)
+    {
+        stringDelayLinesShort.growOffAudioThread(storage->sinctable);
+        stringDelayLinesMedium.growOffAudioThread(storage->sinctable);
+        stringDelayLinesLong.growOffAudioThread(storage->sinctable);
+        twistResources.growOffAudioThread();
+    }
+
+    /*
+     * The audio thread only raises a flag when a pool runs low, so rather than rely on a UI
+     * (which headless and GUI-less hosts don't have) a thread of our own sleeps until a pool
+     * posts growerSignal and then does the allocation. Since post doesn't take the lock, a
+     * post landing between the check and the wait is missed; the backstop bounds how long
+     * that pool then waits, and it can still grow itself meanwhile.
+     */
+    static constexpr auto growerBackstop = std::chrono::seconds(1);
+    std::thread grower;
+    PoolGrowerSignal growerSignal;
+    bool keepGrowing{true};
+
+    void growerLoop(SurgeStorage *storage)
+    {
+        std::unique_lock<std::mutex> lk(growerSignal.lock);
+
+        while (keepGrowing)
+        {
+            growerSignal.cv.wait_for(lk, growerBackstop,
+                                     [this]() { return growerSignal.posted || !keepGrowing; });
+
+            if (!keepGrowing)
+                break;
+
+            growerSignal.posted = false;
+
+            lk.unlock();
+            growPoolsOffAudioThread(storage);
+            lk.lock();
+        }
+    }
+
     void resetAllPools(SurgeStorage *storage) { resetOscillatorPools(storage); }
     void resetOscillatorPools(SurgeStorage *storage)
     {
         bool hasString{false}, hasTwist{false};
-        int nString{0};
+        int nString{0}, nStringFM{0}, nTwist{0};
         for (int s = 0; s < n_scenes; ++s)
         {
+            auto fm = storage->getPatch().scene[s].fm_switch.val.i;
+
             for (int os = 0; os < n_oscs; ++os)
             {
                 auto ot = storage->getPatch().scene[s].osc[os].type.val.i;
@@ -60,19 +262,55 @@ struct SurgeMemoryPools
                 {
                     hasString = true;
                     nString++;
+
+                    if ((os == 0 && fm != fm_off) || (os == 1 && fm == fm_3to2to1))
+                        nStringFM++;
                 }
                 hasTwist |= (ot == ot_twist);
+                nTwist += (ot == ot_twist);
             }
         }
 
         if (hasString)
         {
-            int maxUsed = nString * 2 * storage->getPatch().polylimit.val.i;
-            stringDelayLines.setupPoolToSize((int)(maxUsed * 0.5), storage->sinctable);
+            /*
+             * FM modulated strings always use the long lines. Otherwise most voices land
+             * in the medium lines, with the short ones for the upper register and the
+             * long ones for the bottom.
+             */
+            int poly = storage->getPatch().polylimit.val.i;
+            int maxUsed = (nString - nStringFM) * 2 * poly;
+            int maxUsedFM = nStringFM * 2 * poly;
+
+            stringDelayLinesShort.setupPoolToSize((int)(maxUsed * 0.25), storage->sinctable);
+            stringDelayLinesMedium.setupPoolToSize((int)(maxUsed * 0.5), storage->sinctable);
+            stringDelayLinesLong.setupPoolToSize((int)(maxUsed * 0.125 + maxUsedFM * 0.5),
+                                                 storage->sinctable);
         }
         else
         {
-            stringDelayLines.returnToPreAllocSize();
+            stringDelayLinesShort.returnToPreAllocSize();
+            stringDelayLinesMedium.returnToPreAllocSize();
+            stringDelayLinesLong.returnToPreAllocSize();
+        }
+
+        if (hasTwist)
+        {
+            twistResources.setupPoolToSize(nTwist * storage->getPatch().polylimit.val.i);
+        }
+        else
+        {
+            twistResources.returnToPreAllocSize();
+        }
+
+        for (int s = 0; s < n_scenes; ++s)
+        {
+            for (int os = 0; os < n_oscs; ++os)
+            {
+                auto &osc = storage->getPatch().scene[s].osc[os];
+                oscPrototypes[s][os].rebuild(osc.type.val.i, storage, &osc,
+                                             storage->getPatch().scenedata[s]);
+            }
         }
     }
 };
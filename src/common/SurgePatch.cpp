@@ -3028,6 +3028,13 @@ void SurgePatch::load_xml(const void *data, int datasize, bool is_preset)
                 dawExtraState.oddsoundRetuneMode = SurgeStorage::RETUNE_CONSTANT;
             }
 
+            p = TINYXML_SAFE_TO_ELEMENT(de->FirstChild("approximateWaveshapers"));
+
+            if (p && p->QueryIntAttribute("v", &ival) == TIXML_SUCCESS)
+            {
+                dawExtraState.approximateWaveshapers = ival;
+            }
+
             p = TINYXML_SAFE_TO_ELEMENT(de->FirstChild("tuningApplicationMode"));
 
             if (p && p->QueryIntAttribute("v", &ival) == TIXML_SUCCESS)
@@ -3789,6 +3796,10 @@ unsigned int SurgePatch::save_xml(void **data) // allocates mem, must be freed b
         osd.SetAttribute("v", dawExtraState.oddsoundRetuneMode);
         dawExtraXML.InsertEndChild(osd);
 
+        TiXmlElement aws("approximateWaveshapers");
+        aws.SetAttribute("v", dawExtraState.approximateWaveshapers ? 1 : 0);
+        dawExtraXML.InsertEndChild(aws);
+
         TiXmlElement tam("tuningApplicationMode");
         tam.SetAttribute("v", dawExtraState.tuningApplicationMode);
         dawExtraXML.InsertEndChild(tam);
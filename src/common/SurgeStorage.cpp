@@ -50,12 +50,14 @@
 #include "FxPresetAndClipboardManager.h"
 #include "ModulatorPresetManager.h"
 #include "SurgeMemoryPools.h"
+#include "MappedFile.h"
 #include "sst/basic-blocks/tables/SincTableProvider.h"
 
 // FIXME probably remove this when we remove the hardcoded hack below
 #include "MSEGModulationHelper.h"
 // FIXME
 #include "FormulaModulationHelper.h"
+#include "WavetableScriptEvaluator.h"
 
 #include "sst/basic-blocks/mechanics/endian-ops.h"
 namespace mech = sst::basic_blocks::mechanics;
@@ -392,6 +394,7 @@ SurgeStorage::SurgeStorage(const SurgeStorage::SurgeStorageConfig &config) : oth
     userPatchesMidiProgramChangePath = userPatchesPath / midiProgramChangePatchesSubdir;
     userWavetablesPath = userDataPath / "Wavetables";
     userWavetablesExportPath = userWavetablesPath / "Exported";
+    userWavetableCachePath = userDataPath / "Cache" / "Wavetables";
     userFXPath = userDataPath / "FX Presets";
     userMidiMappingsPath = userDataPath / "MIDI Mappings";
     userModulatorSettingsPath = userDataPath / "Modulator Presets";
@@ -581,6 +584,18 @@ SurgeStorage::SurgeStorage(const SurgeStorage::SurgeStorageConfig &config) : oth
     monoPedalMode = (MonoPedalMode)Surge::Storage::getUserDefaultValue(
         this, Surge::Storage::MonoPedalMode, MonoPedalMode::HOLD_ALL_NOTES);
 
+    useWavetableDiskCache =
+        Surge::Storage::getUserDefaultValue(this, Surge::Storage::UseWavetableDiskCache, true);
+
+    useOctFilterChain =
+        Surge::Storage::getUserDefaultValue(this, Surge::Storage::UseOctFilterChain, false);
+
+    useFixedFilterChains =
+        Surge::Storage::getUserDefaultValue(this, Surge::Storage::UseFixedFilterChains, false);
+
+    approximateWaveshapers =
+        Surge::Storage::getUserDefaultValue(this, Surge::Storage::ApproximateWaveshapers, false);
+
     for (int s = 0; s < n_scenes; ++s)
     {
         getPatch().scene[s].drift.set_extend_range(true);
@@ -1374,7 +1389,48 @@ void SurgeStorage::load_wt(string filename, Wavetable *wt, OscillatorStorage *os
 
     bool loaded = false;
 
-    if (extension.compare(".wt") == 0)
+    /*
+     * If this file (at this size and modification time) is already loaded somewhere in the
+     * process, share its built tables rather than reading and mipmapping it again. A .wav
+     * being loaded with a one-off frame size override isn't the canonical build of that
+     * file, so it skips the cache.
+     */
+    WavetableCache::Key cacheKey;
+    bool cacheable = (extension.compare(".wt") == 0 || extension.compare(".wav") == 0) &&
+                     wt->frame_size_if_absent <= 0 &&
+                     WavetableCache::keyFor(filename, cacheKey);
+
+    std::shared_ptr<WavetableData> cached;
+
+    /*
+     * Failing that, we may have built it in an earlier session and persisted the pyramid.
+     */
+    bool diskCacheable = cacheable && useWavetableDiskCache && userDataPathValid &&
+                         !userWavetableCachePath.empty();
+
+    if (cacheable)
+    {
+        cached = WavetableCache::find(cacheKey);
+
+        if (!cached && diskCacheable)
+        {
+            cached = WavetableDiskCache::read(userWavetableCachePath, cacheKey);
+
+            if (cached)
+            {
+                WavetableCache::insert(cacheKey, cached);
+            }
+        }
+    }
+
+    if (cached)
+    {
+        waveTableDataMutex.lock();
+        wt->adoptData(cached);
+        waveTableDataMutex.unlock();
+        loaded = true;
+    }
+    else if (extension.compare(".wt") == 0)
     {
         loaded = load_wt_wt(filename, wt);
     }
@@ -1390,6 +1446,16 @@ void SurgeStorage::load_wt(string filename, Wavetable *wt, OscillatorStorage *os
         reportError(oss.str(), "Error");
     }
 
+    if (cacheable && loaded && !cached)
+    {
+        WavetableCache::insert(cacheKey, wt->getData());
+
+        if (diskCacheable)
+        {
+            wavetableDiskCacheWriter.enqueue(userWavetableCachePath, cacheKey, wt->getData());
+        }
+    }
+
     if (osc && loaded)
     {
         auto fn = filename.substr(filename.find_last_of(PATH_SEPARATOR) + 1, filename.npos);
@@ -1402,8 +1468,53 @@ void SurgeStorage::load_wt(string filename, Wavetable *wt, OscillatorStorage *os
     }
 }
 
+bool SurgeStorage::isFactoryDataFile(const fs::path &p) const
+{
+    if (datapath.empty())
+    {
+        return false;
+    }
+
+    std::error_code ec;
+    auto file = fs::weakly_canonical(p, ec);
+
+    if (ec)
+    {
+        return false;
+    }
+
+    auto root = fs::weakly_canonical(datapath, ec);
+
+    if (ec || root.empty())
+    {
+        return false;
+    }
+
+    auto ri = root.begin(), fi = file.begin();
+
+    for (; ri != root.end(); ++ri, ++fi)
+    {
+        if (fi == file.end() || *ri != *fi)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 bool SurgeStorage::load_wt_wt(string filename, Wavetable *wt)
 {
+    /*
+     * Only factory content is mapped in place. A user's own file can be rewritten or
+     * truncated while we play it (which would change the audio or fault on the audio
+     * thread), and on Windows a mapping would stop them saving it, so those are read.
+     */
+    if (isFactoryDataFile(string_to_path(filename)) && load_wt_wt_mapped(filename, wt))
+    {
+        return true;
+    }
+
     std::filebuf f;
 
     if (!f.open(string_to_path(filename), std::ios::binary | std::ios::in))
@@ -1476,6 +1587,65 @@ bool SurgeStorage::load_wt_wt(string filename, Wavetable *wt)
     return wasBuilt;
 }
 
+bool SurgeStorage::load_wt_wt_mapped(string filename, Wavetable *wt)
+{
+    /*
+     * The frames of a float .wt file are laid out exactly like the level 0 float tables, so
+     * rather than reading the file into a buffer for BuildWT to copy again, map it and have
+     * the table reference it in place; only the int16 tables and the mip levels are built.
+     * The file has to stay as it is while it is mapped, which is why load_wt_wt only comes
+     * here for factory content.
+     *
+     * Anything this doesn't handle (int16 data, short or odd files, big endian hosts, or
+     * files small enough that mapping them isn't worth a file mapping) returns false and
+     * takes the regular path, which also does the error reporting.
+     */
+    static constexpr size_t minimumMappedBytes = 64 * 1024;
+
+    if (mech::endian_read_int32LE(0x01020304) != 0x01020304)
+    {
+        return false;
+    }
+
+    auto f = Surge::Storage::MappedFile::map(string_to_path(filename));
+
+    if (!f || f->size() < sizeof(wt_header) + minimumMappedBytes)
+    {
+        return false;
+    }
+
+    wt_header wh;
+    memcpy(&wh, f->data(), sizeof(wt_header));
+
+    if (!(wh.tag[0] == 'v' && wh.tag[1] == 'a' && wh.tag[2] == 'w' && wh.tag[3] == 't'))
+    {
+        return false;
+    }
+
+    int flags = mech::endian_read_int16LE(wh.flags);
+    int n_tables = mech::endian_read_int16LE(wh.n_tables);
+    int n_samples = mech::endian_read_int32LE(wh.n_samples);
+
+    if ((flags & wtf_int16) || n_tables <= 0 || n_tables > max_subtables || n_samples <= 0 ||
+        n_samples > max_wtable_size)
+    {
+        return false;
+    }
+
+    size_t ds = sizeof(float) * (size_t)n_tables * (size_t)n_samples;
+
+    if (ds < minimumMappedBytes || f->size() < sizeof(wt_header) + ds)
+    {
+        return false;
+    }
+
+    waveTableDataMutex.lock();
+    bool wasBuilt = wt->BuildWTMapped(f, sizeof(wt_header), wh);
+    waveTableDataMutex.unlock();
+
+    return wasBuilt;
+}
+
 bool SurgeStorage::load_wt_wt_mem(const char *data, size_t dataSize, Wavetable *wt)
 {
     wt_header wh;
@@ -2680,8 +2850,8 @@ bool SurgeStorage::resetToCurrentScaleAndMapping()
         }
         MTS_SetScaleName(currentTuning.scale.description.c_str());
     }
-    tuningUpdates++;
 #endif
+    tuningUpdates++;
     return true;
 }
 
@@ -837,6 +837,33 @@ struct MSEGStorage
     float durationLoopStartToLoopEnd;
     float envelopeModeDuration = -1, envelopeModeNV1 = -2; // -2 as sentinel since NV1 is -1/1
 
+    /*
+     * Also cached by rebuildCache, so that evaluation doesn't redo the work every block.
+     *
+     * The time index splits [0, totalDuration) into equal cells and holds, for each, the
+     * first segment ending after the cell starts, so finding the segment at a time is a lookup
+     * and a step or two rather than a walk from the start. timeIndexScale is cells per unit of
+     * time, or 0 if there is no index (which is also the case if the segment times aren't in
+     * order).
+     *
+     * The coefficients are the parts of each segment's curve which only depend on its control
+     * point. They are only used while cpv still matches the segment's.
+     */
+    static constexpr int timeIndexSize = 2 * max_msegs;
+    std::array<int16_t, timeIndexSize> timeIndex{};
+    double timeIndexScale = 0;
+
+    struct SegmentCoefficients
+    {
+        bool valid = false;
+        float cpv = 0;
+        float curveA = 0;     // LINEAR and SCURVE control point curvature
+        double curveExpA = 1; // and exp(curveA), at the precision exp gave it
+        int waveSteps = 0;    // SINE, SAWTOOTH, TRIANGLE and SQUARE
+        int stairSteps = 0;   // STAIRS and SMOOTH_STAIRS
+    };
+    std::array<SegmentCoefficients, max_msegs> segmentCoefficients{};
+
     /*
      * These "UI" type things we decided, late in 1.8, are actually a critical part of
      * the modelling experience, so even if they aren't required to actually evaluate
@@ -863,10 +890,14 @@ struct FormulaModulatorStorage
         LUA = 1001
     } interpreter = LUA;
 
+    // bumped whenever the formula is set, even to the same text; see Surge::Formula::OverrunRecord
+    uint32_t generation = 0;
+
     void setFormula(const std::string &s)
     {
         formulaString = s;
         formulaHash = std::hash<std::string>{}(s);
+        generation++;
     }
 };
 
@@ -980,6 +1011,8 @@ struct DAWExtraStateStorage
     int monoPedalMode = 0;
     int oddsoundRetuneMode = 0;
 
+    bool approximateWaveshapers{false};
+
     int tuningApplicationMode = 1; // RETUNE_MIDI_ONLY
 
     bool isDirty{false};
@@ -1191,6 +1224,10 @@ namespace Formula
 {
 struct GlobalData;
 }
+namespace WavetableScript
+{
+class GeneratorPool;
+}
 } // namespace Surge
 
 namespace sst::basic_blocks::tables
@@ -1314,6 +1351,8 @@ class alignas(16) SurgeStorage
 
     std::unique_ptr<SurgePatch> _patch;
     std::unique_ptr<Surge::Formula::GlobalData> formulaGlobalData;
+    // created the first time a scripted wavetable is generated
+    std::unique_ptr<Surge::WavetableScript::GeneratorPool> wavetableScriptPool;
 
     // SurgePatch &getPatch();
     SurgePatch &getPatch() const;
@@ -1361,7 +1400,16 @@ class alignas(16) SurgeStorage
     void load_wt(std::string filename, Wavetable *wt, OscillatorStorage *);
     bool load_wt_wt(std::string filename, Wavetable *wt);
     bool load_wt_wt_mem(const char *data, const size_t dataSize, Wavetable *wt);
+    bool load_wt_wt_mapped(std::string filename, Wavetable *wt);
+    // true if p is inside datapath, which we treat as read only factory content
+    bool isFactoryDataFile(const fs::path &p) const;
     bool load_wt_wav_portable(std::string filename, Wavetable *wt);
+    /*
+     * If set (from the UseWavetableDiskCache user default) built wavetables are persisted to
+     * userWavetableCachePath and restored from there on the next load of the same file.
+     */
+    bool useWavetableDiskCache{true};
+    WavetableDiskCacheWriter wavetableDiskCacheWriter;
     std::string export_wt_wav_portable(std::string fbase, Wavetable *wt);
     void clipboard_copy(int type, int scene, int entry, modsources ms = ms_original);
     // this function is a bit of a hack to stop me having a reference to SurgeSynth here
@@ -1408,6 +1456,7 @@ class alignas(16) SurgeStorage
     fs::path userModulatorSettingsPath;
     fs::path userFXPath;
     fs::path userWavetablesExportPath;
+    fs::path userWavetableCachePath;
     fs::path userSkinsPath;
     fs::path userMidiMappingsPath;
     fs::path extraThirdPartyWavetablesPath; // used by rack
@@ -1435,6 +1484,31 @@ class alignas(16) SurgeStorage
     } hardclipMode = HARDCLIP_TO_18DBFS,
       sceneHardclipMode[n_scenes] = {HARDCLIP_TO_18DBFS, HARDCLIP_TO_18DBFS};
 
+    /*
+     * Pair quads into eight voice OctFilterChain calls on AVX2 machines. This stays off (it is
+     * the UseOctFilterChain user default, in the developer menu) until --filter-chain-benchmark
+     * shows it beating two quad calls, since each half still calls the four wide filter units.
+     */
+    bool useOctFilterChain{false};
+
+    /*
+     * Run filter unit 1's common kernels through chains with the kernel compiled in (see
+     * GetFixedFBQPointer), ahead of both the per SIMD level chains and the eight voice one.
+     * Off, as UseFixedFilterChains in the developer menu, until --fixed-filter-chain-benchmark
+     * shows them beating the generic chain on the real kernels.
+     */
+    bool useFixedFilterChains{false};
+
+    // compute the asymmetric and sine filter block waveshapers rather than read their tables;
+    // see WaveshaperApproximations.h. Saved with the DAW state and set from the Processing
+    // menu, which also holds the ApproximateWaveshapers default for new instances
+    bool approximateWaveshapers{false};
+
+    // how long, in blocks of audio, the formula modulator evaluations of a block may run before
+    // they are stopped, or 0 for no limit; see Surge::Formula::EvaluationBudget. Half a block
+    // leaves the other half for everything else, so that formulas alone can't make it late
+    float formulaTimeBudgetInBlocks{0.5f};
+
     void loadTuningFromSCL(const fs::path &p);
     void loadMappingFromKBM(const fs::path &p);
     std::function<void()> onTuningChanged{nullptr};
@@ -40,6 +40,8 @@
 #endif
 
 #include "SurgeMemoryPools.h"
+#include "OctFilterChain.h"
+#include "WaveshaperApproximations.h"
 
 #include "sst/basic-blocks/mechanics/block-ops.h"
 #include "sst/basic-blocks/dsp/Clippers.h"
@@ -53,8 +55,7 @@ namespace cutl = sst::cpputils;
 using CMSKey = ControllerModulationSourceVector<1>; // sigh see #4286 for failed first try
 
 SurgeSynthesizer::SurgeSynthesizer(PluginLayer *parent, const std::string &suppliedDataPath)
-    : storage(suppliedDataPath), hpA{cutl::make_array<BiquadFilter, n_hpBQ>(&storage)},
-      hpB{cutl::make_array<BiquadFilter, n_hpBQ>(&storage)}, _parent(parent), halfbandA(6, true),
+    : storage(suppliedDataPath), sceneOutputStage(&storage), _parent(parent), halfbandA(6, true),
       halfbandB(6, true), halfbandIN(6, true), mpeEnabled(storage.mpeEnabled)
 {
     switch_toggled_queued = false;
@@ -1173,13 +1174,7 @@ void SurgeSynthesizer::releaseScene(int s)
     }
     voices[s].clear();
 
-    for (int i = 0; i < n_hpBQ; ++i)
-    {
-        if (s == 0)
-            hpA[i].suspend();
-        else
-            hpB[i].suspend();
-    }
+    sceneOutputStage.suspend(s);
     if (s == 0)
         halfbandA.reset();
     if (s == 1)
@@ -2592,11 +2587,7 @@ void SurgeSynthesizer::stopSound()
     halfbandB.reset();
     halfbandIN.reset();
 
-    for (int i = 0; i < n_hpBQ; i++)
-    {
-        hpA[i].suspend();
-        hpB[i].suspend();
-    }
+    sceneOutputStage.suspendAll();
 
     for (int i = 0; i < n_fx_slots; i++)
     {
@@ -4311,20 +4302,48 @@ void SurgeSynthesizer::processControl()
         release_anyway[1] = false;
     }
 
-    // interpolate MIDI controllers
-    for (int i = 0; i < num_controlinterpolators; i++)
+    // interpolate MIDI controllers, the ones in use a quad at a time
     {
-        if (mControlInterpolatorUsed[i])
+        ControllerModulationSource *quad[4];
+        int quadIndex[4];
+        bool cont[4];
+        int nq = 0;
+
+        auto interpolateQuad = [&]() {
+            ControllerModulationSource::processSmoothingQuad(quad, nq, true, 0.001f, cont);
+
+            for (int q = 0; q < nq; ++q)
+            {
+                ControllerModulationSource *mc = quad[q];
+                int id = mc->id;
+                storage.getPatch().param_ptr[id]->set_value_f01(mc->get_output(0));
+                if (!cont[q])
+                {
+                    mControlInterpolatorUsed[quadIndex[q]] = false;
+                }
+            }
+
+            nq = 0;
+        };
+
+        for (int i = 0; i < num_controlinterpolators; i++)
         {
-            ControllerModulationSource *mc = &mControlInterpolator[i];
-            bool cont = mc->process_block_until_close(0.001f);
-            int id = mc->id;
-            storage.getPatch().param_ptr[id]->set_value_f01(mc->get_output(0));
-            if (!cont)
+            if (mControlInterpolatorUsed[i])
             {
-                mControlInterpolatorUsed[i] = false;
+                quad[nq] = &mControlInterpolator[i];
+                quadIndex[nq++] = i;
+
+                if (nq == 4)
+                {
+                    interpolateQuad();
+                }
             }
         }
+
+        if (nq)
+        {
+            interpolateQuad();
+        }
     }
 
     // Update keys if we are bound
@@ -4363,16 +4382,46 @@ void SurgeSynthesizer::processControl()
     {
         if (((s == 0) && playA) || ((s == 1) && playB))
         {
-            if (storage.getPatch().scene[s].modsource_doprocess[ms_modwheel])
-                storage.getPatch().scene[s].modsources[ms_modwheel]->process_block();
-            if (storage.getPatch().scene[s].modsource_doprocess[ms_breath])
-                storage.getPatch().scene[s].modsources[ms_breath]->process_block();
-            if (storage.getPatch().scene[s].modsource_doprocess[ms_expression])
-                storage.getPatch().scene[s].modsources[ms_expression]->process_block();
-            if (storage.getPatch().scene[s].modsource_doprocess[ms_sustain])
-                storage.getPatch().scene[s].modsources[ms_sustain]->process_block();
-            if (storage.getPatch().scene[s].modsource_doprocess[ms_aftertouch])
-                storage.getPatch().scene[s].modsources[ms_aftertouch]->process_block();
+            /*
+             * The MIDI controllers, pitch bend and macros (with their modulation underlyers) only
+             * smooth toward their targets, so they step together a quad at a time. Those which
+             * have settled on their targets wouldn't change, so they are left out.
+             */
+            ControllerModulationSource *bank[6 + 2 * n_customcontrollers];
+            int nb = 0;
+
+            auto addToBank = [&bank, &nb](ControllerModulationSource *c) {
+                if (c->value[0] != c->target[0])
+                {
+                    bank[nb++] = c;
+                }
+            };
+
+            for (auto ms : {ms_modwheel, ms_breath, ms_expression, ms_sustain, ms_aftertouch})
+            {
+                if (storage.getPatch().scene[s].modsource_doprocess[ms])
+                    addToBank(
+                        (ControllerModulationSource *)storage.getPatch().scene[s].modsources[ms]);
+            }
+
+            addToBank(
+                (ControllerModulationSource *)storage.getPatch().scene[s].modsources[ms_pitchbend]);
+
+            for (int i = 0; i < n_customcontrollers; i++)
+            {
+                auto *mc =
+                    (MacroModulationSource *)storage.getPatch().scene[s].modsources[ms_ctrl1 + i];
+                mc->modunderlyer.set_samplerate(mc->samplerate, mc->samplerate_inv);
+                addToBank(&mc->modunderlyer);
+                addToBank(mc);
+            }
+
+            for (int i = 0; i < nb; i += 4)
+            {
+                ControllerModulationSource::processSmoothingQuad(bank + i, std::min(4, nb - i),
+                                                                 false);
+            }
+
             if (storage.getPatch().scene[s].modsource_doprocess[ms_lowest_key])
                 storage.getPatch().scene[s].modsources[ms_lowest_key]->process_block();
             if (storage.getPatch().scene[s].modsource_doprocess[ms_highest_key])
@@ -4389,11 +4438,6 @@ void SurgeSynthesizer::processControl()
             if (storage.getPatch().scene[s].modsource_doprocess[ms_alternate_unipolar])
                 storage.getPatch().scene[s].modsources[ms_alternate_unipolar]->process_block();
 
-            storage.getPatch().scene[s].modsources[ms_pitchbend]->process_block();
-
-            for (int i = 0; i < n_customcontrollers; i++)
-                storage.getPatch().scene[s].modsources[ms_ctrl1 + i]->process_block();
-
             // for(int i=0; i<n_lfos_scene; i++)
             // storage.getPatch().scene[s].modsources[ms_slfo1+i]->process_block();
 
@@ -4666,20 +4710,41 @@ void SurgeSynthesizer::process()
         iter = voices[s].begin();
         while (iter != voices[s].end())
         {
-            SurgeVoice *v = *iter;
-            assert(v);
-            bool resume = v->process_block(FBQ[s][FBentry[s] >> 2], FBentry[s] & 3);
-            FBentry[s]++;
+            // the voices go four at a time, which is how they land in the filter quads, so
+            // that their LFOs and envelopes can step together
+            list<SurgeVoice *>::iterator quad[4];
+            SurgeVoice *qv[4];
+            ADSRModulationSource *aeg[4], *feg[4];
+            int nq = 0;
 
-            vcount++;
+            while (nq < 4 && iter != voices[s].end())
+            {
+                SurgeVoice *v = *iter;
+                assert(v);
+                qv[nq] = v;
+                aeg[nq] = v->ampEG();
+                feg[nq] = v->filterEG();
+                quad[nq++] = iter++;
+            }
+
+            SurgeVoice::begin_block_quad(qv, nq);
+            ADSRModulationSource::process_block_quad(aeg, nq);
+            ADSRModulationSource::process_block_quad(feg, nq);
 
-            if (!resume)
+            for (int q = 0; q < nq; ++q)
             {
-                freeVoice(v);
-                iter = voices[s].erase(iter);
+                SurgeVoice *v = *quad[q];
+                bool resume = v->finish_block(FBQ[s][FBentry[s] >> 2], FBentry[s] & 3);
+                FBentry[s]++;
+
+                vcount++;
+
+                if (!resume)
+                {
+                    freeVoice(v);
+                    voices[s].erase(quad[q]);
+                }
             }
-            else
-                iter++;
         }
 
         storage.modRoutingMutex.unlock();
@@ -4715,14 +4780,43 @@ void SurgeSynthesizer::process()
         }
         else
         {
-            g.WSptr =
-                sst::waveshapers::GetQuadWaveshaper(static_cast<sst::waveshapers::WaveshaperType>(
-                    storage.getPatch().scene[s].wsunit.type.val.i));
+            auto wst = static_cast<sst::waveshapers::WaveshaperType>(
+                storage.getPatch().scene[s].wsunit.type.val.i);
+
+            g.WSptr = storage.approximateWaveshapers
+                          ? Surge::WaveshaperApprox::GetQuadWaveshaper(wst)
+                          : nullptr;
+
+            if (!g.WSptr)
+                g.WSptr = sst::waveshapers::GetQuadWaveshaper(wst);
+        }
+
+        auto fbConfig = storage.getPatch().scene[s].filterblock_configuration.val.i;
+        FBQFPtr ProcessQuadFB = nullptr;
+
+        if (storage.useFixedFilterChains)
+        {
+            ProcessQuadFB = GetFixedFBQPointer(fbConfig, g);
         }
 
-        FBQFPtr ProcessQuadFB =
-            GetFBQPointer(storage.getPatch().scene[s].filterblock_configuration.val.i,
-                          g.FU1ptr != 0, g.WSptr != 0, g.FU2ptr != 0);
+        bool fixedChain = ProcessQuadFB != nullptr;
+
+        if (!fixedChain)
+        {
+            ProcessQuadFB = GetFBQPointer(fbConfig, g);
+        }
+
+        /*
+         * On AVX2 machines we can run the quads in pairs, eight voices at a time. There are no
+         * eight voice builds of the fixed kernel chains though, so when filter unit 1 has one
+         * of those every quad goes through it instead.
+         */
+        FBOctFPtr ProcessOctFB = nullptr;
+
+        if (storage.useOctFilterChain && !fixedChain)
+        {
+            ProcessOctFB = GetFBOctPointer(fbConfig, g.FU1ptr != 0, g.WSptr != 0, g.FU2ptr != 0);
+        }
 
         for (int e = 0; e < FBentry[s]; e += 4)
         {
@@ -4734,6 +4828,20 @@ void SurgeSynthesizer::process()
                 FBQ[s][e >> 2].FU[2].active[i] = 0;
                 FBQ[s][e >> 2].FU[3].active[i] = 0;
             }
+        }
+
+        int e = 0;
+        if (ProcessOctFB)
+        {
+            for (; e + 4 < FBentry[s]; e += 8)
+            {
+                ProcessOctFB(FBQ[s][e >> 2], FBQ[s][(e >> 2) + 1], g, sceneout[s][0],
+                             sceneout[s][1]);
+                octFilterChainCalls++;
+            }
+        }
+        for (; e < FBentry[s]; e += 4)
+        {
             ProcessQuadFB(FBQ[s][e >> 2], g, sceneout[s][0], sceneout[s][1]);
         }
 
@@ -4810,51 +4918,16 @@ void SurgeSynthesizer::process()
      * ABOVE: Oversampled, Below, Regular sample. So BLOCK_SIZE_OS above BLOCK_SIZE below
      */
 
-    // TODO: FIX SCENE ASSUMPTION
-    if (storage.getPatch().scene[0].lowcut.deactivated == false)
-    {
-        auto freq =
-            storage.getPatch().scenedata[0][storage.getPatch().scene[0].lowcut.param_id_in_scene].f;
-
-        auto slope = storage.getPatch().scene[0].lowcut.deform_type;
-
-        for (int i = 0; i <= slope; i++)
-        {
-            hpA[i].coeff_HP(hpA[i].calc_omega(freq / 12.0), 0.4); // var 0.707
-            hpA[i].process_block(sceneout[0][0], sceneout[0][1]); // TODO: quadify
-        }
-    }
-
-    if (storage.getPatch().scene[1].lowcut.deactivated == false)
+    for (int sc = 0; sc < n_scenes; ++sc)
     {
-        auto freq =
-            storage.getPatch().scenedata[1][storage.getPatch().scene[1].lowcut.param_id_in_scene].f;
-
-        auto slope = storage.getPatch().scene[1].lowcut.deform_type;
+        auto &lowcut = storage.getPatch().scene[sc].lowcut;
 
-        for (int i = 0; i <= slope; i++)
-        {
-            hpB[i].coeff_HP(hpB[i].calc_omega(freq / 12.0), 0.4); // var 0.707
-            hpB[i].process_block(sceneout[1][0], sceneout[1][1]); // TODO: quadify
-        }
+        sceneOutputStage.setLowCut(sc, !lowcut.deactivated,
+                                   storage.getPatch().scenedata[sc][lowcut.param_id_in_scene].f,
+                                   std::min(lowcut.deform_type, n_hpBQ - 1));
     }
 
-    for (int cls = 0; cls < n_scenes; ++cls)
-    {
-        switch (storage.sceneHardclipMode[cls])
-        {
-        case SurgeStorage::HARDCLIP_TO_18DBFS:
-            sdsp::hardclip_block8<BLOCK_SIZE>(sceneout[cls][0]);
-            sdsp::hardclip_block8<BLOCK_SIZE>(sceneout[cls][1]);
-            break;
-        case SurgeStorage::HARDCLIP_TO_0DBFS:
-            sdsp::hardclip_block<BLOCK_SIZE>(sceneout[cls][0]);
-            sdsp::hardclip_block<BLOCK_SIZE>(sceneout[cls][1]);
-            break;
-        default:
-            break;
-        }
-    }
+    sceneOutputStage.process(sceneout, storage.sceneHardclipMode);
 
     // TODO: FIX SCENE ASSUMPTION
     bool sc_state[n_scenes];
@@ -4989,6 +5062,10 @@ void SurgeSynthesizer::process()
         amp_mute.multiply_2_blocks(sceneout[sc][0], sceneout[sc][1], BLOCK_SIZE_QUAD);
     }
 
+    // The formula modulators' Lua state only collects garbage here, a bounded amount a block
+    Surge::Formula::stepGarbageCollection(&storage);
+    Surge::Formula::endBlock(&storage);
+
     // Calculate how close we are to overloading the CPU
     // (how close is the process() duration to duration)
     auto process_end = std::chrono::high_resolution_clock::now();
@@ -5068,6 +5145,8 @@ void SurgeSynthesizer::populateDawExtraState()
     des.monoPedalMode = storage.monoPedalMode;
     des.oddsoundRetuneMode = storage.oddsoundRetuneMode;
 
+    des.approximateWaveshapers = storage.approximateWaveshapers;
+
     des.lastLoadedPatch = storage.lastLoadedPatch;
 }
 
@@ -5098,6 +5177,8 @@ void SurgeSynthesizer::loadFromDawExtraState()
     storage.monoPedalMode = (MonoPedalMode)des.monoPedalMode;
     storage.oddsoundRetuneMode = (SurgeStorage::OddsoundRetuneMode)des.oddsoundRetuneMode;
 
+    storage.approximateWaveshapers = des.approximateWaveshapers;
+
     if (des.hasScale)
     {
         try
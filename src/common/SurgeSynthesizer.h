@@ -26,6 +26,7 @@
 #include "SurgeVoice.h"
 #include "Effect.h"
 #include "BiquadFilter.h"
+#include "SceneOutputStage.h"
 #include <set>
 #include <sst/filters/HalfRateFilter.h>
 
@@ -488,6 +489,9 @@ class alignas(16) SurgeSynthesizer
 
     // updated in audio thread, read from UI, so have assignments be atomic
     std::atomic<int> polydisplay;
+
+    // how many eight voice filter chain calls process has made, so that tests can tell it ran
+    uint64_t octFilterChainCalls{0};
     std::atomic<int> hasUpdatedMidiCC;
     std::atomic<int> modwheelCC, pitchbendMIDIVal, sustainpedalCC;
     std::atomic<bool> midiSoftTakeover;
@@ -527,8 +531,8 @@ class alignas(16) SurgeSynthesizer
 
     static constexpr int n_hpBQ = 4;
 
-    // TODO: FIX SCENE ASSUMPTION (use std::array)
-    std::array<BiquadFilter, n_hpBQ> hpA, hpB;
+    // the scene low cut, up to n_hpBQ biquads, and the scene hardclip for both scenes
+    SceneOutputStage sceneOutputStage;
 
     bool fx_reload[n_fx_slots]; // if true, reload new effect parameters from fxsync
     FxStorage fxsync[n_fx_slots]{
@@ -97,6 +97,18 @@ std::string defaultKeyToString(DefaultKey k)
     case Use3DWavetableView:
         r = "use3DWavetableView";
         break;
+    case UseWavetableDiskCache:
+        r = "useWavetableDiskCache";
+        break;
+    case UseOctFilterChain:
+        r = "useOctFilterChain";
+        break;
+    case UseFixedFilterChains:
+        r = "useFixedFilterChains";
+        break;
+    case ApproximateWaveshapers:
+        r = "approximateWaveshapers";
+        break;
     case DefaultSkin:
         r = "defaultSkin";
         break;
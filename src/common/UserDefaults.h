@@ -105,6 +105,10 @@ enum DefaultKey
     // these are persistent options sprinkled outside of the menu
     UseODDMTS_Deprecated,
     Use3DWavetableView,
+    UseWavetableDiskCache,
+    UseOctFilterChain,
+    UseFixedFilterChains,
+    ApproximateWaveshapers,
     ModListValueDisplay,
 
     // dialog related stuff
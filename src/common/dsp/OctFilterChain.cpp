@@ -0,0 +1,454 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "OctFilterChain.h"
+#include "SurgeStorage.h"
+#include "sst/basic-blocks/mechanics/simd-ops.h"
+#include "sst/basic-blocks/dsp/Clippers.h"
+
+#if SURGE_SIMD_X86
+namespace
+{
+namespace mech = sst::basic_blocks::mechanics;
+namespace sdsp = sst::basic_blocks::dsp;
+
+/*
+ * The ramped parameters and feedback lines of both quads, eight wide. These are loaded
+ * from the QuadFilterChainStates at the top of the block and stored back at the end.
+ */
+#define OCT_CHAIN_MEMBERS(X)                                                                       \
+    X(Gain) X(FB) X(Mix1) X(Mix2) X(Drive) X(dGain) X(dFB) X(dMix1) X(dMix2) X(dDrive) X(wsLPF)    \
+        X(FBlineL) X(FBlineR) X(OutL) X(OutR) X(dOutL) X(dOutR) X(Out2L) X(Out2R) X(dOut2L)        \
+            X(dOut2R)
+
+struct OctChainState
+{
+#define OCT_DECLARE(m) __m256 m;
+    OCT_CHAIN_MEMBERS(OCT_DECLARE)
+#undef OCT_DECLARE
+    __m256 mask;
+};
+
+#define OctJoin(lo, hi) _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1)
+#define OctLo(v) _mm256_castps256_ps128(v)
+#define OctHi(v) _mm256_extractf128_ps(v, 1)
+
+// the sst filter units, waveshapers and clipper are four wide, so run them a half at a time
+#define OctFU(ptr, u, v) OctJoin(g.ptr(&d0.FU[u], OctLo(v)), g.ptr(&d1.FU[u], OctHi(v)))
+#define OctWS(w, v, drive)                                                                         \
+    OctJoin(g.WSptr(&d0.WSS[w], OctLo(v), OctLo(drive)),                                           \
+            g.WSptr(&d1.WSS[w], OctHi(v), OctHi(drive)))
+#define OctSoftclip(v) OctJoin(sdsp::softclip_ps(OctLo(v)), sdsp::softclip_ps(OctHi(v)))
+
+#define OctAdd(a, b) _mm256_add_ps(a, b)
+#define OctMul(a, b) _mm256_mul_ps(a, b)
+#define OctSub(a, b) _mm256_sub_ps(a, b)
+#define OctAnd(a, b) _mm256_and_ps(a, b)
+
+#define OctSumToOutput(v, Out)                                                                     \
+    _mm_store_ss(&Out[k], _mm_add_ss(_mm_load_ss(&Out[k]),                                         \
+                                     mech::sum_ps_to_ss(_mm_add_ps(OctLo(v), OctHi(v)))));
+
+#define MWriteOutputsOct(x)                                                                        \
+    o.OutL = OctAdd(o.OutL, o.dOutL);                                                              \
+    o.OutR = OctAdd(o.OutR, o.dOutR);                                                              \
+    __m256 outL = OctMul(x, o.OutL);                                                               \
+    __m256 outR = OctMul(x, o.OutR);                                                               \
+    OctSumToOutput(outL, OutL) OctSumToOutput(outR, OutR)
+
+#define MWriteOutputsDualOct(x, y)                                                                 \
+    o.OutL = OctAdd(o.OutL, o.dOutL);                                                              \
+    o.OutR = OctAdd(o.OutR, o.dOutR);                                                              \
+    o.Out2L = OctAdd(o.Out2L, o.dOut2L);                                                           \
+    o.Out2R = OctAdd(o.Out2R, o.dOut2R);                                                           \
+    __m256 outL = OctAdd(OctMul(x, o.OutL), OctMul(y, o.Out2L));                                   \
+    __m256 outR = OctAdd(OctMul(x, o.OutR), OctMul(y, o.Out2R));                                   \
+    OctSumToOutput(outL, OutL) OctSumToOutput(outR, OutR)
+
+template <int config, bool A, bool WS, bool B>
+SURGE_TARGET_AVX void ProcessFBOct(QuadFilterChainState &d0, QuadFilterChainState &d1,
+                                    fbq_global &g, float *OutL, float *OutR)
+{
+    const __m256 hb_c = _mm256_set1_ps(0.5f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    OctChainState o;
+#define OCT_LOAD(m) o.m = OctJoin(d0.m, d1.m);
+    OCT_CHAIN_MEMBERS(OCT_LOAD)
+#undef OCT_LOAD
+    o.mask = OctJoin(_mm_load_ps((float *)&d0.FU[0].active),
+                     _mm_load_ps((float *)&d1.FU[0].active));
+    const __m256 mask = o.mask;
+
+    switch (config)
+    {
+    case fc_serial1: // no feedback at all  (saves CPU)
+        for (int k = 0; k < BLOCK_SIZE_OS; k++)
+        {
+            __m256 input = OctJoin(d0.DL[k], d1.DL[k]);
+            __m256 x = input, y = OctJoin(d0.DR[k], d1.DR[k]);
+
+            if (A)
+                x = OctFU(FU1ptr, 0, x);
+            if (WS)
+            {
+                o.wsLPF = OctMul(hb_c, OctAdd(o.wsLPF, OctAnd(mask, x)));
+                o.Drive = OctAdd(o.Drive, o.dDrive);
+                x = OctWS(0, o.wsLPF, o.Drive);
+            }
+
+            if (A || WS)
+            {
+                o.Mix1 = OctAdd(o.Mix1, o.dMix1);
+                x = OctAdd(OctMul(input, OctSub(one, o.Mix1)), OctMul(x, o.Mix1));
+            }
+
+            y = OctAdd(x, y);
+
+            if (B)
+                y = OctFU(FU2ptr, 1, y);
+
+            o.Mix2 = OctAdd(o.Mix2, o.dMix2);
+            x = OctAdd(OctMul(x, OctSub(one, o.Mix2)), OctMul(y, o.Mix2));
+            o.Gain = OctAdd(o.Gain, o.dGain);
+            __m256 out = OctAnd(mask, OctMul(x, o.Gain));
+
+            MWriteOutputsOct(out)
+        }
+        break;
+    case fc_serial2:
+        for (int k = 0; k < BLOCK_SIZE_OS; k++)
+        {
+            o.FB = OctAdd(o.FB, o.dFB);
+            __m256 input = OctMul(o.FB, o.FBlineL);
+            input = OctAdd(OctJoin(d0.DL[k], d1.DL[k]), OctSoftclip(input));
+            __m256 x = input, y = OctJoin(d0.DR[k], d1.DR[k]);
+
+            if (A)
+                x = OctFU(FU1ptr, 0, x);
+            if (WS)
+            {
+                o.wsLPF = OctMul(hb_c, OctAdd(o.wsLPF, OctAnd(mask, x)));
+                o.Drive = OctAdd(o.Drive, o.dDrive);
+                x = OctWS(0, o.wsLPF, o.Drive);
+            }
+
+            if (A || WS)
+            {
+                o.Mix1 = OctAdd(o.Mix1, o.dMix1);
+                x = OctAdd(OctMul(input, OctSub(one, o.Mix1)), OctMul(x, o.Mix1));
+            }
+
+            y = OctAdd(x, y);
+
+            if (B)
+                y = OctFU(FU2ptr, 1, y);
+
+            o.Mix2 = OctAdd(o.Mix2, o.dMix2);
+            x = OctAdd(OctMul(x, OctSub(one, o.Mix2)), OctMul(y, o.Mix2));
+            o.Gain = OctAdd(o.Gain, o.dGain);
+            __m256 out = OctAnd(mask, OctMul(x, o.Gain));
+            o.FBlineL = out;
+
+            MWriteOutputsOct(out)
+        }
+        break;
+    case fc_serial3: // filter 2 is only heard in the feedback path
+        for (int k = 0; k < BLOCK_SIZE_OS; k++)
+        {
+            o.FB = OctAdd(o.FB, o.dFB);
+            __m256 input = OctMul(o.FB, o.FBlineL);
+            input = OctAdd(OctJoin(d0.DL[k], d1.DL[k]), OctSoftclip(input));
+            __m256 x = input, y = OctJoin(d0.DR[k], d1.DR[k]);
+
+            if (A)
+                x = OctFU(FU1ptr, 0, x);
+            if (WS)
+            {
+                o.wsLPF = OctMul(hb_c, OctAdd(o.wsLPF, OctAnd(mask, x)));
+                o.Drive = OctAdd(o.Drive, o.dDrive);
+                x = OctWS(0, o.wsLPF, o.Drive);
+            }
+
+            if (A || WS)
+            {
+                o.Mix1 = OctAdd(o.Mix1, o.dMix1);
+                x = OctAdd(OctMul(input, OctSub(one, o.Mix1)), OctMul(x, o.Mix1));
+            }
+
+            o.Gain = OctAdd(o.Gain, o.dGain);
+            x = OctAnd(mask, OctMul(x, o.Gain));
+
+            MWriteOutputsOct(x)
+
+            y = OctAdd(x, y);
+
+            if (B)
+                y = OctFU(FU2ptr, 1, y);
+
+            o.Mix2 = OctAdd(o.Mix2, o.dMix2);
+
+            o.FBlineL = y;
+        }
+        break;
+    case fc_dual1:
+        for (int k = 0; k < BLOCK_SIZE_OS; k++)
+        {
+            o.FB = OctAdd(o.FB, o.dFB);
+            __m256 fb = OctSoftclip(OctMul(o.FB, o.FBlineL));
+            __m256 x = OctAdd(OctJoin(d0.DL[k], d1.DL[k]), fb);
+            __m256 y = OctAdd(OctJoin(d0.DR[k], d1.DR[k]), fb);
+
+            if (A)
+                x = OctFU(FU1ptr, 0, x);
+            if (B)
+                y = OctFU(FU2ptr, 1, y);
+
+            o.Mix1 = OctAdd(o.Mix1, o.dMix1);
+            o.Mix2 = OctAdd(o.Mix2, o.dMix2);
+            x = OctAdd(OctMul(x, o.Mix1), OctMul(y, o.Mix2));
+
+            if (WS)
+            {
+                o.wsLPF = OctMul(hb_c, OctAdd(o.wsLPF, OctAnd(mask, x)));
+                o.Drive = OctAdd(o.Drive, o.dDrive);
+                x = OctWS(0, o.wsLPF, o.Drive);
+            }
+
+            o.Gain = OctAdd(o.Gain, o.dGain);
+            __m256 out = OctAnd(mask, OctMul(x, o.Gain));
+            o.FBlineL = out;
+
+            MWriteOutputsOct(out)
+        }
+        break;
+    case fc_dual2:
+        for (int k = 0; k < BLOCK_SIZE_OS; k++)
+        {
+            o.FB = OctAdd(o.FB, o.dFB);
+            __m256 fb = OctSoftclip(OctMul(o.FB, o.FBlineL));
+            __m256 x = OctAdd(OctJoin(d0.DL[k], d1.DL[k]), fb);
+            __m256 y = OctAdd(OctJoin(d0.DR[k], d1.DR[k]), fb);
+
+            if (A)
+                x = OctFU(FU1ptr, 0, x);
+            if (WS)
+            {
+                o.wsLPF = OctMul(hb_c, OctAdd(o.wsLPF, OctAnd(mask, x)));
+                o.Drive = OctAdd(o.Drive, o.dDrive);
+                x = OctWS(0, o.wsLPF, o.Drive);
+            }
+
+            if (B)
+                y = OctFU(FU2ptr, 1, y);
+
+            o.Mix1 = OctAdd(o.Mix1, o.dMix1);
+            o.Mix2 = OctAdd(o.Mix2, o.dMix2);
+            x = OctAdd(OctMul(x, o.Mix1), OctMul(y, o.Mix2));
+
+            o.Gain = OctAdd(o.Gain, o.dGain);
+            __m256 out = OctAnd(mask, OctMul(x, o.Gain));
+            o.FBlineL = out;
+
+            MWriteOutputsOct(out)
+        }
+        break;
+    case fc_ring:
+        for (int k = 0; k < BLOCK_SIZE_OS; k++)
+        {
+            o.FB = OctAdd(o.FB, o.dFB);
+            __m256 fb = OctSoftclip(OctMul(o.FB, o.FBlineL));
+            __m256 x = OctAdd(OctJoin(d0.DL[k], d1.DL[k]), fb);
+            __m256 y = OctAdd(OctJoin(d0.DR[k], d1.DR[k]), fb);
+
+            if (A)
+                x = OctFU(FU1ptr, 0, x);
+            if (B)
+                y = OctFU(FU2ptr, 1, y);
+
+            o.Mix1 = OctAdd(o.Mix1, o.dMix1);
+            o.Mix2 = OctAdd(o.Mix2, o.dMix2);
+
+            x = OctMul(OctAdd(OctMul(OctSub(one, o.Mix1), y), OctMul(x, o.Mix1)),
+                       OctAdd(OctMul(OctSub(one, o.Mix2), x), OctMul(y, o.Mix2)));
+
+            if (WS)
+            {
+                o.wsLPF = OctMul(hb_c, OctAdd(o.wsLPF, x));
+                o.Drive = OctAdd(o.Drive, o.dDrive);
+                x = OctWS(0, OctAnd(mask, o.wsLPF), o.Drive);
+            }
+
+            o.Gain = OctAdd(o.Gain, o.dGain);
+            __m256 out = OctAnd(mask, OctMul(x, o.Gain));
+            o.FBlineL = out;
+
+            MWriteOutputsOct(out)
+        }
+        break;
+    case fc_stereo:
+        for (int k = 0; k < BLOCK_SIZE_OS; k++)
+        {
+            o.FB = OctAdd(o.FB, o.dFB);
+            __m256 fb = OctSoftclip(OctMul(o.FB, o.FBlineL));
+            __m256 x = OctAdd(OctJoin(d0.DL[k], d1.DL[k]), fb);
+            __m256 y = OctAdd(OctJoin(d0.DR[k], d1.DR[k]), fb);
+
+            if (A)
+                x = OctFU(FU1ptr, 0, x);
+            if (B)
+                y = OctFU(FU2ptr, 1, y);
+
+            if (WS)
+            {
+                o.Drive = OctAdd(o.Drive, o.dDrive);
+                x = OctWS(0, OctAnd(mask, x), o.Drive);
+                y = OctWS(1, OctAnd(mask, y), o.Drive);
+            }
+
+            o.Mix1 = OctAdd(o.Mix1, o.dMix1);
+            o.Mix2 = OctAdd(o.Mix2, o.dMix2);
+            x = OctMul(x, o.Mix1);
+            y = OctMul(y, o.Mix2);
+
+            o.Gain = OctAdd(o.Gain, o.dGain);
+            x = OctAnd(mask, OctMul(x, o.Gain));
+            y = OctAnd(mask, OctMul(y, o.Gain));
+            o.FBlineL = OctAdd(x, y);
+
+            MWriteOutputsDualOct(x, y)
+        }
+        break;
+    case fc_wide:
+        for (int k = 0; k < BLOCK_SIZE_OS; k++)
+        {
+            o.FB = OctAdd(o.FB, o.dFB);
+            __m256 fbL = OctMul(o.FB, o.FBlineL);
+            __m256 fbR = OctMul(o.FB, o.FBlineR);
+            __m256 xin = OctAdd(OctJoin(d0.DL[k], d1.DL[k]), OctSoftclip(fbL));
+            __m256 yin = OctAdd(OctJoin(d0.DR[k], d1.DR[k]), OctSoftclip(fbR));
+            __m256 x = xin;
+            __m256 y = yin;
+
+            if (A)
+            {
+                x = OctFU(FU1ptr, 0, x);
+                y = OctFU(FU1ptr, 2, y);
+            }
+
+            if (WS)
+            {
+                o.Drive = OctAdd(o.Drive, o.dDrive);
+                x = OctWS(0, OctAnd(mask, x), o.Drive);
+                y = OctWS(1, OctAnd(mask, y), o.Drive);
+            }
+
+            if (A || WS)
+            {
+                o.Mix1 = OctAdd(o.Mix1, o.dMix1);
+                __m256 t = OctSub(one, o.Mix1);
+                x = OctAdd(OctMul(xin, t), OctMul(x, o.Mix1));
+                y = OctAdd(OctMul(yin, t), OctMul(y, o.Mix1));
+            }
+
+            if (B)
+            {
+                __m256 z = OctFU(FU2ptr, 1, x);
+                __m256 w = OctFU(FU2ptr, 3, y);
+
+                o.Mix2 = OctAdd(o.Mix2, o.dMix2);
+                __m256 t = OctSub(one, o.Mix2);
+                x = OctAdd(OctMul(x, t), OctMul(z, o.Mix2));
+                y = OctAdd(OctMul(y, t), OctMul(w, o.Mix2));
+            }
+
+            o.Gain = OctAdd(o.Gain, o.dGain);
+            x = OctAnd(mask, OctMul(x, o.Gain));
+            y = OctAnd(mask, OctMul(y, o.Gain));
+            o.FBlineL = x;
+            o.FBlineR = y;
+
+            MWriteOutputsDualOct(x, y)
+        }
+        break;
+    }
+
+#define OCT_STORE(m)                                                                               \
+    d0.m = OctLo(o.m);                                                                             \
+    d1.m = OctHi(o.m);
+    OCT_CHAIN_MEMBERS(OCT_STORE)
+#undef OCT_STORE
+}
+
+template <int config> FBOctFPtr GetFBOctPointer2(bool A, bool WS, bool B)
+{
+    if (A)
+    {
+        if (B)
+            return WS ? ProcessFBOct<config, 1, 1, 1> : ProcessFBOct<config, 1, 0, 1>;
+        else
+            return WS ? ProcessFBOct<config, 1, 1, 0> : ProcessFBOct<config, 1, 0, 0>;
+    }
+    else
+    {
+        if (B)
+            return WS ? ProcessFBOct<config, 0, 1, 1> : ProcessFBOct<config, 0, 0, 1>;
+        else
+            return WS ? ProcessFBOct<config, 0, 1, 0> : ProcessFBOct<config, 0, 0, 0>;
+    }
+}
+} // namespace
+#endif
+
+FBOctFPtr GetFBOctPointer(int config, bool A, bool WS, bool B, Surge::CPUFeatures::SIMDLevel level)
+{
+#if SURGE_SIMD_X86
+    if (level < Surge::CPUFeatures::simd_avx2_fma)
+        return nullptr;
+
+    switch (config)
+    {
+    case fc_serial1:
+        return GetFBOctPointer2<fc_serial1>(A, WS, B);
+    case fc_serial2:
+        return GetFBOctPointer2<fc_serial2>(A, WS, B);
+    case fc_serial3:
+        return GetFBOctPointer2<fc_serial3>(A, WS, B);
+    case fc_dual1:
+        return GetFBOctPointer2<fc_dual1>(A, WS, B);
+    case fc_dual2:
+        return GetFBOctPointer2<fc_dual2>(A, WS, B);
+    case fc_ring:
+        return GetFBOctPointer2<fc_ring>(A, WS, B);
+    case fc_stereo:
+        return GetFBOctPointer2<fc_stereo>(A, WS, B);
+    case fc_wide:
+        return GetFBOctPointer2<fc_wide>(A, WS, B);
+    }
+#endif
+    return nullptr;
+}
+
+FBOctFPtr GetFBOctPointer(int config, bool A, bool WS, bool B)
+{
+    return GetFBOctPointer(config, A, WS, B, Surge::CPUFeatures::activeSIMDLevel());
+}
@@ -0,0 +1,58 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_DSP_OCTFILTERCHAIN_H
+#define SURGE_SRC_COMMON_DSP_OCTFILTERCHAIN_H
+
+#include "QuadFilterChain.h"
+#include "CPUFeatures.h"
+
+/*
+ * The filter block for eight voices at once, on AVX2 machines.
+ *
+ * The eight voices are simply two adjacent QuadFilterChainStates, so SurgeVoice loads its
+ * lane exactly as it does for the quad chain (see the big comment in QuadFilterChain.h).
+ * The filter units and waveshapers live in sst-filters and sst-waveshapers and only come
+ * four wide, so each half still runs those against its own QuadFilterChainState. Everything
+ * around them - feedback, mixes, drive, gain, the voice mask, the output ramps and the sum
+ * into the scene output - runs eight wide, and since both halves go through the block in the
+ * same loop, their filter unit calls interleave rather than running a block apart.
+ *
+ * The per-voice arithmetic is the same as ProcessFBQuad (it is built for AVX without FMA;
+ * see SURGE_TARGET_AVX) so the only difference from running the two quads separately is the
+ * order in which voices are summed into the scene output.
+ *
+ * SurgeSynthesizer only uses it when SurgeStorage::useOctFilterChain is set, which is off by
+ * default; compare the two with --filter-chain-benchmark before turning it on.
+ */
+typedef void (*FBOctFPtr)(QuadFilterChainState &, QuadFilterChainState &, fbq_global &, float *,
+                          float *);
+
+/*
+ * These return nullptr below AVX2, in which case run every quad with GetFBQPointer. The
+ * first form uses the active SIMD level.
+ */
+FBOctFPtr GetFBOctPointer(int config, bool A, bool WS, bool B);
+FBOctFPtr GetFBOctPointer(int config, bool A, bool WS, bool B,
+                          Surge::CPUFeatures::SIMDLevel level);
+
+#endif // SURGE_SRC_COMMON_DSP_OCTFILTERCHAIN_H
@@ -124,6 +124,68 @@ Oscillator *spawn_osc(int osctype, SurgeStorage *storage, OscillatorStorage *osc
     return osc;
 }
 
+bool OscillatorPrototype::supportsType(int osctype)
+{
+    switch (osctype)
+    {
+    case ot_classic:
+    case ot_sine:
+    case ot_modern:
+    case ot_alias:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void OscillatorPrototype::rebuild(int osctype, SurgeStorage *storage, OscillatorStorage *oscdata,
+                                  pdata *sceneParams)
+{
+    clear();
+    type = osctype;
+
+    if (!supportsType(osctype))
+        return;
+
+    osc = spawn_osc(osctype, storage, oscdata, sceneParams, buffer);
+    if (osc)
+    {
+        osc->init(60, false, false);
+        key = osc->prototypeKey();
+    }
+}
+
+void OscillatorPrototype::clear()
+{
+    if (osc)
+        osc->~Oscillator();
+
+    osc = nullptr;
+    type = -1;
+    key = 0;
+}
+
+Oscillator *OscillatorPrototype::spawnVoice(int osctype, SurgeStorage *storage,
+                                            OscillatorStorage *oscdata, pdata *sceneParams,
+                                            pdata *localcopy, unsigned char *onto, float pitch,
+                                            bool nonzero_init_drift)
+{
+    if (!isCurrentFor(osctype))
+        rebuild(osctype, storage, oscdata, sceneParams);
+
+    if (osc)
+    {
+        auto res = osc->cloneInto(onto, localcopy);
+        res->initVoice(pitch, false, nonzero_init_drift);
+        return res;
+    }
+
+    auto res = spawn_osc(osctype, storage, oscdata, localcopy, onto);
+    if (res)
+        res->init(pitch, false, nonzero_init_drift);
+    return res;
+}
+
 Oscillator::Oscillator(SurgeStorage *storage, OscillatorStorage *oscdata, pdata *localcopy)
     : master_osc(0)
 {
@@ -35,4 +35,41 @@ Oscillator *spawn_osc(int osctype, SurgeStorage *storage, OscillatorStorage *osc
                       pdata *localcopy,
                       unsigned char *onto); // This buffer should be at least oscillator_buffer_size
 
+/*
+ * A fully initialized oscillator for one scene oscillator slot. Voices start by copying it
+ * and calling Oscillator::initVoice, which skips constructing the oscillator and rebuilding
+ * its unison tables, filters and lags on every note on. The prototype is rebuilt the next
+ * time a voice asks for it after the oscillator type, or anything in its prototypeKey,
+ * changes. Types which hold resources per voice (or haven't split their init) simply
+ * spawn and init as before.
+ */
+struct OscillatorPrototype
+{
+    OscillatorPrototype() = default;
+    OscillatorPrototype(const OscillatorPrototype &) = delete;
+    OscillatorPrototype &operator=(const OscillatorPrototype &) = delete;
+    ~OscillatorPrototype() { clear(); }
+
+    static bool supportsType(int osctype);
+
+    // sceneParams is the (unmodulated) scene pdata, which the prototype reads during init
+    void rebuild(int osctype, SurgeStorage *storage, OscillatorStorage *oscdata,
+                 pdata *sceneParams);
+    bool isCurrentFor(int osctype) const
+    {
+        return type == osctype && (!osc || osc->prototypeKey() == key);
+    }
+    void clear();
+
+    // The equivalent of spawn_osc followed by init(pitch, false, nonzero_init_drift)
+    Oscillator *spawnVoice(int osctype, SurgeStorage *storage, OscillatorStorage *oscdata,
+                           pdata *sceneParams, pdata *localcopy, unsigned char *onto, float pitch,
+                           bool nonzero_init_drift);
+
+    int type{-1};
+    uint64_t key{0};
+    Oscillator *osc{nullptr};
+    unsigned char buffer alignas(16)[oscillator_buffer_size];
+};
+
 #endif // SURGE_SRC_COMMON_DSP_OSCILLATOR_H
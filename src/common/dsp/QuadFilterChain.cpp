@@ -53,8 +53,37 @@ namespace sdsp = sst::basic_blocks::dsp;
 #define AssertReasonableAudioFloat(x)
 #endif
 
-template <int config, bool A, bool WS, bool B>
-void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *OutR)
+/*
+ * How the chain reaches the first filter unit. Usually that is the pointer in fbq_global,
+ * but for the most used filters FixedUnit names the kernel at compile time instead. The
+ * switch in GetQFPtrFilterUnit then folds away and the kernel is inlined into the loop,
+ * which lets its registers stay in registers from one sample to the next.
+ */
+struct PointerUnit
+{
+    static SURGE_ALWAYS_INLINE __m128 process(const fbq_global &g,
+                                              sst::filters::QuadFilterUnitState *f, __m128 in)
+    {
+        return g.FU1ptr(f, in);
+    }
+};
+
+template <sst::filters::FilterType FT, sst::filters::FilterSubType FST> struct FixedUnit
+{
+    static SURGE_ALWAYS_INLINE __m128 process(const fbq_global &,
+                                              sst::filters::QuadFilterUnitState *f, __m128 in)
+    {
+        return sst::filters::GetQFPtrFilterUnit(FT, FST)(f, in);
+    }
+};
+
+/*
+ * The body of both the generic chain, which calls filter unit 1 through g.FU1ptr, and the
+ * fixed ones below, which have its kernel compiled in.
+ */
+template <int config, bool A, bool WS, bool B, typename FU1 = PointerUnit>
+SURGE_ALWAYS_INLINE void ProcessFBQuadBody(QuadFilterChainState &d, fbq_global &g, float *OutL,
+                                           float *OutR)
 {
     const __m128 hb_c = _mm_set1_ps(0.5f); // If this is changed from 0.5, make sure to change
                                            // this in the code because it is assumed to be half
@@ -70,7 +99,7 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
             __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
 
             if (A)
-                x = g.FU1ptr(&d.FU[0], x);
+                x = FU1::process(g, &d.FU[0], x);
             if (WS)
             {
                 d.wsLPF = _mm_mul_ps(hb_c, _mm_add_ps(d.wsLPF, _mm_and_ps(mask, x)));
@@ -108,7 +137,7 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
             __m128 x = input, y = d.DR[k];
 
             if (A)
-                x = g.FU1ptr(&d.FU[0], x);
+                x = FU1::process(g, &d.FU[0], x);
             if (WS)
             {
                 d.wsLPF = _mm_mul_ps(hb_c, _mm_add_ps(d.wsLPF, _mm_and_ps(mask, x)));
@@ -148,7 +177,7 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
             __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
 
             if (A)
-                x = g.FU1ptr(&d.FU[0], x);
+                x = FU1::process(g, &d.FU[0], x);
             if (WS)
             {
                 d.wsLPF = _mm_mul_ps(hb_c, _mm_add_ps(d.wsLPF, _mm_and_ps(mask, x)));
@@ -190,7 +219,7 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
             __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
 
             if (A)
-                x = g.FU1ptr(&d.FU[0], x);
+                x = FU1::process(g, &d.FU[0], x);
             if (B)
                 y = g.FU2ptr(&d.FU[1], y);
 
@@ -223,7 +252,7 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
             __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
 
             if (A)
-                x = g.FU1ptr(&d.FU[0], x);
+                x = FU1::process(g, &d.FU[0], x);
             if (WS)
             {
                 d.wsLPF = _mm_mul_ps(hb_c, _mm_add_ps(d.wsLPF, _mm_and_ps(mask, x)));
@@ -256,7 +285,7 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
             __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
 
             if (A)
-                x = g.FU1ptr(&d.FU[0], x);
+                x = FU1::process(g, &d.FU[0], x);
             if (B)
                 y = g.FU2ptr(&d.FU[1], y);
 
@@ -292,7 +321,7 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
             __m128 mask = _mm_load_ps((float *)&d.FU[0].active);
 
             if (A)
-                x = g.FU1ptr(&d.FU[0], x);
+                x = FU1::process(g, &d.FU[0], x);
             if (B)
                 y = g.FU2ptr(&d.FU[1], y);
 
@@ -333,8 +362,8 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
 
             if (A)
             {
-                x = g.FU1ptr(&d.FU[0], x);
-                y = g.FU1ptr(&d.FU[2], y);
+                x = FU1::process(g, &d.FU[0], x);
+                y = FU1::process(g, &d.FU[2], y);
             }
 
             if (WS)
@@ -377,7 +406,28 @@ void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *O
     }
 }
 
-template <int config> FBQFPtr GetFBQPointer2(bool A, bool WS, bool B)
+template <int config, bool A, bool WS, bool B>
+void ProcessFBQuad(QuadFilterChainState &d, fbq_global &g, float *OutL, float *OutR)
+{
+    ProcessFBQuadBody<config, A, WS, B>(d, g, OutL, OutR);
+}
+
+/*
+ * Chains with the first filter unit fixed, which round exactly like the generic one. Without
+ * filter unit 1 there is nothing to fix, hence no A.
+ *
+ * GCC folds GetQFPtrFilterUnit and turns the call into a direct one, though by itself it
+ * won't inline the bigger kernels (the ladders) into a loop this size.
+ */
+template <int config, bool WS, bool B, sst::filters::FilterType FT,
+          sst::filters::FilterSubType FST>
+void ProcessFBQuadFixed(QuadFilterChainState &d, fbq_global &g, float *OutL, float *OutR)
+{
+    ProcessFBQuadBody<config, true, WS, B, FixedUnit<FT, FST>>(d, g, OutL, OutR);
+}
+
+template <int config>
+FBQFPtr GetFBQPointer2(bool A, bool WS, bool B)
 {
     if (A)
     {
@@ -440,6 +490,89 @@ FBQFPtr GetFBQPointer(int config, bool A, bool WS, bool B)
     return 0;
 }
 
+template <int config, sst::filters::FilterType FT, sst::filters::FilterSubType FST>
+FBQFPtr GetFixedFBQPointer3(bool WS, bool B)
+{
+    if (WS)
+    {
+        if (B)
+            return ProcessFBQuadFixed<config, 1, 1, FT, FST>;
+        else
+            return ProcessFBQuadFixed<config, 1, 0, FT, FST>;
+    }
+    else
+    {
+        if (B)
+            return ProcessFBQuadFixed<config, 0, 1, FT, FST>;
+        else
+            return ProcessFBQuadFixed<config, 0, 0, FT, FST>;
+    }
+}
+
+template <sst::filters::FilterType FT, sst::filters::FilterSubType FST>
+FBQFPtr GetFixedFBQPointer2(int config, bool WS, bool B)
+{
+    switch (config)
+    {
+    case fc_serial1:
+        return GetFixedFBQPointer3<fc_serial1, FT, FST>(WS, B);
+    case fc_serial2:
+        return GetFixedFBQPointer3<fc_serial2, FT, FST>(WS, B);
+    case fc_serial3:
+        return GetFixedFBQPointer3<fc_serial3, FT, FST>(WS, B);
+    case fc_dual1:
+        return GetFixedFBQPointer3<fc_dual1, FT, FST>(WS, B);
+    case fc_dual2:
+        return GetFixedFBQPointer3<fc_dual2, FT, FST>(WS, B);
+    case fc_ring:
+        return GetFixedFBQPointer3<fc_ring, FT, FST>(WS, B);
+    case fc_stereo:
+        return GetFixedFBQPointer3<fc_stereo, FT, FST>(WS, B);
+    case fc_wide:
+        return GetFixedFBQPointer3<fc_wide, FT, FST>(WS, B);
+    }
+    return 0;
+}
+
+/*
+ * We match on the kernel itself rather than on the type and subtype, since several subtypes
+ * share a kernel (their differences are in the coefficients) and any of them can use the
+ * fixed chain.
+ */
+FBQFPtr GetFixedFBQPointer(int config, const fbq_global &g)
+{
+    using namespace sst::filters;
+
+    if (!g.FU1ptr)
+        return 0;
+
+    bool WS = g.WSptr != 0, B = g.FU2ptr != 0;
+
+    if (g.FU1ptr == GetQFPtrFilterUnit(fut_lp12, st_Standard))
+        return GetFixedFBQPointer2<fut_lp12, st_Standard>(config, WS, B);
+    if (g.FU1ptr == GetQFPtrFilterUnit(fut_lp12, st_Driven))
+        return GetFixedFBQPointer2<fut_lp12, st_Driven>(config, WS, B);
+    if (g.FU1ptr == GetQFPtrFilterUnit(fut_lp24, st_Standard))
+        return GetFixedFBQPointer2<fut_lp24, st_Standard>(config, WS, B);
+    if (g.FU1ptr == GetQFPtrFilterUnit(fut_lp24, st_Driven))
+        return GetFixedFBQPointer2<fut_lp24, st_Driven>(config, WS, B);
+    if (g.FU1ptr == GetQFPtrFilterUnit(fut_obxd_2pole_lp, st_Standard))
+        return GetFixedFBQPointer2<fut_obxd_2pole_lp, st_Standard>(config, WS, B);
+    if (g.FU1ptr == GetQFPtrFilterUnit(fut_obxd_4pole, st_Standard))
+        return GetFixedFBQPointer2<fut_obxd_4pole, st_Standard>(config, WS, B);
+    if (g.FU1ptr == GetQFPtrFilterUnit(fut_k35_lp, st_Standard))
+        return GetFixedFBQPointer2<fut_k35_lp, st_Standard>(config, WS, B);
+    if (g.FU1ptr == GetQFPtrFilterUnit(fut_vintageladder, st_Standard))
+        return GetFixedFBQPointer2<fut_vintageladder, st_Standard>(config, WS, B);
+
+    return 0;
+}
+
+FBQFPtr GetFBQPointer(int config, const fbq_global &g)
+{
+    return GetFBQPointer(config, g.FU1ptr != 0, g.WSptr != 0, g.FU2ptr != 0);
+}
+
 void InitQuadFilterChainStateToZero(QuadFilterChainState *Q)
 {
     Q->Gain = _mm_setzero_ps();
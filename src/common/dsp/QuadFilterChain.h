@@ -122,6 +122,7 @@
  */
 
 #include "globals.h"
+#include "CPUFeatures.h"
 #include "sst/filters.h"
 #include "sst/waveshapers.h"
 
@@ -156,6 +157,20 @@ struct fbq_global
 
 typedef void (*FBQFPtr)(QuadFilterChainState &, fbq_global &, float *, float *);
 
+/*
+ * Every chain returned here rounds identically to ProcessFBOct, so a voice sounds the same
+ * whichever path picks it up.
+ */
 FBQFPtr GetFBQPointer(int config, bool A, bool WS, bool B);
 
+/*
+ * As above, taking A, WS and B from which of g's units are set. GetFixedFBQPointer instead
+ * returns, for the common filter kernels in filter unit 1 (the LP12/24, OB-Xd LP, K35 LP and
+ * Vintage Ladder ones), a chain with that kernel compiled in rather than called through
+ * g.FU1ptr, and null for any other. The result is identical; SurgeSynthesizer only uses them
+ * when SurgeStorage::useFixedFilterChains is set.
+ */
+FBQFPtr GetFBQPointer(int config, const fbq_global &g);
+FBQFPtr GetFixedFBQPointer(int config, const fbq_global &g);
+
 #endif // SURGE_SRC_COMMON_DSP_QUADFILTERCHAIN_H
@@ -0,0 +1,260 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "SceneOutputStage.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+static_assert(n_scenes == 2 && N_OUTPUTS == 2, "The scene output stage packs 2x2 lanes");
+static_assert(BLOCK_SIZE % 4 == 0, "The scene output stage transposes 4 samples at a time");
+
+namespace
+{
+constexpr double unity[5] = {1.0, 0.0, 0.0, 0.0, 0.0};
+
+/*
+ * The four lanes of doubles live in two SSE2 registers, scene A in lo and scene B in hi.
+ */
+struct Lanes
+{
+    __m128d lo, hi;
+};
+
+SURGE_ALWAYS_INLINE Lanes load(const double *p) { return {_mm_load_pd(p), _mm_load_pd(p + 2)}; }
+
+SURGE_ALWAYS_INLINE void store(double *p, Lanes v)
+{
+    _mm_store_pd(p, v.lo);
+    _mm_store_pd(p + 2, v.hi);
+}
+
+SURGE_ALWAYS_INLINE Lanes add(Lanes a, Lanes b)
+{
+    return {_mm_add_pd(a.lo, b.lo), _mm_add_pd(a.hi, b.hi)};
+}
+
+SURGE_ALWAYS_INLINE Lanes sub(Lanes a, Lanes b)
+{
+    return {_mm_sub_pd(a.lo, b.lo), _mm_sub_pd(a.hi, b.hi)};
+}
+
+SURGE_ALWAYS_INLINE Lanes mul(Lanes a, Lanes b)
+{
+    return {_mm_mul_pd(a.lo, b.lo), _mm_mul_pd(a.hi, b.hi)};
+}
+} // namespace
+
+SceneOutputStage::SceneOutputStage(SurgeStorage *storage) : storage(storage)
+{
+    for (auto &st : stages)
+    {
+        for (int i = 0; i < 5; ++i)
+        {
+            for (int l = 0; l < 4; ++l)
+            {
+                st.c[i][l] = unity[i];
+                st.target[i][l] = unity[i];
+                st.dc[i][l] = 0.0;
+            }
+        }
+    }
+
+    suspendAll();
+}
+
+void SceneOutputStage::suspend(int scene)
+{
+    for (auto &st : stages)
+    {
+        for (int l = 2 * scene; l < 2 * scene + 2; ++l)
+        {
+            st.z1[l] = 0.0;
+            st.z2[l] = 0.0;
+
+            for (int i = 0; i < 5; ++i)
+                st.dc[i][l] = 0.0;
+        }
+    }
+
+    instant[scene] = true;
+}
+
+void SceneOutputStage::suspendAll()
+{
+    for (int s = 0; s < n_scenes; ++s)
+        suspend(s);
+}
+
+void SceneOutputStage::setLowCut(int scene, bool on, float freq, int slope)
+{
+    double hp[5] = {};
+
+    if (on)
+    {
+        // a 12 dB/oct highpass from the RBJ cookbook, with the Q the low cut always had
+        const double Q = 0.4;
+        double omega = 2.0 * M_PI *
+                       std::min(0.499, 440.0 * storage->note_to_pitch_ignoring_tuning(freq) *
+                                           storage->dsamplerate_inv);
+        double cosi = std::cos(omega), sinu = std::sin(omega), alpha = sinu / (2.0 * Q);
+        double a0inv = 1.0 / (1.0 + alpha);
+
+        hp[0] = 0.5 * (1.0 + cosi) * a0inv;
+        hp[1] = -(1.0 + cosi) * a0inv;
+        hp[2] = 0.5 * (1.0 + cosi) * a0inv;
+        hp[3] = -2.0 * cosi * a0inv;
+        hp[4] = (1.0 - alpha) * a0inv;
+    }
+
+    for (int s = 0; s < n_stages; ++s)
+    {
+        auto &st = stages[s];
+        auto *t = (on && s <= slope) ? hp : unity;
+
+        for (int l = 2 * scene; l < 2 * scene + 2; ++l)
+        {
+            for (int i = 0; i < 5; ++i)
+            {
+                st.target[i][l] = t[i];
+
+                if (instant[scene])
+                {
+                    st.c[i][l] = t[i];
+                    st.dc[i][l] = 0.0;
+                }
+                else
+                {
+                    st.dc[i][l] = (t[i] - st.c[i][l]) * (1.0 / BLOCK_SIZE);
+                }
+            }
+        }
+    }
+
+    instant[scene] = false;
+}
+
+void SceneOutputStage::process(float (&sceneout)[n_scenes][N_OUTPUTS][BLOCK_SIZE_OS],
+                               const SurgeStorage::HardClipMode (&clipMode)[n_scenes])
+{
+    for (auto &st : stages)
+    {
+        st.live = false;
+        st.gliding = false;
+
+        for (int i = 0; i < 5; ++i)
+        {
+            for (int l = 0; l < 4; ++l)
+            {
+                st.live = st.live || st.c[i][l] != unity[i] || st.target[i][l] != unity[i];
+                st.gliding = st.gliding || st.dc[i][l] != 0.0;
+            }
+        }
+
+        // a stage nobody is using passes its input through untouched, so its state goes
+        if (!st.live)
+        {
+            for (int l = 0; l < 4; ++l)
+            {
+                st.z1[l] = 0.0;
+                st.z2[l] = 0.0;
+            }
+        }
+    }
+
+    float limit[4], mask[4];
+    for (int s = 0; s < n_scenes; ++s)
+    {
+        bool clip = clipMode[s] == SurgeStorage::HARDCLIP_TO_18DBFS ||
+                    clipMode[s] == SurgeStorage::HARDCLIP_TO_0DBFS;
+        float lim = clipMode[s] == SurgeStorage::HARDCLIP_TO_0DBFS ? 1.f : 8.f;
+        uint32_t m = clip ? 0xFFFFFFFF : 0;
+
+        for (int c = 0; c < N_OUTPUTS; ++c)
+        {
+            limit[2 * s + c] = lim;
+            memcpy(&mask[2 * s + c], &m, sizeof(m));
+        }
+    }
+
+    const auto lim = _mm_loadu_ps(limit), clipMask = _mm_loadu_ps(mask);
+    const auto negLim = _mm_sub_ps(_mm_setzero_ps(), lim);
+    auto &so = sceneout;
+
+    for (int k = 0; k < BLOCK_SIZE; k += 4)
+    {
+        // four samples each of A L, A R, B L and B R become four samples of (A L, A R, B L, B R)
+        __m128 smp[4] = {_mm_load_ps(&so[0][0][k]), _mm_load_ps(&so[0][1][k]),
+                         _mm_load_ps(&so[1][0][k]), _mm_load_ps(&so[1][1][k])};
+        _MM_TRANSPOSE4_PS(smp[0], smp[1], smp[2], smp[3]);
+
+        for (int j = 0; j < 4; ++j)
+        {
+            Lanes x = {_mm_cvtps_pd(smp[j]), _mm_cvtps_pd(_mm_movehl_ps(smp[j], smp[j]))};
+
+            for (auto &st : stages)
+            {
+                if (!st.live)
+                    continue;
+
+                if (st.gliding)
+                {
+                    for (int i = 0; i < 5; ++i)
+                        store(st.c[i], add(load(st.c[i]), load(st.dc[i])));
+                }
+
+                // transposed direct form II
+                auto y = add(mul(load(st.c[0]), x), load(st.z1));
+                store(st.z1, sub(add(mul(load(st.c[1]), x), load(st.z2)), mul(load(st.c[3]), y)));
+                store(st.z2, sub(mul(load(st.c[2]), x), mul(load(st.c[4]), y)));
+                x = y;
+            }
+
+            auto y = _mm_movelh_ps(_mm_cvtpd_ps(x.lo), _mm_cvtpd_ps(x.hi));
+            auto clipped = _mm_max_ps(_mm_min_ps(y, lim), negLim);
+            smp[j] = _mm_or_ps(_mm_and_ps(clipMask, clipped), _mm_andnot_ps(clipMask, y));
+        }
+
+        _MM_TRANSPOSE4_PS(smp[0], smp[1], smp[2], smp[3]);
+        _mm_store_ps(&so[0][0][k], smp[0]);
+        _mm_store_ps(&so[0][1][k], smp[1]);
+        _mm_store_ps(&so[1][0][k], smp[2]);
+        _mm_store_ps(&so[1][1][k], smp[3]);
+    }
+
+    // land exactly on the targets rather than wherever the sums of the steps took us
+    for (auto &st : stages)
+    {
+        if (!st.gliding)
+            continue;
+
+        for (int i = 0; i < 5; ++i)
+        {
+            for (int l = 0; l < 4; ++l)
+            {
+                st.c[i][l] = st.target[i][l];
+                st.dc[i][l] = 0.0;
+            }
+        }
+    }
+}
@@ -0,0 +1,82 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_DSP_SCENEOUTPUTSTAGE_H
+#define SURGE_SRC_COMMON_DSP_SCENEOUTPUTSTAGE_H
+
+#include "SurgeStorage.h"
+#include "CPUFeatures.h"
+
+/*
+ * The end of the scene path, once the scenes have been decimated: the scene low cut (up to
+ * four 12 dB/oct highpass biquads, depending on its slope) and then the scene hardclip.
+ *
+ * Rather than running each biquad over each scene in turn, this keeps scene A left and
+ * right and scene B left and right side by side as the four lanes of one vector and runs
+ * the whole cascade, and the clip, in a single pass over the block. The biquads run in
+ * double precision (so each vector is a pair of SSE2 registers) since a low cut at a few Hz
+ * is badly behaved in float.
+ *
+ * Stages a scene doesn't use have unity coefficients, and coefficients glide over a block
+ * when the cutoff, slope or on/off state changes.
+ */
+class SceneOutputStage
+{
+  public:
+    static constexpr int n_stages = 4;
+
+    explicit SceneOutputStage(SurgeStorage *storage);
+
+    /*
+     * Clear a scene's filter state. The next setLowCut takes effect immediately rather than
+     * gliding there.
+     */
+    void suspend(int scene);
+    void suspendAll();
+
+    /*
+     * Call once per block for each scene before process. freq is the low cut parameter (in
+     * semitones from A440) and slope the number of stages less one.
+     */
+    void setLowCut(int scene, bool on, float freq, int slope);
+
+    void process(float (&sceneout)[n_scenes][N_OUTPUTS][BLOCK_SIZE_OS],
+                 const SurgeStorage::HardClipMode (&clipMode)[n_scenes]);
+
+    /*
+     * One biquad of the cascade across the four lanes (scene A L and R, scene B L and R).
+     * The coefficients are b0, b1, b2, a1 and a2, normalized by a0.
+     */
+    struct alignas(16) Stage
+    {
+        double c[5][4], dc[5][4], target[5][4];
+        double z1[4], z2[4];
+        bool live, gliding;
+    };
+
+  private:
+    SurgeStorage *storage;
+    Stage stages[n_stages];
+    bool instant[n_scenes];
+};
+
+#endif // SURGE_SRC_COMMON_DSP_SCENEOUTPUTSTAGE_H
@@ -24,6 +24,7 @@
 #include "UserDefaults.h"
 #include "DSPUtils.h"
 #include "QuadFilterChain.h"
+#include "SurgeMemoryPools.h"
 #include "globals.h"
 #include <cmath>
 #ifndef SURGE_SKIP_ODDSOUND_MTS
@@ -372,6 +373,9 @@ SurgeVoice::SurgeVoice(SurgeStorage *storage, SurgeSceneStorage *oscene, pdata *
         lfo[i].attack();
     }
 
+    begin_block();
+    ampEGSource.process_block();
+    filterEGSource.process_block();
     calc_ctrldata<true>(0, 0); // init interpolators
     SetQFB(0, 0);              // init Quad Filter Block parameter interpolators
 
@@ -524,18 +528,15 @@ void SurgeVoice::switch_toggled()
         if (osctype[i] != scene->osc[i].type.val.i)
         {
             bool nzid = scene->drift.extend_range;
-            osc[i] = spawn_osc(scene->osc[i].type.val.i, storage, &scene->osc[i], localcopy,
-                               oscbuffer[i]);
-            if (osc[i])
-            {
-                // this matches the override in ::process_block
-                float ktrkroot = 60;
-                auto usep = noteShiftFromPitchParam(
-                    (scene->osc[i].keytrack.val.b ? state.pitch : ktrkroot + state.scenepbpitch) +
-                        octaveSize * scene->osc[i].octave.val.i,
-                    0);
-                osc[i]->init(usep, false, nzid);
-            }
+            // this matches the override in ::process_block
+            float ktrkroot = 60;
+            auto usep = noteShiftFromPitchParam(
+                (scene->osc[i].keytrack.val.b ? state.pitch : ktrkroot + state.scenepbpitch) +
+                    octaveSize * scene->osc[i].octave.val.i,
+                0);
+            osc[i] = storage->memoryPools->oscPrototypes[state.scene_id][i].spawnVoice(
+                scene->osc[i].type.val.i, storage, &scene->osc[i],
+                storage->getPatch().scenedata[state.scene_id], localcopy, oscbuffer[i], usep, nzid);
             osctype[i] = scene->osc[i].type.val.i;
         }
     }
@@ -617,6 +618,7 @@ void SurgeVoice::switch_toggled()
             }
 
             CM[u].Reset();
+            lastCoeffInputs[u] = FilterCoeffInputs();
         }
     }
 }
@@ -724,26 +726,61 @@ int SurgeVoice::routefilter(int r)
     return r;
 }
 
-template <bool first> void SurgeVoice::calc_ctrldata(QuadFilterChainState *Q, int e)
+void SurgeVoice::begin_block()
+{
+    SurgeVoice *self = this;
+    begin_block_quad(&self, 1);
+}
+
+void SurgeVoice::begin_block_quad(SurgeVoice *const *voices, int n)
 {
-    // Always process LFO1 so the gate retrigger always work
-    lfo[0].process_block();
-    velocitySource.process_block();
+    // the voices are all in one scene, so they run the same LFOs
+    auto *scene = voices[0]->scene;
+    LFOModulationSource *lfos[4];
 
     for (int i = 0; i < n_lfos_voice; i++)
     {
+        for (int v = 0; v < n; ++v)
+        {
+            lfos[v] = &voices[v]->lfo[i];
+        }
+
+        // Always process LFO1 so the gate retrigger always work
+        if (i == 0)
+        {
+            LFOModulationSource::process_block_quad(lfos, n);
+
+            for (int v = 0; v < n; ++v)
+            {
+                voices[v]->velocitySource.process_block();
+            }
+        }
+
         if (scene->lfo[i].shape.val.i == lt_formula)
         {
-            Surge::Formula::setupEvaluatorStateFrom(lfo[i].formulastate, storage->getPatch());
-            Surge::Formula::setupEvaluatorStateFrom(lfo[i].formulastate, this);
+            for (int v = 0; v < n; ++v)
+            {
+                Surge::Formula::setupEvaluatorStateFrom(voices[v]->lfo[i].formulastate,
+                                                        voices[v]->storage->getPatch());
+                Surge::Formula::setupEvaluatorStateFrom(voices[v]->lfo[i].formulastate,
+                                                        voices[v]);
+            }
         }
 
         if (i != 0 && scene->modsource_doprocess[ms_lfo1 + i])
         {
-            lfo[i].process_block();
+            LFOModulationSource::process_block_quad(lfos, n);
         }
     }
 
+    for (int v = 0; v < n; ++v)
+    {
+        voices[v]->retriggerEnvelopesFromLFOs();
+    }
+}
+
+void SurgeVoice::retriggerEnvelopesFromLFOs()
+{
     auto pm = scene->polymode.val.i;
 
     bool fromCurrent = (pm == pm_poly && scene->polyVoiceRepeatedKeyMode ==
@@ -768,10 +805,10 @@ template <bool first> void SurgeVoice::calc_ctrldata(QuadFilterChainState *Q, in
             ms->retriggerFrom(val);
         }
     }
+}
 
-    modsources[ms_ampeg]->process_block();
-    modsources[ms_filtereg]->process_block();
-
+template <bool first> void SurgeVoice::calc_ctrldata(QuadFilterChainState *Q, int e)
+{
     if (((ADSRModulationSource *)modsources[ms_ampeg])->is_idle())
     {
         state.keep_playing = false;
@@ -1005,6 +1042,15 @@ inline void all_ring_modes_block(float *__restrict src1_l, float *__restrict src
 }
 
 bool SurgeVoice::process_block(QuadFilterChainState &Q, int Qe)
+{
+    begin_block();
+    ampEGSource.process_block();
+    filterEGSource.process_block();
+
+    return finish_block(Q, Qe);
+}
+
+bool SurgeVoice::finish_block(QuadFilterChainState &Q, int Qe)
 {
     calc_ctrldata<0>(&Q, Qe);
 
@@ -1455,15 +1501,10 @@ void SurgeVoice::SetQFB(QuadFilterChainState *Q, int e) // Q == 0 means init(ial
         if (scene->f2_cutoff_is_offset.val.b)
             cutoffB += cutoffA;
 
-        CM[0].MakeCoeffs(cutoffA, localcopy[id_resoa].f,
-                         static_cast<FilterType>(scene->filterunit[0].type.val.i),
-                         static_cast<FilterSubType>(scene->filterunit[0].subtype.val.i), storage,
-                         scene->filterunit[0].cutoff.extend_range);
-        CM[1].MakeCoeffs(
-            cutoffB, scene->f2_link_resonance.val.b ? localcopy[id_resoa].f : localcopy[id_resob].f,
-            static_cast<FilterType>(scene->filterunit[1].type.val.i),
-            static_cast<FilterSubType>(scene->filterunit[1].subtype.val.i), storage,
-            scene->filterunit[1].cutoff.extend_range);
+        makeFilterCoeffs(0, cutoffA, localcopy[id_resoa].f);
+        makeFilterCoeffs(1, cutoffB,
+                         scene->f2_link_resonance.val.b ? localcopy[id_resoa].f
+                                                        : localcopy[id_resob].f);
 
         for (int u = 0; u < n_filterunits_per_scene; u++)
         {
@@ -1494,6 +1535,65 @@ void SurgeVoice::SetQFB(QuadFilterChainState *Q, int e) // Q == 0 means init(ial
     }
 }
 
+void SurgeVoice::makeFilterCoeffs(int u, float cutoff, float reso)
+{
+    using namespace sst::filters;
+
+    // cutoff is in semitones, so this is well below anything audible
+    static constexpr float cutoffTolerance = 1e-4f, resoTolerance = 1e-6f;
+    static constexpr float settledTolerance = 1e-5f;
+
+    auto &fu = scene->filterunit[u];
+    auto &last = lastCoeffInputs[u];
+
+    /*
+     * A tuning-adjusted cutoff also depends on the tuning, which an MTS-ESP source can
+     * change underneath us without any notice, so in that case we always recalculate.
+     */
+    bool tuningMayMove = fu.cutoff.extend_range && storage->oddsound_mts_active_as_client;
+
+    if (last.settled && !tuningMayMove && last.type == fu.type.val.i &&
+        last.subtype == fu.subtype.val.i && last.extended == fu.cutoff.extend_range &&
+        last.tuningUpdates == storage->tuningUpdates &&
+        std::fabs(cutoff - last.cutoff) <= cutoffTolerance &&
+        std::fabs(reso - last.reso) <= resoTolerance)
+    {
+        // hold the coefficients where the last glide left them
+        for (int i = 0; i < n_cm_coeffs; i++)
+            CM[u].dC[i] = 0.f;
+
+        return;
+    }
+
+    /*
+     * If the inputs are unchanged we still have to run MakeCoeffs until the glide towards
+     * them has converged, which is when a block's coefficient step has become negligible.
+     */
+    bool unchanged = last.type == fu.type.val.i && last.subtype == fu.subtype.val.i &&
+                     last.extended == fu.cutoff.extend_range && last.cutoff == cutoff &&
+                     last.reso == reso;
+
+    CM[u].MakeCoeffs(cutoff, reso, static_cast<FilterType>(fu.type.val.i),
+                     static_cast<FilterSubType>(fu.subtype.val.i), storage,
+                     fu.cutoff.extend_range);
+
+    bool settled = unchanged;
+
+    for (int i = 0; i < n_cm_coeffs && settled; i++)
+    {
+        settled = std::fabs(CM[u].dC[i]) * BLOCK_SIZE_OS <=
+                  settledTolerance * std::max(1.f, std::fabs(CM[u].C[i]));
+    }
+
+    last.cutoff = cutoff;
+    last.reso = reso;
+    last.type = fu.type.val.i;
+    last.subtype = fu.subtype.val.i;
+    last.extended = fu.cutoff.extend_range;
+    last.tuningUpdates = storage->tuningUpdates;
+    last.settled = settled;
+}
+
 void SurgeVoice::GetQFB()
 {
     using namespace sst::filters;
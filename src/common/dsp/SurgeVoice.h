@@ -57,6 +57,23 @@ class alignas(16) SurgeVoice
 
     void sampleRateReset();
     bool process_block(QuadFilterChainState &, int);
+
+    /*
+     * process_block in two halves, around the step of the amp and filter envelopes, so the
+     * synth can step the envelopes of a quad of voices together with
+     * ADSRModulationSource::process_block_quad. begin_block runs the LFOs and any envelope
+     * retriggers they cause, and finish_block is everything after.
+     */
+    void begin_block();
+    bool finish_block(QuadFilterChainState &, int);
+
+    /*
+     * begin_block for up to four voices of a scene, stepping each voice LFO across all of
+     * them with LFOModulationSource::process_block_quad.
+     */
+    static void begin_block_quad(SurgeVoice *const *voices, int n);
+    ADSRModulationSource *ampEG() { return &ampEGSource; }
+    ADSRModulationSource *filterEG() { return &filterEGSource; }
     void GetQFB(); // Get the updated registers from the QuadFB
     void legato(int key, int velocity, char detune);
     void switch_toggled();
@@ -213,6 +230,7 @@ class alignas(16) SurgeVoice
 
   private:
     template <bool first> void calc_ctrldata(QuadFilterChainState *, int);
+    void retriggerEnvelopesFromLFOs();
 
     /*
      * Some modulations at the voice level were applied to the local
@@ -259,6 +277,21 @@ class alignas(16) SurgeVoice
     } FBP;
     sst::filters::FilterCoefficientMaker<SurgeStorage> CM[2];
 
+    /*
+     * What CM[u] last made its coefficients from. MakeCoeffs glides the target coefficients
+     * over a few blocks, so once the inputs stop moving and the glide has settled we can skip
+     * the (tan and exp heavy) recalculation and just hold the coefficients.
+     */
+    struct FilterCoeffInputs
+    {
+        float cutoff{0.f}, reso{0.f};
+        int type{-1}, subtype{-1};
+        bool extended{false};
+        uint64_t tuningUpdates{0};
+        bool settled{false};
+    } lastCoeffInputs[n_filterunits_per_scene];
+    void makeFilterCoeffs(int u, float cutoff, float reso);
+
     // data
     int lag_id[8], pitch_id, octave_id, volume_id, pan_id, width_id;
     SurgeStorage *storage;
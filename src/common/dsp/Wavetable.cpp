@@ -24,6 +24,18 @@
 #include "DSPUtils.h"
 #include <vembertech/basic_dsp.h>
 #include "SurgeStorage.h"
+#include "MappedFile.h"
+
+#include <map>
+#include <mutex>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <array>
+#include <algorithm>
+#include <chrono>
+#include <vector>
 
 #include "sst/basic-blocks/mechanics/endian-ops.h"
 namespace mech = sst::basic_blocks::mechanics;
@@ -97,13 +109,21 @@ int GetWTIndex(int WaveIdx, int WaveSize, int NumWaves, int MipMap, int Padding
     return Index;
 }
 
+WavetableData::WavetableData(size_t newSize, size_t newMappedF32Samples)
+    : dataSizes(newSize), mappedF32Samples(newMappedF32Samples)
+{
+    auto f32Samples = dataSizes - mappedF32Samples;
+    auto bytes = f32Samples * sizeof(float) + dataSizes * sizeof(short);
+    TableF32Data = (float *)malloc(bytes);
+    TableI16Data = (short *)(TableF32Data + f32Samples);
+    memset(TableF32Data, 0, bytes);
+}
+
+WavetableData::~WavetableData() { free(TableF32Data); }
+
 Wavetable::Wavetable()
 {
-    dataSizes = 35000;
-    TableF32Data = (float *)malloc(dataSizes * sizeof(float));
-    TableI16Data = (short *)malloc(dataSizes * sizeof(short));
-    memset(TableF32Data, 0, dataSizes * sizeof(float));
-    memset(TableI16Data, 0, dataSizes * sizeof(short));
+    data = std::make_shared<WavetableData>(35000);
     memset(TableF32WeakPointers, 0, sizeof(TableF32WeakPointers));
     memset(TableI16WeakPointers, 0, sizeof(TableI16WeakPointers));
     current_id = -1;
@@ -112,22 +132,9 @@ Wavetable::Wavetable()
     refresh_display = true; // I have never been drawn so assume I need refresh if asked
 }
 
-Wavetable::~Wavetable()
-{
-    free(TableF32Data);
-    free(TableI16Data);
-}
+Wavetable::~Wavetable() {}
 
-void Wavetable::allocPointers(size_t newSize)
-{
-    free(TableF32Data);
-    free(TableI16Data);
-    dataSizes = newSize;
-    TableF32Data = (float *)malloc(dataSizes * sizeof(float));
-    TableI16Data = (short *)malloc(dataSizes * sizeof(short));
-    memset(TableF32Data, 0, dataSizes * sizeof(float));
-    memset(TableI16Data, 0, dataSizes * sizeof(short));
-}
+void Wavetable::allocPointers(size_t newSize) { data = std::make_shared<WavetableData>(newSize); }
 
 void Wavetable::Copy(Wavetable *wt)
 {
@@ -141,37 +148,73 @@ void Wavetable::Copy(Wavetable *wt)
     queue_id = -1;
     everBuilt = wt->everBuilt;
 
-    if (dataSizes < wt->dataSizes)
+    // built table memory is never written again, so we can share it rather than copy it
+    data = wt->data;
+    memcpy(TableF32WeakPointers, wt->TableF32WeakPointers, sizeof(TableF32WeakPointers));
+    memcpy(TableI16WeakPointers, wt->TableI16WeakPointers, sizeof(TableI16WeakPointers));
+
+    current_id = wt->current_id;
+}
+
+void Wavetable::adoptData(const std::shared_ptr<WavetableData> &d)
+{
+    data = d;
+
+    size = d->size;
+    n_tables = d->n_tables;
+    size_po2 = d->size_po2;
+    flags = d->flags;
+    dt = 1.0f / size;
+
+    setupTablePointers();
+
+    everBuilt = true;
+}
+
+void Wavetable::setupTablePointers()
+{
+    /*
+     * This lays out the same pointers BuildWT and MipMapWT write into, so that adoptData
+     * can reconstitute a table from the data alone.
+     */
+    auto d = data.get();
+    auto i16 = d->TableI16Data;
+
+    memset(TableF32WeakPointers, 0, sizeof(TableF32WeakPointers));
+    memset(TableI16WeakPointers, 0, sizeof(TableI16WeakPointers));
+
+    for (int j = 0; j < this->n_tables; j++)
     {
-        allocPointers(wt->dataSizes);
+        TableF32WeakPointers[0][j] = d->f32At(GetWTIndex(j, size, n_tables, 0));
+        // + padding for a non-wrapping interpolator
+        TableI16WeakPointers[0][j] = i16 + GetWTIndex(j, size, n_tables, 0, FIRipolI16_N);
     }
 
-    memcpy(TableF32Data, wt->TableF32Data, dataSizes * sizeof(float));
-    memcpy(TableI16Data, wt->TableI16Data, dataSizes * sizeof(short));
-
-    for (int i = 0; i < max_mipmap_levels; i++)
+    for (int j = this->n_tables; j < min_F32_tables; j++)
     {
-        for (int j = 0; j < max_subtables; j++)
-        {
-            if (wt->TableF32WeakPointers[i][j])
-            {
-                size_t Offset = wt->TableF32WeakPointers[i][j] - wt->TableF32Data;
-                TableF32WeakPointers[i][j] = TableF32Data + Offset;
-            }
-            else
-                TableF32WeakPointers[i][j] = NULL;
+        unsigned int s = this->size;
+        int l = 0;
 
-            if (wt->TableI16WeakPointers[i][j])
-            {
-                size_t Offset = wt->TableI16WeakPointers[i][j] - wt->TableI16Data;
-                TableI16WeakPointers[i][j] = TableI16Data + Offset;
-            }
-            else
-                TableI16WeakPointers[i][j] = NULL;
+        while (s && (l < max_mipmap_levels))
+        {
+            TableF32WeakPointers[l][j] = d->f32At(GetWTIndex(j, size, n_tables, l));
+            s = s >> 1;
+            l++;
         }
     }
 
-    current_id = wt->current_id;
+    int levels = 1;
+    while (((1 << levels) < size) & (levels < max_mipmap_levels))
+        levels++;
+
+    for (int l = 1; l < levels; l++)
+    {
+        for (int j = 0; j < this->n_tables; j++)
+        {
+            TableF32WeakPointers[l][j] = d->f32At(GetWTIndex(j, size, n_tables, l));
+            TableI16WeakPointers[l][j] = i16 + GetWTIndex(j, size, n_tables, l, FIRipolI16_N);
+        }
+    }
 }
 
 bool Wavetable::BuildWT(void *wdata, wt_header &wh, bool AppendSilence)
@@ -184,9 +227,14 @@ bool Wavetable::BuildWT(void *wdata, wt_header &wh, bool AppendSilence)
 
     size_t req_size = RequiredWTSize(size, n_tables);
 
-    if (req_size > dataSizes)
+    /*
+     * Copy on write: if anyone else can see our current data (a copy of this wavetable or
+     * the cache), or it is partly a file mapping, build into fresh memory rather
+     * than through it.
+     */
+    if (req_size > data->dataSizes || data.use_count() > 1 || data->published || data->mapping)
     {
-        allocPointers(req_size);
+        allocPointers(std::max(req_size, (size_t)35000));
     }
 
     int wdata_tables = n_tables;
@@ -196,48 +244,7 @@ bool Wavetable::BuildWT(void *wdata, wt_header &wh, bool AppendSilence)
         n_tables += 3; // this "3" should match the "3" in RequiredWTSize
     }
 
-#if WINDOWS
-    unsigned long MSBpos;
-    _BitScanReverse(&MSBpos, size);
-#else
-    unsigned int MSBpos;
-    _BitScanReverse(&MSBpos, size);
-#endif
-
-    size_po2 = MSBpos;
-
-    dt = 1.0f / size;
-
-    for (int i = 0; i < max_mipmap_levels; i++)
-    {
-        for (int j = 0; j < max_subtables; j++)
-        {
-            // TODO WARNING: Crashes here with patchbyte!
-            /*free(wt->TableF32WeakPointers[i][j]);
-            free(wt->TableI16WeakPointers[i][j]);
-            wt->TableF32WeakPointers[i][j] = 0;
-            wt->TableI16WeakPointers[i][j] = 0;*/
-        }
-    }
-    for (int j = 0; j < this->n_tables; j++)
-    {
-        TableF32WeakPointers[0][j] = TableF32Data + GetWTIndex(j, size, n_tables, 0);
-        // + padding for a non-wrapping interpolator
-        TableI16WeakPointers[0][j] = TableI16Data + GetWTIndex(j, size, n_tables, 0, FIRipolI16_N);
-    }
-    for (int j = this->n_tables; j < min_F32_tables; j++)
-    {
-        unsigned int s = this->size;
-        int l = 0;
-
-        while (s && (l < max_mipmap_levels))
-        {
-            TableF32WeakPointers[l][j] = TableF32Data + GetWTIndex(j, size, n_tables, l);
-            memset(TableF32WeakPointers[l][j], 0, s * sizeof(float));
-            s = s >> 1;
-            l++;
-        }
-    }
+    prepareTables();
 
     if (this->flags & wtf_int16)
     {
@@ -272,6 +279,72 @@ bool Wavetable::BuildWT(void *wdata, wt_header &wh, bool AppendSilence)
         memset(this->TableI16WeakPointers[0][j], 0, (this->size + FIRoffsetI16) * sizeof(short));
     }
 
+    finishBuild(wdata_tables);
+    return true;
+}
+
+bool Wavetable::BuildWTMapped(const std::shared_ptr<Surge::Storage::MappedFile> &f,
+                              size_t dataOffset, wt_header &wh)
+{
+    assert(f);
+
+    flags = mech::endian_read_int16LE(wh.flags);
+    n_tables = mech::endian_read_int16LE(wh.n_tables);
+    size = mech::endian_read_int32LE(wh.n_samples);
+
+    assert(!(flags & wtf_int16));
+
+    // level 0 is n_tables * size floats at the front of the layout, and those are the file
+    size_t mapped = (size_t)n_tables * size;
+    auto nd = std::make_shared<WavetableData>(RequiredWTSize(size, n_tables), mapped);
+    nd->mapping = f;
+    nd->mappedF32 = reinterpret_cast<float *>(f->data() + dataOffset);
+    data = nd;
+
+    prepareTables();
+
+    for (int j = 0; j < n_tables; j++)
+    {
+        float2i15_block(this->TableF32WeakPointers[0][j],
+                        &this->TableI16WeakPointers[0][j][FIRoffsetI16], this->size);
+    }
+
+    finishBuild(n_tables);
+    return true;
+}
+
+void Wavetable::prepareTables()
+{
+#if WINDOWS
+    unsigned long MSBpos;
+    _BitScanReverse(&MSBpos, size);
+#else
+    unsigned int MSBpos;
+    _BitScanReverse(&MSBpos, size);
+#endif
+
+    size_po2 = MSBpos;
+
+    dt = 1.0f / size;
+
+    setupTablePointers();
+
+    for (int j = this->n_tables; j < min_F32_tables; j++)
+    {
+        unsigned int s = this->size;
+        int l = 0;
+
+        while (s && (l < max_mipmap_levels))
+        {
+            memset(TableF32WeakPointers[l][j], 0, s * sizeof(float));
+            s = s >> 1;
+            l++;
+        }
+    }
+}
+
+void Wavetable::finishBuild(int wdata_tables)
+{
     for (int j = 0; j < wdata_tables; j++)
     {
         memcpy(&this->TableI16WeakPointers[0][j][this->size + FIRoffsetI16],
@@ -282,8 +355,12 @@ bool Wavetable::BuildWT(void *wdata, wt_header &wh, bool AppendSilence)
 
     MipMapWT();
 
+    data->size = size;
+    data->n_tables = n_tables;
+    data->size_po2 = size_po2;
+    data->flags = flags;
+
     everBuilt = true;
-    return true;
 }
 
 void Wavetable::MipMapWT()
@@ -303,10 +380,6 @@ void Wavetable::MipMapWT()
 
         for (int s = 0; s < ns; s++)
         {
-            this->TableF32WeakPointers[l][s] = TableF32Data + GetWTIndex(s, size, n_tables, l);
-            this->TableI16WeakPointers[l][s] =
-                TableI16Data + GetWTIndex(s, size, n_tables, l, FIRipolI16_N);
-
             if (this->flags & wtf_is_sample)
             {
                 for (int i = 0; i < lsize; i++)
@@ -363,3 +436,538 @@ void Wavetable::MipMapWT()
     // so it becomes out of phase at mipmap switch - makes sense because as they were off by a whole
     // sample at the mipmap switch, which cannot be explained by the half rate filter
 }
+
+bool WavetableCache::keyFor(const std::string &filename, Key &k)
+{
+    std::error_code ec;
+    auto p = string_to_path(filename);
+
+    auto sz = fs::file_size(p, ec);
+    if (ec)
+        return false;
+
+    auto mt = fs::last_write_time(p, ec);
+    if (ec)
+        return false;
+
+    k.path = filename;
+    k.fileSize = (uint64_t)sz;
+    k.mtime = (int64_t)mt.time_since_epoch().count();
+    return true;
+}
+
+namespace
+{
+struct WavetableCacheStore
+{
+    std::mutex m;
+    std::map<WavetableCache::Key, std::weak_ptr<WavetableData>> entries;
+};
+
+WavetableCacheStore &cacheStore()
+{
+    static WavetableCacheStore s;
+    return s;
+}
+} // namespace
+
+std::shared_ptr<WavetableData> WavetableCache::find(const Key &k)
+{
+    auto &c = cacheStore();
+    std::lock_guard<std::mutex> g(c.m);
+
+    auto it = c.entries.find(k);
+    if (it == c.entries.end())
+        return nullptr;
+
+    auto res = it->second.lock();
+    if (!res)
+        c.entries.erase(it);
+
+    return res;
+}
+
+void WavetableCache::insert(const Key &k, const std::shared_ptr<WavetableData> &d)
+{
+    if (!d)
+        return;
+
+    auto &c = cacheStore();
+    std::lock_guard<std::mutex> g(c.m);
+
+    // prune anything which has been released since we last looked
+    for (auto it = c.entries.begin(); it != c.entries.end();)
+    {
+        if (it->second.expired())
+            it = c.entries.erase(it);
+        else
+            ++it;
+    }
+
+    d->published = true;
+    c.entries[k] = d;
+}
+
+size_t WavetableCache::liveEntries()
+{
+    auto &c = cacheStore();
+    std::lock_guard<std::mutex> g(c.m);
+
+    size_t res = 0;
+    for (const auto &e : c.entries)
+    {
+        if (!e.second.expired())
+            res++;
+    }
+
+    return res;
+}
+
+namespace
+{
+#pragma pack(push, 1)
+struct wtc_header
+{
+    char tag[4];
+    uint32_t version;
+    uint32_t byteOrderMark;
+    int32_t firipolI16N, firoffsetI16;
+
+    int64_t mtime;
+    uint64_t fileSize;
+    uint32_t pathLength;
+
+    int32_t size;
+    uint32_t n_tables;
+    int32_t size_po2;
+    int32_t flags;
+    uint64_t samples;
+};
+#pragma pack(pop)
+
+const uint32_t wtcByteOrderMark = 0x01020304;
+
+bool wtcHeaderIsCurrent(const wtc_header &h)
+{
+    return h.tag[0] == 's' && h.tag[1] == 'w' && h.tag[2] == 't' && h.tag[3] == 'c' &&
+           h.version == WavetableDiskCache::formatVersion && h.byteOrderMark == wtcByteOrderMark &&
+           h.firipolI16N == FIRipolI16_N && h.firoffsetI16 == FIRoffsetI16;
+}
+
+/*
+ * adoptData lays table pointers out over RequiredWTSize(size, n_tables) samples, so a file
+ * only describes a usable table if it has exactly that many and the shape is one BuildWT
+ * could have produced. Anything else (truncated, stale or corrupt) is a miss.
+ */
+bool wtcShapeIsValid(const wtc_header &h)
+{
+    if (h.size <= 0 || h.size > max_wtable_size || (h.size & (h.size - 1)) != 0)
+    {
+        return false;
+    }
+
+    int po2 = 0;
+    while ((1 << po2) < h.size)
+    {
+        po2++;
+    }
+
+    return h.size_po2 == po2 && h.n_tables >= 1 && h.n_tables <= max_subtables + 3 &&
+           h.samples == RequiredWTSize(h.size, h.n_tables);
+}
+} // namespace
+
+fs::path WavetableDiskCache::cacheFileFor(const fs::path &cacheDir, const WavetableCache::Key &k)
+{
+    // FNV-1a, which is plenty to spread paths over file names. Collisions are caught by the
+    // full path stored in the file.
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (auto c : k.path)
+    {
+        h ^= (uint8_t)c;
+        h *= 0x100000001b3ULL;
+    }
+
+    char fn[32];
+    snprintf(fn, 32, "%016llx.wtc", (unsigned long long)h);
+    return cacheDir / fn;
+}
+
+std::shared_ptr<WavetableData> WavetableDiskCache::read(const fs::path &cacheDir,
+                                                        const WavetableCache::Key &k)
+{
+    std::filebuf f;
+
+    if (!f.open(cacheFileFor(cacheDir, k), std::ios::binary | std::ios::in))
+    {
+        return nullptr;
+    }
+
+    wtc_header h;
+
+    if (f.sgetn(reinterpret_cast<char *>(&h), sizeof(h)) != sizeof(h) || !wtcHeaderIsCurrent(h))
+    {
+        return nullptr;
+    }
+
+    if (h.mtime != k.mtime || h.fileSize != k.fileSize || h.pathLength != k.path.size())
+    {
+        return nullptr;
+    }
+
+    std::string path(h.pathLength, '\0');
+
+    if (f.sgetn(&path[0], h.pathLength) != (std::streamsize)h.pathLength || path != k.path)
+    {
+        return nullptr;
+    }
+
+    if (!wtcShapeIsValid(h))
+    {
+        return nullptr;
+    }
+
+    auto res = std::make_shared<WavetableData>((size_t)h.samples);
+    auto bytes = (std::streamsize)(h.samples * (sizeof(float) + sizeof(short)));
+
+    // the float and int16 tables are contiguous in both the file and memory, so this is one read
+    if (f.sgetn(reinterpret_cast<char *>(res->TableF32Data), bytes) != bytes)
+    {
+        return nullptr;
+    }
+
+    res->size = h.size;
+    res->n_tables = h.n_tables;
+    res->size_po2 = h.size_po2;
+    res->flags = h.flags;
+
+    return res;
+}
+
+bool WavetableDiskCache::write(const fs::path &cacheDir, const WavetableCache::Key &k,
+                               const WavetableData &d)
+{
+    std::error_code ec;
+    fs::create_directories(cacheDir, ec);
+
+    if (ec)
+    {
+        return false;
+    }
+
+    /*
+     * The file always holds RequiredWTSize samples, which is what the reader allocates and
+     * checks for. That can be well short of the allocation, or (for a sample with appended
+     * silence, whose n_tables grows after allocation) a little past it, in which case the
+     * tail is never addressed and is written as zeros.
+     */
+    auto samples = RequiredWTSize(d.size, d.n_tables);
+    auto have = std::min(d.dataSizes, samples);
+
+    wtc_header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.tag, "swtc", 4);
+    h.version = formatVersion;
+    h.byteOrderMark = wtcByteOrderMark;
+    h.firipolI16N = FIRipolI16_N;
+    h.firoffsetI16 = FIRoffsetI16;
+    h.mtime = k.mtime;
+    h.fileSize = k.fileSize;
+    h.pathLength = (uint32_t)k.path.size();
+    h.size = d.size;
+    h.n_tables = d.n_tables;
+    h.size_po2 = d.size_po2;
+    h.flags = d.flags;
+    h.samples = samples;
+
+    /*
+     * Write to a unique temporary and rename it into place, so a concurrent reader (another
+     * instance loading the same table) sees either the old file or the whole new one.
+     */
+    static std::atomic<uint32_t> writeCount{0};
+    auto dest = cacheFileFor(cacheDir, k);
+    auto tmp = dest;
+    tmp += "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + "." +
+           std::to_string(writeCount++) + ".tmp";
+
+    {
+        std::ofstream of(tmp, std::ios::binary | std::ios::out | std::ios::trunc);
+
+        if (!of.is_open())
+        {
+            return false;
+        }
+
+        of.write(reinterpret_cast<const char *>(&h), sizeof(h));
+        of.write(k.path.data(), k.path.size());
+        // a mapped level 0 and the rest of the float tables are separate, but they're
+        // adjacent in the file
+        auto mapped = std::min(have, d.mappedF32Samples);
+        std::vector<char> zeros((samples - have) * sizeof(float));
+        of.write(reinterpret_cast<const char *>(d.mappedF32), mapped * sizeof(float));
+        of.write(reinterpret_cast<const char *>(d.TableF32Data), (have - mapped) * sizeof(float));
+        of.write(zeros.data(), (samples - have) * sizeof(float));
+        of.write(reinterpret_cast<const char *>(d.TableI16Data), have * sizeof(short));
+        of.write(zeros.data(), (samples - have) * sizeof(short));
+
+        if (!of.good())
+        {
+            of.close();
+            fs::remove(tmp, ec);
+            return false;
+        }
+    }
+
+    fs::rename(tmp, dest, ec);
+
+    if (ec)
+    {
+        fs::remove(tmp, ec);
+        return false;
+    }
+
+    return true;
+}
+
+void WavetableDiskCache::trim(const fs::path &cacheDir, uint64_t maxBytes)
+{
+    struct Entry
+    {
+        fs::path path;
+        uint64_t size;
+        fs::file_time_type written;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    std::error_code ec;
+
+    for (auto it = fs::directory_iterator(cacheDir, ec); !ec && it != fs::directory_iterator();
+         it.increment(ec))
+    {
+        auto &p = it->path();
+
+        if (p.extension() != ".wtc")
+        {
+            continue;
+        }
+
+        std::error_code fec;
+        auto size = fs::file_size(p, fec);
+        auto written = fs::last_write_time(p, fec);
+
+        if (!fec)
+        {
+            entries.push_back({p, size, written});
+            total += size;
+        }
+    }
+
+    if (total <= maxBytes)
+    {
+        return;
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry &a, const Entry &b) { return a.written < b.written; });
+
+    for (const auto &e : entries)
+    {
+        if (total <= maxBytes)
+        {
+            break;
+        }
+
+        // another instance may have it open, in which case it stays until a later trim
+        if (fs::remove(e.path, ec))
+        {
+            total -= e.size;
+        }
+    }
+}
+
+/*
+ * enqueue is called on the audio thread, so the queue is a fixed ring of slots (a bounded
+ * queue with a sequence number per slot, as there can be more than one loading thread) and
+ * the slots' strings are reserved up front. A job which doesn't fit, because the ring is full
+ * or a path is longer than that, is dropped: the table is still in memory, and the next
+ * session which loads it will get another go at caching it.
+ */
+struct WavetableDiskCacheWriter::Impl
+{
+    static constexpr size_t ringSize = 16;
+    static constexpr size_t pathCapacity = 1024;
+    static constexpr auto wakeBackstop = std::chrono::seconds(1);
+
+    struct Slot
+    {
+        std::atomic<size_t> sequence{0};
+        fs::path::string_type cacheDir;
+        WavetableCache::Key key;
+        std::shared_ptr<WavetableData> data;
+    };
+
+    std::array<Slot, ringSize> ring;
+    std::atomic<size_t> pushPosition{0};
+    size_t popPosition{0};
+
+    std::atomic<bool> pending{false};
+    std::atomic<uint64_t> pushed{0}, written{0};
+
+    std::thread thread;
+    std::mutex lock;
+    std::condition_variable queued, drained;
+    bool keepRunning{true};
+
+    Impl()
+    {
+        for (size_t i = 0; i < ringSize; ++i)
+        {
+            ring[i].sequence = i;
+            ring[i].cacheDir.reserve(pathCapacity);
+            ring[i].key.path.reserve(pathCapacity);
+        }
+
+        thread = std::thread([this]() { run(); });
+    }
+
+    bool push(const fs::path &cacheDir, const WavetableCache::Key &k,
+              const std::shared_ptr<WavetableData> &d)
+    {
+        if (cacheDir.native().size() > pathCapacity || k.path.size() > pathCapacity)
+        {
+            return false;
+        }
+
+        auto pos = pushPosition.load(std::memory_order_relaxed);
+        Slot *slot;
+
+        while (true)
+        {
+            slot = &ring[pos % ringSize];
+            auto seq = slot->sequence.load(std::memory_order_acquire);
+            auto diff = (intptr_t)seq - (intptr_t)pos;
+
+            if (diff == 0)
+            {
+                if (pushPosition.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = pushPosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->cacheDir.assign(cacheDir.native());
+        slot->key.path.assign(k.path);
+        slot->key.mtime = k.mtime;
+        slot->key.fileSize = k.fileSize;
+        slot->data = d;
+        slot->sequence.store(pos + 1, std::memory_order_release);
+
+        pushed++;
+        return true;
+    }
+
+    // only ever called from the writer thread; copies the job out so the slot frees up early
+    bool pop(fs::path &cacheDir, WavetableCache::Key &k, std::shared_ptr<WavetableData> &d)
+    {
+        auto &slot = ring[popPosition % ringSize];
+
+        if (slot.sequence.load(std::memory_order_acquire) != popPosition + 1)
+        {
+            return false;
+        }
+
+        cacheDir = slot.cacheDir;
+        k = slot.key;
+        d = std::move(slot.data);
+        slot.sequence.store(popPosition + ringSize, std::memory_order_release);
+        popPosition++;
+        return true;
+    }
+
+    void writeQueued()
+    {
+        fs::path cacheDir;
+        WavetableCache::Key k;
+        std::shared_ptr<WavetableData> d;
+
+        while (pop(cacheDir, k, d))
+        {
+            WavetableDiskCache::write(cacheDir, k, *d);
+            WavetableDiskCache::trim(cacheDir);
+            d.reset();
+
+            {
+                std::lock_guard<std::mutex> g(lock);
+                written++;
+            }
+            drained.notify_all();
+        }
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lk(lock);
+
+        while (keepRunning)
+        {
+            /*
+             * The audio thread can't take the lock to notify us, so a wake which lands
+             * between the check and the wait is missed. The timeout bounds how long that
+             * job then waits.
+             */
+            queued.wait_for(lk, wakeBackstop, [this]() { return pending || !keepRunning; });
+            pending = false;
+
+            lk.unlock();
+            writeQueued();
+            lk.lock();
+        }
+
+        // on shutdown we still finish whatever was queued
+        lk.unlock();
+        writeQueued();
+    }
+};
+
+WavetableDiskCacheWriter::WavetableDiskCacheWriter() : impl(std::make_unique<Impl>()) {}
+
+WavetableDiskCacheWriter::~WavetableDiskCacheWriter()
+{
+    {
+        std::lock_guard<std::mutex> g(impl->lock);
+        impl->keepRunning = false;
+    }
+    impl->queued.notify_all();
+    impl->thread.join();
+}
+
+void WavetableDiskCacheWriter::enqueue(const fs::path &cacheDir, const WavetableCache::Key &k,
+                                       const std::shared_ptr<WavetableData> &d)
+{
+    if (impl->push(cacheDir, k, d))
+    {
+        impl->pending = true;
+        impl->queued.notify_one();
+    }
+}
+
+void WavetableDiskCacheWriter::flush()
+{
+    auto target = impl->pushed.load();
+    impl->pending = true;
+    impl->queued.notify_one();
+
+    std::unique_lock<std::mutex> lk(impl->lock);
+    impl->drained.wait(lk, [this, target]() { return impl->written >= target; });
+}
+
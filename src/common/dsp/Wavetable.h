@@ -22,7 +22,18 @@
 #ifndef SURGE_SRC_COMMON_DSP_WAVETABLE_H
 #define SURGE_SRC_COMMON_DSP_WAVETABLE_H
 #include <string>
+#include <memory>
+#include <cstdint>
 #include <StringOps.h>
+#include "filesystem/import.h"
+
+namespace Surge
+{
+namespace Storage
+{
+class MappedFile;
+}
+} // namespace Surge
 const int max_wtable_size = 4096;
 const int max_subtables = 512;
 const int max_mipmap_levels = 16;
@@ -39,6 +50,54 @@ struct wt_header
 };
 #pragma pack(pop)
 
+/*
+ * The sample memory behind a Wavetable, along with the header values it was built with.
+ *
+ * Once BuildWT has finished writing it, it is never written again, so Wavetable::Copy (used
+ * by the clipboard and undo) and the process-wide WavetableCache share it rather than
+ * copying it. A Wavetable which gets rebuilt while its data is shared allocates fresh data
+ * (copy on write) and leaves the others alone.
+ *
+ * The float tables and the int16 tables live in one allocation, floats first, which is also
+ * the payload layout of a WavetableDiskCache file.
+ */
+struct WavetableData
+{
+    explicit WavetableData(size_t newSize, size_t newMappedF32Samples = 0);
+    ~WavetableData();
+
+    WavetableData(const WavetableData &) = delete;
+    WavetableData &operator=(const WavetableData &) = delete;
+
+    size_t dataSizes;
+    float *TableF32Data;
+    short *TableI16Data;
+
+    int size{0};
+    unsigned int n_tables{0};
+    int size_po2{0};
+    int flags{0};
+
+    // set once the data is reachable from the cache, after which it must not be written
+    bool published{false};
+
+    /*
+     * Level 0 of the float tables is laid out exactly like the sample data of a float .wt
+     * file, so for those Wavetable::BuildWTMapped points it into a mapping of the file. The
+     * first mappedF32Samples floats then live in the mapping and TableF32Data only holds
+     * what follows them (padding tables and the mip levels). f32At resolves an index into the
+     * usual layout either way.
+     */
+    std::shared_ptr<Surge::Storage::MappedFile> mapping;
+    float *mappedF32{nullptr};
+    size_t mappedF32Samples{0};
+
+    float *f32At(size_t idx) const
+    {
+        return idx < mappedF32Samples ? mappedF32 + idx : TableF32Data + (idx - mappedF32Samples);
+    }
+};
+
 class Wavetable
 {
   public:
@@ -46,10 +105,29 @@ class Wavetable
     ~Wavetable();
     void Copy(Wavetable *wt);
     bool BuildWT(void *wdata, wt_header &wh, bool AppendSilence);
+    /*
+     * Build from a mapped float .wt file whose samples start at dataOffset, referencing the
+     * mapped level 0 in place. The caller checks that the file holds a float table of a
+     * legal size and that we are on a little endian machine.
+     */
+    bool BuildWTMapped(const std::shared_ptr<Surge::Storage::MappedFile> &f, size_t dataOffset,
+                       wt_header &wh);
     void MipMapWT();
 
     void allocPointers(size_t newSize);
 
+    /*
+     * Point this wavetable at already built data, as an alternative to BuildWT.
+     */
+    void adoptData(const std::shared_ptr<WavetableData> &d);
+    const std::shared_ptr<WavetableData> &getData() const { return data; }
+
+  private:
+    void setupTablePointers();
+    void prepareTables();
+    void finishBuild(int wdata_tables);
+    std::shared_ptr<WavetableData> data;
+
   public:
     bool everBuilt = false;
     int size;
@@ -60,10 +138,6 @@ class Wavetable
     float *TableF32WeakPointers[max_mipmap_levels][max_subtables];
     short *TableI16WeakPointers[max_mipmap_levels][max_subtables];
 
-    size_t dataSizes;
-    float *TableF32Data;
-    short *TableI16Data;
-
     int current_id, queue_id;
     bool refresh_display;
     std::string queue_filename;
@@ -71,6 +145,94 @@ class Wavetable
     int frame_size_if_absent{-1};
 };
 
+/*
+ * A process-wide, refcounted cache of built wavetables, keyed by the file they were loaded
+ * from and that file's size and modification time, so the same wavetable in several
+ * oscillators (or in several plugin instances) is loaded and mipmapped once and lives in
+ * memory once. The cache only holds weak references, so an entry goes away with the last
+ * Wavetable using it.
+ */
+struct WavetableCache
+{
+    struct Key
+    {
+        std::string path;
+        int64_t mtime{0};
+        uint64_t fileSize{0};
+
+        bool operator<(const Key &o) const
+        {
+            if (path != o.path)
+                return path < o.path;
+            if (mtime != o.mtime)
+                return mtime < o.mtime;
+            return fileSize < o.fileSize;
+        }
+    };
+
+    // returns false if the file can't be stat'ed, in which case don't use the cache
+    static bool keyFor(const std::string &filename, Key &k);
+
+    static std::shared_ptr<WavetableData> find(const Key &k);
+    static void insert(const Key &k, const std::shared_ptr<WavetableData> &d);
+
+    // the number of distinct live tables; mostly for the test suite
+    static size_t liveEntries();
+};
+
+/*
+ * A persistent cache of built wavetables, so loading a wavetable we have seen before (in an
+ * earlier session) skips the conversion and mipmapping and is a single read of the finished
+ * float and int16 pyramids straight into table memory.
+ *
+ * There is one file per source path in cacheDir, named for a hash of the path. It records the
+ * full WavetableCache::Key and is only used if that still matches the source file, otherwise
+ * it is rebuilt and overwritten. The format is native endian and versioned; a file from a
+ * different version, byte order or interpolator layout is ignored.
+ *
+ * The directory is kept under maxCacheBytes by trim, which removes the oldest written files
+ * first.
+ */
+struct WavetableDiskCache
+{
+    static constexpr uint32_t formatVersion = 2;
+    static constexpr uint64_t maxCacheBytes = 256ULL * 1024 * 1024;
+
+    static fs::path cacheFileFor(const fs::path &cacheDir, const WavetableCache::Key &k);
+
+    // returns nullptr on a miss or a stale or unreadable file
+    static std::shared_ptr<WavetableData> read(const fs::path &cacheDir,
+                                               const WavetableCache::Key &k);
+    static bool write(const fs::path &cacheDir, const WavetableCache::Key &k,
+                      const WavetableData &d);
+
+    static void trim(const fs::path &cacheDir, uint64_t maxBytes = maxCacheBytes);
+};
+
+/*
+ * Writes WavetableDiskCache files on a worker thread. load_wt runs on the audio thread (from
+ * perform_queued_wtloads), where the cache lookup is fine but creating directories and
+ * writing megabytes is not, so it only queues the built (and from then on immutable) data
+ * here, without locking or allocating. The thread starts with the writer (so with the
+ * storage which owns it), trims the directory after each write, and writes anything still
+ * queued before it is joined on destruction.
+ */
+struct WavetableDiskCacheWriter
+{
+    WavetableDiskCacheWriter();
+    ~WavetableDiskCacheWriter();
+
+    void enqueue(const fs::path &cacheDir, const WavetableCache::Key &k,
+                 const std::shared_ptr<WavetableData> &d);
+
+    // blocks until everything queued so far has been written; mostly for the test suite
+    void flush();
+
+  private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
 enum wtflags
 {
     wtf_is_sample = 1,
@@ -23,24 +23,41 @@
 #include "WavetableScriptEvaluator.h"
 #include "LuaSupport.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <tuple>
+
 namespace Surge
 {
 namespace WavetableScript
 {
-std::vector<float> evaluateScriptAtFrame(const std::string &eqn, int resolution, int frame,
-                                         int nFrames)
-{
 #if HAS_LUA
-    static lua_State *L = nullptr;
-    if (L == nullptr)
-    {
-        L = lua_open();
-        luaL_openlibs(L);
-    }
-
+/*
+ * Each call parses the script afresh, so it gets a fresh environment and frames can't
+ * leak globals into each other whichever lua state they run in. The random number
+ * generator belongs to the state rather than the environment though, so we seed it here.
+ */
+static std::vector<float> evaluateScriptInState(lua_State *L, const std::string &eqn,
+                                                int resolution, int frame, int nFrames,
+                                                double seed)
+{
     auto values = std::vector<float>();
 
     auto wg = Surge::LuaSupport::SGLD("WavetableScript::evaluate", L);
+
+    lua_getglobal(L, "math");
+    lua_getfield(L, -1, "randomseed");
+    lua_pushnumber(L, seed);
+    if (lua_pcall(L, 1, 0, 0) != LUA_OK)
+    {
+        lua_pop(L, 1);
+    }
+    lua_pop(L, 1);
+
     std::string emsg;
     auto res = Surge::LuaSupport::parseStringDefiningFunction(L, eqn.c_str(), "generate", emsg);
     if (res)
@@ -93,8 +110,9 @@ std::vector<float> evaluateScriptAtFrame(const std::string &eqn, int resolution,
                     lua_pop(L, 1);
                 }
             }
-            lua_pop(L, 1);
         }
+        // either the result or the error message
+        lua_pop(L, 1);
     }
     else
     {
@@ -102,13 +120,257 @@ std::vector<float> evaluateScriptAtFrame(const std::string &eqn, int resolution,
         lua_pop(L, 1);
     }
     return values;
+}
+#endif
+
+std::vector<float> evaluateScriptAtFrame(const std::string &eqn, int resolution, int frame,
+                                         int nFrames)
+{
+#if HAS_LUA
+    static lua_State *L = nullptr;
+    if (L == nullptr)
+    {
+        L = lua_open();
+        luaL_openlibs(L);
+    }
+
+    return evaluateScriptInState(L, eqn, resolution, frame, nFrames, frame);
 #else
     return {};
 #endif
 }
 
-bool constructWavetable(const std::string &eqn, int resolution, int frames, wt_header &wh,
-                        float **wavdata)
+namespace
+{
+/*
+ * Generated tables, so regenerating a script we have already run (the same script at the
+ * same size, say from another oscillator or after an undo) is a copy. Scripts which don't
+ * draw random numbers are pure functions of their config, and those are the only ones we
+ * keep, and only a handful of them.
+ */
+struct ScriptCacheStore
+{
+    struct Key
+    {
+        size_t eqnHash;
+        int resolution, frames;
+
+        bool operator<(const Key &o) const
+        {
+            return std::tie(eqnHash, resolution, frames) <
+                   std::tie(o.eqnHash, o.resolution, o.frames);
+        }
+    };
+
+    struct Entry
+    {
+        std::string eqn;
+        std::vector<float> data;
+        uint64_t lastUse{0};
+    };
+
+    static constexpr size_t maxEntries = 16;
+
+    std::mutex m;
+    std::map<Key, Entry> entries;
+    uint64_t useCounter{0};
+};
+
+ScriptCacheStore &scriptCache()
+{
+    static ScriptCacheStore s;
+    return s;
+}
+
+bool findCachedTable(const std::string &eqn, int resolution, int frames, float *into)
+{
+    auto &c = scriptCache();
+    std::lock_guard<std::mutex> g(c.m);
+
+    auto it = c.entries.find({std::hash<std::string>{}(eqn), resolution, frames});
+    if (it == c.entries.end() || it->second.eqn != eqn)
+        return false;
+
+    it->second.lastUse = ++c.useCounter;
+    std::copy(it->second.data.begin(), it->second.data.end(), into);
+    return true;
+}
+
+// math.random is the only impure thing in the environment; be conservative about spotting it
+bool scriptIsCacheable(const std::string &eqn) { return eqn.find("random") == std::string::npos; }
+
+void insertCachedTable(const std::string &eqn, int resolution, int frames, const float *data)
+{
+    auto &c = scriptCache();
+    std::lock_guard<std::mutex> g(c.m);
+
+    if (c.entries.size() >= ScriptCacheStore::maxEntries)
+    {
+        auto oldest = std::min_element(
+            c.entries.begin(), c.entries.end(),
+            [](const auto &a, const auto &b) { return a.second.lastUse < b.second.lastUse; });
+        c.entries.erase(oldest);
+    }
+
+    auto &e = c.entries[{std::hash<std::string>{}(eqn), resolution, frames}];
+    e.eqn = eqn;
+    e.data.assign(data, data + frames * resolution);
+    e.lastUse = ++c.useCounter;
+}
+} // namespace
+
+struct GeneratorPool::Impl
+{
+    struct Job
+    {
+        const std::string &eqn;
+        int resolution, frames;
+        double seed;
+        float *into;
+        std::atomic<int> nextFrame{0};
+        std::atomic<bool> allEvaluated{true};
+    };
+
+#if HAS_LUA
+    static lua_State *newState()
+    {
+        auto L = lua_open();
+        if (L)
+            luaL_openlibs(L);
+        return L;
+    }
+
+    static void work(lua_State *L, Job &j)
+    {
+        for (int i = j.nextFrame++; i < j.frames; i = j.nextFrame++)
+        {
+            auto v = evaluateScriptInState(L, j.eqn, j.resolution, i, j.frames, j.seed + i);
+            if ((int)v.size() == j.resolution)
+                memcpy(&(j.into[i * j.resolution]), v.data(), j.resolution * sizeof(float));
+            else
+                j.allEvaluated = false;
+        }
+    }
+
+    void run()
+    {
+        auto L = newState();
+        uint64_t seen{0};
+
+        std::unique_lock<std::mutex> lk(m);
+
+        while (true)
+        {
+            wake.wait(lk, [&]() { return !keepRunning || serial != seen; });
+
+            if (!keepRunning)
+                break;
+
+            seen = serial;
+
+            // we can wake after the caller has finished the job on its own
+            if (!job || !L)
+                continue;
+
+            auto j = job;
+            busy++;
+            lk.unlock();
+            work(L, *j);
+            lk.lock();
+            busy--;
+            done.notify_all();
+        }
+
+        lk.unlock();
+
+        if (L)
+            lua_close(L);
+    }
+
+    lua_State *callerState{nullptr};
+#endif
+
+    std::mutex generating;
+    std::vector<std::thread> threads;
+    std::mutex m;
+    std::condition_variable wake, done;
+    Job *job{nullptr};
+    uint64_t serial{0};
+    int busy{0};
+    bool keepRunning{true};
+};
+
+GeneratorPool::GeneratorPool() : impl(std::make_unique<Impl>()) {}
+
+GeneratorPool::~GeneratorPool()
+{
+    {
+        std::lock_guard<std::mutex> g(impl->m);
+        impl->keepRunning = false;
+    }
+    impl->wake.notify_all();
+
+    for (auto &t : impl->threads)
+        t.join();
+
+#if HAS_LUA
+    if (impl->callerState)
+        lua_close(impl->callerState);
+#endif
+}
+
+bool GeneratorPool::generate(const std::string &eqn, int resolution, int frames, double seed,
+                             float *into)
+{
+#if HAS_LUA
+    std::lock_guard<std::mutex> g(impl->generating);
+
+    if (!impl->callerState)
+        impl->callerState = Impl::newState();
+
+    Impl::Job j{eqn, resolution, frames, seed, into};
+
+    {
+        std::lock_guard<std::mutex> lg(impl->m);
+
+        // the calling thread works too, so it's one fewer than we'd like in all
+        if (impl->threads.empty())
+        {
+            int nThreads = std::clamp((int)std::thread::hardware_concurrency(), 1, 8) - 1;
+            for (int i = 0; i < nThreads; ++i)
+                impl->threads.emplace_back([this]() { impl->run(); });
+        }
+
+        impl->job = &j;
+        impl->serial++;
+    }
+    impl->wake.notify_all();
+
+    if (impl->callerState)
+    {
+        Impl::work(impl->callerState, j);
+    }
+    else
+    {
+        // take the remaining frames off the table; they stay silent
+        j.nextFrame = frames;
+        j.allEvaluated = false;
+    }
+
+    {
+        std::unique_lock<std::mutex> lk(impl->m);
+        impl->done.wait(lk, [&]() { return impl->busy == 0; });
+        impl->job = nullptr;
+    }
+
+    return j.allEvaluated && j.nextFrame >= frames;
+#else
+    return false;
+#endif
+}
+
+bool constructWavetable(SurgeStorage *storage, const std::string &eqn, int resolution,
+                        int frames, wt_header &wh, float **wavdata)
 {
     auto wd = new float[frames * resolution];
     wh.n_samples = resolution;
@@ -116,11 +378,27 @@ bool constructWavetable(const std::string &eqn, int resolution, int frames, wt_h
     wh.flags = 0;
     *wavdata = wd;
 
-    for (int i = 0; i < frames; ++i)
-    {
-        auto v = evaluateScriptAtFrame(eqn, resolution, i, frames);
-        memcpy(&(wd[i * resolution]), &(v[0]), resolution * sizeof(float));
-    }
+    auto cacheable = scriptIsCacheable(eqn);
+
+    if (cacheable && findCachedTable(eqn, resolution, frames, wd))
+        return true;
+
+    std::fill(wd, wd + frames * resolution, 0.f);
+
+    if (!storage->wavetableScriptPool)
+        storage->wavetableScriptPool = std::make_unique<GeneratorPool>();
+
+    // frames of one generation get consecutive seeds, and each generation a fresh run of them
+    static std::atomic<uint32_t> generation{0};
+    double seed = (double)generation++ * max_subtables;
+
+    /*
+     * Frames which fail to evaluate stay silent, and we don't cache a table with such a
+     * frame in it.
+     */
+    if (storage->wavetableScriptPool->generate(eqn, resolution, frames, seed, wd) && cacheable)
+        insertCachedTable(eqn, resolution, frames, wd);
+
     return true;
 }
 std::string defaultWavetableFormula()
@@ -41,10 +41,36 @@ std::vector<float> evaluateScriptAtFrame(const std::string &eqn, int resolution,
 
 /*
  * Generate all the data required to call BuildWT. The wavdata here is data you
- * must free with delete[]
+ * must free with delete[]. Frames are evaluated in parallel on storage's
+ * GeneratorPool, and recently generated tables are cached by script and size
+ * unless the script draws random numbers.
+ *
+ * math.random is seeded per frame, from the frame index and a seed which is fresh for
+ * each generation, so a table doesn't depend on which worker ran which frame but
+ * generating again still gives new noise. evaluateScriptAtFrame seeds from the frame
+ * index alone.
+ */
+bool constructWavetable(SurgeStorage *storage, const std::string &eqn, int resolution,
+                        int frames, wt_header &wh, float **wavdata);
+
+/*
+ * The workers constructWavetable hands frames to. The threads and their lua states
+ * are started with the first generation and kept until the pool goes away with its
+ * SurgeStorage.
  */
-bool constructWavetable(const std::string &eqn, int resolution, int frames, wt_header &wh,
-                        float **wavdata);
+class GeneratorPool
+{
+  public:
+    GeneratorPool();
+    ~GeneratorPool();
+
+    // fills frames * resolution samples of into, leaving failed frames silent
+    bool generate(const std::string &eqn, int resolution, int frames, double seed, float *into);
+
+  private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
 
 std::string defaultWavetableFormula();
 
@@ -158,110 +158,16 @@ class ADSRModulationSource : public ModulationSource
 
         if (lc[mode].b)
         {
-            /*
-            ** This is the "analog" mode of the envelope. If you are unclear what it is doing
-            ** because of the SSE the algo is pretty simple; charge up and discharge a capacitor
-            ** with a gate. charge until you hit 1, discharge while the gate is open floored at
-            ** the Sustain; then release.
-            **
-            ** There is, in src/headless/UnitTests.cpp in the "Clone the Analog" section,
-            ** a non-SSE implementation of this which makes it much easier to understand.
-            */
-
             // TODO: Use this mode in XT2 (currently this is only used by VCV Rack modules)
             if (correctAnalogMode)
             {
                 doCorrectAnalogMode();
                 return;
             }
-            const float v_cc = 1.5f;
-
-            __m128 v_c1 = _mm_load_ss(&_v_c1);
-            __m128 v_c1_delayed = _mm_load_ss(&_v_c1_delayed);
-            __m128 discharge = _mm_load_ss(&_discharge);
-            const __m128 one = _mm_set_ss(1.0f); // attack->decay switch at 1 volt
-            const __m128 v_cc_vec = _mm_set_ss(v_cc);
-            bool gate = (envstate == s_attack) || (envstate == s_decay);
-            __m128 v_gate = gate ? _mm_set_ss(v_cc) : _mm_set_ss(0.f);
-            __m128 v_is_gate = _mm_cmpgt_ss(v_gate, _mm_set_ss(0.0));
-
-            // The original code here was
-            // _mm_and_ps(_mm_or_ps(_mm_cmpgt_ss(v_c1_delayed, one), discharge), v_gate);
-            // which ORed in the v_gate value as opposed to the boolean
-            discharge =
-                _mm_and_ps(_mm_or_ps(_mm_cmpgt_ss(v_c1_delayed, one), discharge), v_is_gate);
-
-            v_c1_delayed = v_c1;
-
-            float sparm = limit_range(lc[s].f, 0.f, 1.f);
-            __m128 S = _mm_load_ss(&sparm);
-            S = _mm_mul_ss(S, S);
-            __m128 v_attack = _mm_andnot_ps(discharge, v_gate);
-            __m128 v_decay =
-                _mm_or_ps(_mm_andnot_ps(discharge, v_cc_vec), _mm_and_ps(discharge, S));
-            __m128 v_release = v_gate;
-
-            __m128 diff_v_a = _mm_max_ss(_mm_setzero_ps(), _mm_sub_ss(v_attack, v_c1));
-
-            // This change from a straight min allows sustain swells
-            __m128 diff_vd_kernel = _mm_sub_ss(v_decay, v_c1);
-            __m128 diff_vd_kernel_min = _mm_min_ss(_mm_setzero_ps(), diff_vd_kernel);
-            __m128 dis_and_gate = _mm_and_ps(discharge, v_is_gate);
-            __m128 diff_v_d = _mm_or_ps(_mm_and_ps(dis_and_gate, diff_vd_kernel),
-                                        _mm_andnot_ps(dis_and_gate, diff_vd_kernel_min));
-
-            __m128 diff_v_r = _mm_min_ss(_mm_setzero_ps(), _mm_sub_ss(v_release, v_c1));
-
-            // calculate coefficients for envelope
-            const float shortest = 6.f;
-            const float longest = -2.f;
-            const float coeff_offset = 2.f - log(storage->samplerate / BLOCK_SIZE) / log(2.f);
-
-            float coef_A =
-                powf(2.f, std::min(0.f, coeff_offset - lc[a].f * (adsr->a.temposync
-                                                                      ? storage->temposyncratio
-                                                                      : 1.f)));
-            float coef_D =
-                powf(2.f, std::min(0.f, coeff_offset - lc[d].f * (adsr->d.temposync
-                                                                      ? storage->temposyncratio
-                                                                      : 1.f)));
-            float coef_R =
-                envstate == s_uberrelease
-                    ? 6.f
-                    : powf(2.f,
-                           std::min(0.f, coeff_offset - lc[r].f * (adsr->r.temposync
-                                                                       ? storage->temposyncratio
-                                                                       : 1.f)));
-
-            v_c1 = _mm_add_ss(v_c1, _mm_mul_ss(diff_v_a, _mm_load_ss(&coef_A)));
-            v_c1 = _mm_add_ss(v_c1, _mm_mul_ss(diff_v_d, _mm_load_ss(&coef_D)));
-            v_c1 = _mm_add_ss(v_c1, _mm_mul_ss(diff_v_r, _mm_load_ss(&coef_R)));
-
-            _mm_store_ss(&_v_c1, v_c1);
-            _mm_store_ss(&_v_c1_delayed, v_c1_delayed);
-            _mm_store_ss(&_discharge, discharge);
-
-            _mm_store_ss(&output, v_c1);
-            if (gate)
-            {
-                _ungateHold = output;
-            }
-            else
-            {
-                if (r_gated)
-                {
-                    output = _ungateHold;
-                }
-            }
 
-            const float SILENCE_THRESHOLD = 1e-6;
-
-            if (!gate && _discharge == 0.f && _v_c1 < SILENCE_THRESHOLD)
-            {
-                envstate = s_idle;
-                output = 0;
-                idlecount++;
-            }
+            // the analog mode is in processAnalogQuad, as a quad of one
+            ADSRModulationSource *self = this;
+            processAnalogQuad(&self, 1);
         }
         else
         {
@@ -406,22 +312,38 @@ class ADSRModulationSource : public ModulationSource
         }
     }
 
-    void doCorrectAnalogMode()
+    /*
+     * Steps the envelopes of up to four voices at once. Those in analog mode share one pass,
+     * each in a lane of the SSE registers, and the rest step on their own. The result is the
+     * same as calling process_block on each.
+     */
+    static void process_block_quad(ADSRModulationSource *const *env, int n)
     {
-        const float coeff_offset = 2.f - log(storage->samplerate / BLOCK_SIZE) / log(2.f);
+        ADSRModulationSource *analog[4];
+        int nAnalog = 0;
 
-        float coef_A = powf(
-            2.f, std::min(0.f, coeff_offset -
-                                   lc[a].f * (adsr->a.temposync ? storage->temposyncratio : 1.f)));
-        float coef_D = powf(
-            2.f, std::min(0.f, coeff_offset -
-                                   lc[d].f * (adsr->d.temposync ? storage->temposyncratio : 1.f)));
-        float coef_R =
-            envstate == s_uberrelease
-                ? 6.f
-                : powf(2.f, std::min(0.f, coeff_offset - lc[r].f * (adsr->r.temposync
-                                                                        ? storage->temposyncratio
-                                                                        : 1.f)));
+        for (int i = 0; i < n; ++i)
+        {
+            if (env[i]->lc[env[i]->mode].b && !env[i]->correctAnalogMode)
+            {
+                analog[nAnalog++] = env[i];
+            }
+            else
+            {
+                env[i]->process_block();
+            }
+        }
+
+        if (nAnalog)
+        {
+            processAnalogQuad(analog, nAnalog);
+        }
+    }
+
+    void doCorrectAnalogMode()
+    {
+        float coef_A, coef_D, coef_R;
+        analogCoefficients(coef_A, coef_D, coef_R);
 
         const float v_cc = 1.01f;
         auto gate = (envstate == s_attack) || (envstate == s_decay);
@@ -460,6 +382,129 @@ class ADSRModulationSource : public ModulationSource
     int getEnvState() { return envstate; }
 
   private:
+    void analogCoefficients(float &coef_A, float &coef_D, float &coef_R)
+    {
+        const float coeff_offset = 2.f - log(storage->samplerate / BLOCK_SIZE) / log(2.f);
+
+        coef_A = powf(
+            2.f, std::min(0.f, coeff_offset -
+                                   lc[a].f * (adsr->a.temposync ? storage->temposyncratio : 1.f)));
+        coef_D = powf(
+            2.f, std::min(0.f, coeff_offset -
+                                   lc[d].f * (adsr->d.temposync ? storage->temposyncratio : 1.f)));
+        coef_R =
+            envstate == s_uberrelease
+                ? 6.f
+                : powf(2.f, std::min(0.f, coeff_offset - lc[r].f * (adsr->r.temposync
+                                                                        ? storage->temposyncratio
+                                                                        : 1.f)));
+    }
+
+    /*
+    ** This is the "analog" mode of the envelope. If you are unclear what it is doing
+    ** because of the SSE the algo is pretty simple; charge up and discharge a capacitor
+    ** with a gate. charge until you hit 1, discharge while the gate is open floored at
+    ** the Sustain; then release.
+    **
+    ** There is, in src/headless/UnitTests.cpp in the "Clone the Analog" section,
+    ** a non-SSE implementation of this which makes it much easier to understand.
+    **
+    ** Each of the (up to four) envelopes gets a lane. Lanes past n run on zeros and are
+    ** thrown away.
+    */
+    static void processAnalogQuad(ADSRModulationSource *const *env, int n)
+    {
+        const float v_cc = 1.5f;
+
+        float l_v_c1 alignas(16)[4]{}, l_v_c1_delayed alignas(16)[4]{},
+            l_discharge alignas(16)[4]{}, l_gate alignas(16)[4]{}, l_S alignas(16)[4]{},
+            l_coef_A alignas(16)[4]{}, l_coef_D alignas(16)[4]{}, l_coef_R alignas(16)[4]{};
+
+        for (int i = 0; i < n; ++i)
+        {
+            auto *e = env[i];
+
+            l_v_c1[i] = e->_v_c1;
+            l_v_c1_delayed[i] = e->_v_c1_delayed;
+            l_discharge[i] = e->_discharge;
+            l_gate[i] = (e->envstate == s_attack) || (e->envstate == s_decay) ? v_cc : 0.f;
+            l_S[i] = limit_range(e->lc[e->s].f, 0.f, 1.f);
+            e->analogCoefficients(l_coef_A[i], l_coef_D[i], l_coef_R[i]);
+        }
+
+        __m128 v_c1 = _mm_load_ps(l_v_c1);
+        __m128 v_c1_delayed = _mm_load_ps(l_v_c1_delayed);
+        __m128 discharge = _mm_load_ps(l_discharge);
+        const __m128 one = _mm_set1_ps(1.0f); // attack->decay switch at 1 volt
+        const __m128 v_cc_vec = _mm_set1_ps(v_cc);
+        __m128 v_gate = _mm_load_ps(l_gate);
+        __m128 v_is_gate = _mm_cmpgt_ps(v_gate, _mm_setzero_ps());
+
+        // The original code here was
+        // _mm_and_ps(_mm_or_ps(_mm_cmpgt_ss(v_c1_delayed, one), discharge), v_gate);
+        // which ORed in the v_gate value as opposed to the boolean
+        discharge = _mm_and_ps(_mm_or_ps(_mm_cmpgt_ps(v_c1_delayed, one), discharge), v_is_gate);
+
+        v_c1_delayed = v_c1;
+
+        __m128 S = _mm_load_ps(l_S);
+        S = _mm_mul_ps(S, S);
+        __m128 v_attack = _mm_andnot_ps(discharge, v_gate);
+        __m128 v_decay = _mm_or_ps(_mm_andnot_ps(discharge, v_cc_vec), _mm_and_ps(discharge, S));
+        __m128 v_release = v_gate;
+
+        __m128 diff_v_a = _mm_max_ps(_mm_setzero_ps(), _mm_sub_ps(v_attack, v_c1));
+
+        // This change from a straight min allows sustain swells
+        __m128 diff_vd_kernel = _mm_sub_ps(v_decay, v_c1);
+        __m128 diff_vd_kernel_min = _mm_min_ps(_mm_setzero_ps(), diff_vd_kernel);
+        __m128 dis_and_gate = _mm_and_ps(discharge, v_is_gate);
+        __m128 diff_v_d = _mm_or_ps(_mm_and_ps(dis_and_gate, diff_vd_kernel),
+                                    _mm_andnot_ps(dis_and_gate, diff_vd_kernel_min));
+
+        __m128 diff_v_r = _mm_min_ps(_mm_setzero_ps(), _mm_sub_ps(v_release, v_c1));
+
+        v_c1 = _mm_add_ps(v_c1, _mm_mul_ps(diff_v_a, _mm_load_ps(l_coef_A)));
+        v_c1 = _mm_add_ps(v_c1, _mm_mul_ps(diff_v_d, _mm_load_ps(l_coef_D)));
+        v_c1 = _mm_add_ps(v_c1, _mm_mul_ps(diff_v_r, _mm_load_ps(l_coef_R)));
+
+        _mm_store_ps(l_v_c1, v_c1);
+        _mm_store_ps(l_v_c1_delayed, v_c1_delayed);
+        _mm_store_ps(l_discharge, discharge);
+
+        const float SILENCE_THRESHOLD = 1e-6;
+
+        for (int i = 0; i < n; ++i)
+        {
+            auto *e = env[i];
+            bool gate = l_gate[i] > 0.f;
+
+            e->_v_c1 = l_v_c1[i];
+            e->_v_c1_delayed = l_v_c1_delayed[i];
+            e->_discharge = l_discharge[i];
+
+            e->output = e->_v_c1;
+            if (gate)
+            {
+                e->_ungateHold = e->output;
+            }
+            else
+            {
+                if (e->adsr->r.deform_type)
+                {
+                    e->output = e->_ungateHold;
+                }
+            }
+
+            if (!gate && e->_discharge == 0.f && e->_v_c1 < SILENCE_THRESHOLD)
+            {
+                e->envstate = s_idle;
+                e->output = 0;
+                e->idlecount++;
+            }
+        }
+    }
+
     ADSRStorage *adsr = nullptr;
     SurgeVoiceState *state = nullptr;
     SurgeStorage *storage = nullptr;
@@ -26,6 +26,11 @@
 #include "SurgeStorage.h"
 #include <thread>
 #include <functional>
+#include <algorithm>
+#include <limits>
+#include <cctype>
+#include <cstring>
+#include <string_view>
 #include "fmt/core.h"
 
 namespace Surge
@@ -33,12 +38,738 @@ namespace Surge
 namespace Formula
 {
 
-void setupStorage(SurgeStorage *s) { s->formulaGlobalData = std::make_unique<GlobalData>(); }
+// every voice LFO of every voice, which is as many states as can finish before any restart
+static constexpr size_t maxPooledStates = n_scenes * MAX_VOICES * n_lfos_voice;
+
+void setupStorage(SurgeStorage *s)
+{
+    s->formulaGlobalData = std::make_unique<GlobalData>();
+    s->formulaGlobalData->statePool.reserve(maxPooledStates);
+}
+
+#if HAS_LUA
+/*
+ * The body of surge_reserved_formula_bind, which takes a pointer to an EvaluatorIO and returns
+ * the trampoline valueAt calls as trampoline(process, state, justSetup). It does to the state
+ * table exactly what valueAt does through the Lua API when there is no trampoline, in the same
+ * order, and then reads the results into the struct. Anything out of the ordinary in the
+ * results (resultKind 2 or 3) is left to valueAt, which handles it as it always has.
+ */
+static std::string formulaIOBindingSource()
+{
+    return fmt::format(R"FN(
+local ffi = require("ffi")
+
+ffi.cdef[[
+typedef struct
+{{
+    double phase;
+    int32_t intphase;
+    double del, dec, a, h, s, r;
+    double rate, amp, startphase, deform;
+    double tempo, songpos;
+    bool released, isVoice;
+    double key, velocity, channel;
+    bool subAnyMacro, subMacros[{0}];
+    double macros[{0}];
+
+    int32_t resultKind;
+    int32_t activeOutputs;
+    bool useEnvelope, retriggerAEG, retriggerFEG, clampOutput;
+    double output[{1}];
+}} surge_formula_io;
+]]
+
+local function flag(v, default)
+    if type(v) == "boolean" then
+        return v
+    end
+    return default
+end
+
+function surge_reserved_formula_bind(p)
+    local io = ffi.cast("surge_formula_io *", p)
+    local macros = {{}}
+
+    return function(f, state, justSetup)
+        state.intphase = io.intphase
+        state.cycle = io.intphase
+        state.phase = io.phase
+        state.delay = io.del
+        state.decay = io.dec
+        state.attack = io.a
+        state.hold = io.h
+        state.sustain = io.s
+        state.release = io.r
+        state.rate = io.rate
+        state.amplitude = io.amp
+        state.startphase = io.startphase
+        state.deform = io.deform
+        state.tempo = io.tempo
+        state.songpos = io.songpos
+        state.released = io.released
+
+        if io.isVoice then
+            state.is_voice = true
+            state.key = io.key
+            state.velocity = io.velocity
+            state.channel = io.channel
+            state.released = io.released
+        else
+            state.is_voice = false
+        end
+
+        state.retrigger_AEG = nil
+        state.retrigger_FEG = nil
+
+        if io.subAnyMacro then
+            for i = 1, {0} do
+                if io.subMacros[i - 1] then
+                    macros[i] = io.macros[i - 1]
+                end
+            end
+            state.macros = macros
+        end
+
+        if justSetup then
+            return nil
+        end
+
+        io.resultKind = 3
+        local res = f(state)
+
+        if type(res) == "number" then
+            io.output[0] = res
+            io.resultKind = 0
+            return res
+        end
+
+        if type(res) ~= "table" then
+            return res
+        end
+
+        local kind = 1
+        local out = res.output
+
+        if type(out) == "number" then
+            io.output[0] = out
+            io.activeOutputs = 1
+        elseif type(out) == "table" then
+            local len = 1
+            for k, v in pairs(out) do
+                if type(k) ~= "number" or type(v) ~= "number" or k < 1 or k > {1} or k % 1 ~= 0 then
+                    kind = 2
+                    break
+                end
+                io.output[k - 1] = v
+                if k > len then
+                    len = k
+                end
+            end
+            io.activeOutputs = len
+        else
+            kind = 2
+        end
+
+        io.useEnvelope = flag(res.use_envelope, true)
+        io.retriggerAEG = flag(res.retrigger_AEG, false)
+        io.retriggerFEG = flag(res.retrigger_FEG, false)
+        io.clampOutput = flag(res.clamp_output, true)
+        io.resultKind = kind
+
+        return res
+    end
+end
+
+--[[
+ For prepareForEvaluation, which hands a starting voice the state table of one which has
+ finished. This empties it in place and gives it subscriptions, as if it had just been made.
+]]
+local function clear(t)
+    setmetatable(t, nil)
+    for k in next, t do
+        rawset(t, k, nil)
+    end
+end
+
+function surge_reserved_formula_reset_state(t)
+    local subs = rawget(t, "subscriptions")
+    local macros = type(subs) == "table" and rawget(subs, "macros") or nil
+
+    if type(subs) ~= "table" or subs == t then
+        subs = {{}}
+    end
+    if type(macros) ~= "table" or macros == t or macros == subs then
+        macros = {{}}
+    end
+
+    clear(t)
+    clear(subs)
+    clear(macros)
+
+    for i = 1, {0} do
+        macros[i] = false
+    end
+    subs.macros = macros
+    t.subscriptions = subs
+
+    return t
+end
+)FN",
+                       n_customcontrollers, max_formula_outputs);
+}
+
+static void unbindIO(EvaluatorState &s)
+{
+    // a copy of a bound state shares the reference, and mustn't release it
+    if (s.L && s.ioRef && s.ioBoundTo == &s.io)
+    {
+        luaL_unref(s.L, LUA_REGISTRYINDEX, s.ioRef);
+    }
+
+    s.ioRef = 0;
+    s.ioBoundTo = nullptr;
+}
+
+static void bindIO(EvaluatorState &s)
+{
+    // a trampoline from the pool which was bound to this very io already will do
+    if (s.ioRef && s.ioBoundTo == &s.io)
+    {
+        return;
+    }
+
+    auto g = Surge::LuaSupport::SGLD("bindIO", s.L);
+
+    unbindIO(s);
+
+    lua_getglobal(s.L, "surge_reserved_formula_bind");
+    if (!lua_isfunction(s.L, -1))
+    {
+        // no FFI, so valueAt sticks to the Lua API
+        lua_pop(s.L, 1);
+        return;
+    }
+
+    lua_pushlightuserdata(s.L, &s.io);
+    if (lua_pcall(s.L, 1, 1, 0) == LUA_OK && lua_isfunction(s.L, -1))
+    {
+        s.ioRef = luaL_ref(s.L, LUA_REGISTRYINDEX);
+        s.ioBoundTo = &s.io;
+    }
+    else
+    {
+        lua_pop(s.L, 1);
+    }
+}
+
+/*
+ * Lets go of the state table and trampoline of s. Those of an audio thread voice go to the pool,
+ * if it has room, and otherwise the table goes to the collector.
+ */
+static void releaseState(EvaluatorState &s)
+{
+    auto *gd = s.pool;
+    bool own = s.ioRef && s.ioBoundTo == &s.io; // a copy mustn't pool what the original uses
+
+    if (gd && s.L && s.L == gd->audioState && s.stateName[0] != 0 && own &&
+        gd->statePool.size() < gd->statePool.capacity())
+    {
+        GlobalData::PooledState p;
+        memcpy(p.stateName, s.stateName, TXT_SIZE);
+        p.ioRef = s.ioRef;
+        p.ioBoundTo = s.ioBoundTo;
+        gd->statePool.push_back(p);
+
+        s.stateName[0] = 0;
+        s.ioRef = 0;
+        s.ioBoundTo = nullptr;
+        return;
+    }
+
+    unbindIO(s);
+
+    if (s.L && s.stateName[0] != 0)
+    {
+        lua_pushnil(s.L);
+        lua_setglobal(s.L, s.stateName);
+        s.stateName[0] = 0;
+    }
+}
+
+/*
+ * Gives s a state name, and with it a table and trampoline, from the pool, preferring those s
+ * had itself, since that trampoline is bound to its io already. Returns false if the pool is
+ * empty.
+ */
+static bool acquirePooledState(GlobalData &gd, EvaluatorState &s)
+{
+    auto &pool = gd.statePool;
+
+    if (pool.empty())
+    {
+        return false;
+    }
+
+    auto it = pool.end() - 1;
+    for (auto q = pool.begin(); q != pool.end(); ++q)
+    {
+        if (q->ioBoundTo == &s.io)
+        {
+            it = q;
+            break;
+        }
+    }
+
+    memcpy(s.stateName, it->stateName, TXT_SIZE);
+
+    if (it->ioBoundTo == &s.io)
+    {
+        s.ioRef = it->ioRef;
+        s.ioBoundTo = &s.io;
+    }
+    else
+    {
+        luaL_unref(s.L, LUA_REGISTRYINDEX, it->ioRef);
+    }
+
+    *it = pool.back();
+    pool.pop_back();
+
+    return true;
+}
+
+/*
+ * With the init function on the top of the stack, push the state table of a pooled state name
+ * emptied for reuse. If that can't be done the stack is left as it was and this returns false.
+ */
+static bool pushResetStateTable(EvaluatorState &s)
+{
+    lua_getglobal(s.L, "surge_reserved_formula_reset_state");
+    lua_getglobal(s.L, s.stateName);
+
+    if (!lua_isfunction(s.L, -2) || !lua_istable(s.L, -1))
+    {
+        lua_pop(s.L, 2);
+        return false;
+    }
+
+    if (lua_pcall(s.L, 1, 1, 0) != LUA_OK || !lua_istable(s.L, -1))
+    {
+        lua_pop(s.L, 1);
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Neither hooks nor signals reach JIT compiled code, so formulas check their budget themselves.
+ * withBudgetChecks gives each loop body and function body, and each goto, a check which counts
+ * down the state's EvaluationBudget::left and only calls budgetCheck to look at the clock once
+ * that runs out. Unarmed, left stays so high that it never does.
+ */
+static constexpr int32_t budgetCheckInterval = 256;
+static constexpr int32_t budgetUnarmed = std::numeric_limits<int32_t>::max();
+
+// what a check stops an evaluation with, raised without a location so it can be recognized
+static constexpr const char *budgetErrorMessage = "surge_reserved_formula_over_budget";
+
+static constexpr const char *budgetOverrunMessage =
+    "The formula kept running over its time budget and has been switched off. Check it for long "
+    "or endless loops, then apply it again to switch it back on.";
+
+// init runs once for a voice and usually does more than process, so it gets this many budgets
+static constexpr int initBudgets = 16;
+
+// see OverrunRecord
+static constexpr int overrunsBeforeSwitchingOff = 8;
+
+// called through the FFI, so it mustn't raise a Lua error itself; surge_reserved_budget_stop does
+static bool budgetCheck(void *p)
+{
+    auto *b = (EvaluationBudget *)p;
+
+    if (!b->armed)
+    {
+        b->left = budgetUnarmed;
+        return false;
+    }
+
+    if (!b->tripped)
+    {
+        b->left = budgetCheckInterval;
+        b->tripped = std::chrono::steady_clock::now() - b->start > b->allowed;
+    }
+
+    return b->tripped;
+}
+
+/*
+ * The body of surge_reserved_budget_bind, which points the globals the checks in a formula use
+ * at a budget. They are copied into locals of the formula's chunk when it is parsed, so that the
+ * sandboxed process and init functions see them too.
+ */
+static std::string budgetBindingSource()
+{
+    return fmt::format(R"FN(
+local hasFFI, ffi = pcall(require, "ffi")
+
+function surge_reserved_budget_bind(check, budget, left)
+    surge_reserved_budget = budget
+
+    if hasFFI then
+        surge_reserved_budget_check = ffi.cast("bool (*)(void *)", check)
+        surge_reserved_budget_left = ffi.cast("int32_t *", left)
+    else
+        -- then nothing can stop a formula, but the checks still have to run
+        surge_reserved_budget_check = function() return false end
+        surge_reserved_budget_left = {{ [0] = math.huge }}
+    end
+end
+
+function surge_reserved_budget_stop()
+    error("{0}", 0)
+end
+)FN",
+                       budgetErrorMessage);
+}
+
+static void installBudgetChecks(lua_State *L, EvaluationBudget *b)
+{
+    std::string emsg;
+
+    if (!Surge::LuaSupport::parseStringDefiningFunction(L, budgetBindingSource(),
+                                                        "surge_reserved_budget_bind", emsg))
+    {
+        lua_pop(L, 1);
+        return;
+    }
+
+    lua_pushlightuserdata(L, (void *)&budgetCheck);
+    lua_pushlightuserdata(L, b);
+    lua_pushlightuserdata(L, &b->left);
+
+    if (lua_pcall(L, 3, 0, 0) != LUA_OK)
+    {
+        lua_pop(L, 1);
+    }
+}
+
+/*
+ * The formula with a budget check at the start of each loop body and function body and before
+ * each goto, which between them every long running formula has to pass through. The checks go
+ * on the lines they belong to, so the line numbers of errors don't move.
+ */
+static std::string withBudgetChecks(const std::string &formula)
+{
+    static constexpr const char *prefix =
+        "local surge_reserved_budget_check, surge_reserved_budget, surge_reserved_budget_left, "
+        "surge_reserved_budget_stop = surge_reserved_budget_check, surge_reserved_budget, "
+        "surge_reserved_budget_left, surge_reserved_budget_stop; ";
+    static constexpr const char *check =
+        " surge_reserved_budget_left[0] = surge_reserved_budget_left[0] - 1 if "
+        "surge_reserved_budget_left[0] < 0 and surge_reserved_budget_check(surge_reserved_budget) "
+        "then surge_reserved_budget_stop() end ";
+
+    auto n = formula.size();
+    auto at = [&](size_t i) -> unsigned char { return i < n ? formula[i] : 0; };
+    auto isName = [](unsigned char c) { return std::isalnum(c) || c == '_'; };
+
+    // the level of a long bracket, [[ or [=[ and so on, opening at i, or -1 if there is none
+    auto longBracketLevel = [&](size_t i) {
+        if (at(i) != '[')
+            return -1;
+
+        int level = 0;
+
+        while (at(i + 1 + level) == '=')
+            level++;
+
+        return at(i + 1 + level) == '[' ? level : -1;
+    };
+
+    auto skipLongBracket = [&](size_t i, int level) {
+        auto close = "]" + std::string(level, '=') + "]";
+        auto end = formula.find(close, i + level + 2);
+        return end == std::string::npos ? n : end + close.size();
+    };
+
+    std::string res = prefix;
+    res.reserve(res.size() + n + 1024);
+
+    size_t i = 0, copied = 0;
+    bool inFunctionName = false, inParameters = false;
+
+    auto checkAt = [&](size_t pos) {
+        res.append(formula, copied, pos - copied);
+        res += check;
+        copied = pos;
+    };
+
+    while (i < n)
+    {
+        auto c = at(i);
+
+        if (c == '-' && at(i + 1) == '-')
+        {
+            i += 2;
+            auto level = longBracketLevel(i);
+
+            if (level >= 0)
+            {
+                i = skipLongBracket(i, level);
+            }
+            else
+            {
+                while (i < n && formula[i] != '\n')
+                    i++;
+            }
+        }
+        else if (c == '"' || c == '\'')
+        {
+            for (i++; i < n && formula[i] != c && formula[i] != '\n'; i++)
+            {
+                if (formula[i] == '\\')
+                    i++;
+            }
+
+            i++;
+        }
+        else if (longBracketLevel(i) >= 0)
+        {
+            i = skipLongBracket(i, longBracketLevel(i));
+        }
+        else if (std::isdigit(c) || (c == '.' && std::isdigit(at(i + 1))))
+        {
+            // numbers can have letters in them, 0x1f or 1e5, which mustn't be read as names
+            for (i++; i < n; i++)
+            {
+                auto d = at(i);
+                bool exponentSign = (d == '+' || d == '-') && std::strchr("eEpP", at(i - 1));
+
+                if (!isName(d) && d != '.' && !exponentSign)
+                    break;
+            }
+        }
+        else if (std::isalpha(c) || c == '_')
+        {
+            auto start = i;
+
+            while (isName(at(i)))
+                i++;
+
+            auto word = std::string_view(formula).substr(start, i - start);
+
+            if (word == "do" || word == "repeat")
+            {
+                checkAt(i);
+            }
+            else if (word == "goto")
+            {
+                // not after a label, since a label ending a block must stay last in it
+                checkAt(start);
+            }
+            else if (word == "function")
+            {
+                inFunctionName = true;
+            }
+        }
+        else
+        {
+            if (c == '(' && inFunctionName)
+            {
+                inFunctionName = false;
+                inParameters = true;
+            }
+            else if (c == ')' && inParameters)
+            {
+                inParameters = false;
+                checkAt(i + 1);
+            }
+
+            i++;
+        }
+    }
+
+    res.append(formula, copied, std::string::npos);
+    return res;
+}
+
+// whether the error on top of the stack is the one surge_reserved_budget_stop raises
+static bool isBudgetError(lua_State *L)
+{
+    auto *e = lua_tostring(L, -1);
+    return e && strcmp(e, budgetErrorMessage) == 0;
+}
+
+/*
+ * Arms the budget of the state of s around one protected call. Only the pcall itself may run
+ * armed, since the checks' error has to land in it. An init call gets a budget of its own rather
+ * than spending the block's.
+ */
+struct EvaluationBudgetScope
+{
+    EvaluationBudgetScope(SurgeStorage *storage, EvaluatorState *s, bool isInit = false)
+        : storage(storage), isInit(isInit)
+    {
+        auto &stateData = *storage->formulaGlobalData;
+        isDisplay = s->L == stateData.displayState;
+        b = isDisplay ? &stateData.displayBudget : &stateData.audioBudget;
+    }
+    ~EvaluationBudgetScope() { disarm(); }
+
+    void disarm()
+    {
+        b->armed = false;
+        b->left = budgetUnarmed;
+    }
+
+    // Call straight before the pcall
+    void arm()
+    {
+        auto blocks = storage->formulaTimeBudgetInBlocks;
+
+        if (blocks <= 0)
+        {
+            return;
+        }
+
+        limit = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(blocks * BLOCK_SIZE * storage->dsamplerate_inv));
+
+        if (isDisplay)
+        {
+            b->period++;
+            b->spent = {};
+        }
+
+        if (isInit)
+        {
+            limit *= initBudgets;
+        }
+
+        b->allowed = isInit ? limit : limit - b->spent;
+        b->tripped = false;
+        b->left = budgetCheckInterval;
+        b->start = std::chrono::steady_clock::now();
+        b->armed = true;
+        checked = true;
+    }
+
+    /*
+     * Call straight after the pcall. Disarms the budget and returns whether the call ran over
+     * it, be that stopped by a check in the formula (see tripped) or only seen now.
+     */
+    bool finish()
+    {
+        disarm();
+
+        if (!checked)
+        {
+            return false;
+        }
+
+        auto took = std::chrono::steady_clock::now() - b->start;
+
+        if (isInit)
+        {
+            return took > limit;
+        }
+
+        b->spent += took;
+        return b->spent > limit;
+    }
+
+    // whether a check stopped the call, in which case the pcall returned budgetErrorMessage
+    bool tripped() const { return checked && b->tripped; }
+
+    SurgeStorage *storage;
+    EvaluationBudget *b;
+    std::chrono::steady_clock::duration limit{};
+    bool isInit, isDisplay, checked{false};
+};
+
+/*
+ * Counts a period in which the formula s runs went over its budget, and once that has happened
+ * too often (see OverrunRecord), switches the formula off for s and for the voices which start
+ * it later, and reports it. Returns whether the formula is off.
+ */
+static bool noteOverrun(SurgeStorage *storage, FormulaModulatorStorage *fs, EvaluatorState *s,
+                        EvaluationBudget &b)
+{
+    OverrunRecord *rec = nullptr;
+
+    for (auto &o : b.overruns)
+    {
+        if (o.isFor(fs))
+        {
+            rec = &o;
+            break;
+        }
+    }
+
+    if (!rec)
+    {
+        // reuse the record which has gone longest without an overrun, and rather one which isn't
+        // holding a formula off
+        for (auto &o : b.overruns)
+        {
+            if (!rec || (rec->switchedOff && !o.switchedOff) ||
+                (rec->switchedOff == o.switchedOff && o.windowStart < rec->windowStart))
+            {
+                rec = &o;
+            }
+        }
+
+        *rec = OverrunRecord{};
+        rec->fs = fs;
+        rec->generation = fs->generation;
+        rec->formulaHash = fs->formulaHash;
+    }
+
+    auto &r = *rec;
+    auto now = std::chrono::steady_clock::now();
+
+    if (!r.switchedOff)
+    {
+        if (now - r.windowStart > std::chrono::seconds(1))
+        {
+            r.count = 0;
+            r.windowStart = now;
+        }
+
+        if (r.count == 0 || r.lastPeriod != b.period)
+        {
+            r.count++;
+            r.lastPeriod = b.period;
+        }
+
+        if (r.count < overrunsBeforeSwitchingOff)
+        {
+            return false;
+        }
+
+        r.switchedOff = true;
+        s->adderror(budgetOverrunMessage);
+    }
+
+    s->isvalid = false;
+    return true;
+}
+#endif
+
 bool prepareForEvaluation(SurgeStorage *storage, FormulaModulatorStorage *fs, EvaluatorState &s,
                           bool is_display)
 {
     auto &stateData = *storage->formulaGlobalData;
     bool firstTimeThrough = false;
+
+#if HAS_LUA
+    releaseState(s);
+#endif
+    bool pooled = false;
+
     if (!is_display)
     {
         static int aid = 1;
@@ -47,14 +778,24 @@ bool prepareForEvaluation(SurgeStorage *storage, FormulaModulatorStorage *fs, Ev
 #if HAS_LUA
             stateData.audioState = lua_open();
             luaL_openlibs((lua_State *)(stateData.audioState));
+
+            // stepGarbageCollection collects, a bounded amount each block
+            lua_gc((lua_State *)(stateData.audioState), LUA_GCSTOP, 0);
 #endif
             firstTimeThrough = true;
         }
         s.L = (lua_State *)(stateData.audioState);
-        snprintf(s.stateName, TXT_SIZE, "audiostate_%d", aid);
-        aid++;
-        if (aid < 0)
-            aid = 1;
+        s.pool = &stateData;
+#if HAS_LUA
+        pooled = acquirePooledState(stateData, s);
+#endif
+        if (!pooled)
+        {
+            snprintf(s.stateName, TXT_SIZE, "audiostate_%d", aid);
+            aid++;
+            if (aid < 0)
+                aid = 1;
+        }
     }
     else
     {
@@ -93,6 +834,20 @@ end
         {
             lua_setglobal(s.L, "surge_reserved_formula_error_stub");
         }
+
+        installBudgetChecks(s.L, is_display ? &stateData.displayBudget : &stateData.audioBudget);
+
+        std::string bmsg;
+        bool r1 = Surge::LuaSupport::parseStringDefiningFunction(
+            s.L, formulaIOBindingSource(), "surge_reserved_formula_bind", bmsg);
+        if (r1)
+        {
+            lua_setglobal(s.L, "surge_reserved_formula_bind");
+        }
+        else
+        {
+            lua_pop(s.L, 1);
+        }
     }
 
     // OK so now evaluate the formula. This is a mistake - the loading and
@@ -134,12 +889,31 @@ end
         {
             s.isvalid = false;
         }
+
+        auto &budget = (s.L == stateData.displayState) ? stateData.displayBudget
+                                                       : stateData.audioBudget;
+
+        for (auto &r : budget.overruns)
+        {
+            if (r.fs == fs && r.switchedOff)
+            {
+                // setting the formula again, even to the same text, gives it another go
+                if (r.isFor(fs))
+                {
+                    s.isvalid = false;
+                }
+                else
+                {
+                    r = OverrunRecord{};
+                }
+            }
+        }
     }
     else
     {
         std::string emsg;
         int res = Surge::LuaSupport::parseStringDefiningMultipleFunctions(
-            s.L, fs->formulaString, {"process", "init"}, emsg);
+            s.L, withBudgetChecks(fs->formulaString), {"process", "init"}, emsg);
 
         if (res >= 1)
         {
@@ -182,24 +956,28 @@ end
 
     if (s.isvalid)
     {
-        // Create my state object each time
+        // Create my state object each time, unless the pool gave me one to reset
         lua_getglobal(s.L, s.funcNameInit);
-        lua_createtable(s.L, 0, 10);
 
-        // add subscription hooks
-        lua_pushstring(s.L, "subscriptions");
-        lua_createtable(s.L, 0, 5);
-        lua_pushstring(s.L, "macros");
-        lua_createtable(s.L, n_customcontrollers, 0);
-        for (int i = 0; i < n_customcontrollers; ++i)
+        if (!pooled || !pushResetStateTable(s))
         {
-            lua_pushnumber(s.L, i + 1);
-            lua_pushboolean(s.L, false);
+            lua_createtable(s.L, 0, 10);
+
+            // add subscription hooks
+            lua_pushstring(s.L, "subscriptions");
+            lua_createtable(s.L, 0, 5);
+            lua_pushstring(s.L, "macros");
+            lua_createtable(s.L, n_customcontrollers, 0);
+            for (int i = 0; i < n_customcontrollers; ++i)
+            {
+                lua_pushnumber(s.L, i + 1);
+                lua_pushboolean(s.L, false);
+                lua_settable(s.L, -3);
+            }
             lua_settable(s.L, -3);
-        }
-        lua_settable(s.L, -3);
 
-        lua_settable(s.L, -3);
+            lua_settable(s.L, -3);
+        }
 
         lua_pushstring(s.L, "samplerate");
         lua_pushnumber(s.L, storage->samplerate);
@@ -238,8 +1016,18 @@ end
             addb("released", s.released);
             addb("clamp_output", true);
 
+            EvaluationBudgetScope budget(storage, &s, true);
+            budget.arm();
             auto cres = lua_pcall(s.L, 1, 1, 0);
-            if (cres == LUA_OK)
+            auto overran = budget.finish();
+
+            if (cres != LUA_OK && budget.tripped() && isBudgetError(s.L))
+            {
+                // this voice goes without, but the formula only goes off if this keeps happening
+                s.isvalid = false;
+                noteOverrun(storage, fs, &s, *budget.b);
+            }
+            else if (cres == LUA_OK)
             {
                 if (!lua_istable(s.L, -1))
                 {
@@ -258,6 +1046,12 @@ end
                 s.adderror(oss.str());
                 stateData.knownBadFunctions.insert(s.funcName);
             }
+
+            if (overran && cres == LUA_OK)
+            {
+                // it did finish, so this voice keeps it, but the time still counts
+                noteOverrun(storage, fs, &s, *budget.b);
+            }
         }
 
         // FIXME - we have to clean this up when evaluation is done
@@ -339,6 +1133,8 @@ end
                 lua_pop(s.L, 1); // the modulator state
             }
         }
+
+        bindIO(s);
     }
 
     if (is_display)
@@ -417,167 +1213,187 @@ void removeFunctionsAssociatedWith(SurgeStorage *storage, FormulaModulatorStorag
 bool cleanEvaluatorState(EvaluatorState &s)
 {
 #if HAS_LUA
-    if (s.L && s.stateName[0] != 0)
-    {
-        lua_pushnil(s.L);
-        lua_setglobal(s.L, s.stateName);
-        s.stateName[0] = 0;
-    }
+    releaseState(s);
 #endif
     return true;
 }
 
-bool initEvaluatorState(EvaluatorState &s)
-{
-    s.funcName[0] = 0;
-    s.funcNameInit[0] = 0;
-    s.stateName[0] = 0;
-    s.L = nullptr;
-    return true;
-}
-void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
-             FormulaModulatorStorage *fs, EvaluatorState *s, float output[max_formula_outputs],
-             bool justSetup)
+void stepGarbageCollection(SurgeStorage *storage)
 {
 #if HAS_LUA
-    s->activeoutputs = 1;
-    memset(output, 0, max_formula_outputs * sizeof(float));
-    if (s->L == nullptr)
-        return;
+    auto &stateData = *storage->formulaGlobalData;
+    auto *L = (lua_State *)stateData.audioState;
 
-    if (!s->isvalid)
+    if (!L)
         return;
 
-    auto gs = Surge::LuaSupport::SGLD("valueAt", s->L);
-    struct OnErrorReplaceWithZero
-    {
-        OnErrorReplaceWithZero(lua_State *L, std::string fn) : L(L), fn(fn) {}
-        ~OnErrorReplaceWithZero()
-        {
-            if (replace)
-            {
-                // std::cout << "Would nuke " << fn << std::endl;
-                lua_getglobal(L, "surge_reserved_formula_error_stub");
-                lua_setglobal(L, fn.c_str());
-            }
-        }
-        lua_State *L;
-        std::string fn;
-        bool replace = true;
-    } onerr(s->L, s->funcName);
     /*
-     * So: make the stack my evaluation func then my table; then push my table
-     * values; then call my function; then update my global
+     * The collector keeps pace with the garbage by stepping once for each KB the heap grew by
+     * since the last block, up to maxStepsPerBlock. Should formulas make garbage faster than
+     * that, the heap grows, and once it is well past where the last cycle left it, the cycle is
+     * finished, since a long block beats a heap growing without bound.
      */
-    lua_getglobal(s->L, s->funcName);
-    if (!lua_isfunction(s->L, -1))
-    {
-        s->isvalid = false;
-        lua_pop(s->L, 1);
-        return;
-    }
-    lua_getglobal(s->L, s->stateName);
+    static constexpr int maxStepsPerBlock = 64;
 
-    lua_pushstring(s->L, "av");
-    lua_gettable(s->L, -2);
-    lua_pop(s->L, 1);
+    auto kb = lua_gc(L, LUA_GCCOUNT, 0);
+    auto steps = std::clamp(1 + kb - stateData.heapKBAfterStep, 1, maxStepsPerBlock);
 
-    // Stack is now func > table  so we can update the table
-    lua_pushstring(s->L, "intphase");
-    lua_pushinteger(s->L, phaseIntPart);
-    lua_settable(s->L, -3);
+    if (kb > 4 * stateData.heapKBAtCycleEnd + 4096)
+    {
+        steps = std::numeric_limits<int>::max();
+    }
 
-    // Alias cycle for intphase
-    lua_pushstring(s->L, "cycle");
-    lua_pushinteger(s->L, phaseIntPart);
-    lua_settable(s->L, -3);
+    for (int i = 0; i < steps; ++i)
+    {
+        if (lua_gc(L, LUA_GCSTEP, 0))
+        {
+            stateData.heapKBAtCycleEnd = lua_gc(L, LUA_GCCOUNT, 0);
+            break;
+        }
+    }
 
-    auto addn = [s](const char *q, float f) {
-        lua_pushstring(s->L, q);
-        lua_pushnumber(s->L, f);
-        lua_settable(s->L, -3);
-    };
+    // a step lets the collector run on its own again, so stop it once more
+    lua_gc(L, LUA_GCSTOP, 0);
+    stateData.heapKBAfterStep = lua_gc(L, LUA_GCCOUNT, 0);
+#endif
+}
 
-    auto addb = [s](const char *q, bool b) {
-        lua_pushstring(s->L, q);
-        lua_pushboolean(s->L, b);
-        lua_settable(s->L, -3);
-    };
+void endBlock(SurgeStorage *storage)
+{
+#if HAS_LUA
+    auto &b = storage->formulaGlobalData->audioBudget;
 
-    auto addnil = [s](const char *q) {
-        lua_pushstring(s->L, q);
-        lua_pushnil(s->L);
-        lua_settable(s->L, -3);
-    };
+    b.spent = {};
+    b.period++;
+#endif
+}
 
-    addn("phase", phaseFracPart);
+bool initEvaluatorState(EvaluatorState &s)
+{
+    s.funcName[0] = 0;
+    s.funcNameInit[0] = 0;
+    s.stateName[0] = 0;
+    s.L = nullptr;
+    s.ioRef = 0;
+    s.ioBoundTo = nullptr;
+    s.pool = nullptr;
+    return true;
+}
 
-    if (true /* s->subLfoEnvelope */)
-    {
-        addn("delay", s->del);
-        addn("decay", s->dec);
-        addn("attack", s->a);
-        addn("hold", s->h);
-        addn("sustain", s->s);
-        addn("release", s->r);
-    }
-    if (true /* s->subLfoParams */)
+#if HAS_LUA
+/*
+ * Replaces the process function with the error stub if we leave valueAt without clearing replace.
+ */
+struct OnErrorReplaceWithZero
+{
+    OnErrorReplaceWithZero(lua_State *L, std::string fn) : L(L), fn(fn) {}
+    ~OnErrorReplaceWithZero()
     {
-        addn("rate", s->rate);
-        addn("amplitude", s->amp);
-        addn("startphase", s->phase);
-        addn("deform", s->deform);
+        if (replace)
+        {
+            // std::cout << "Would nuke " << fn << std::endl;
+            lua_getglobal(L, "surge_reserved_formula_error_stub");
+            lua_setglobal(L, fn.c_str());
+        }
     }
+    lua_State *L;
+    std::string fn;
+    bool replace = true;
+};
 
-    if (true /* s->subTiming */)
-    {
-        addn("tempo", s->tempo);
-        addn("songpos", s->songpos);
-        addb("released", s->released);
-    }
+static void fillIO(EvaluatorState *s, int phaseIntPart, float phaseFracPart)
+{
+    auto &io = s->io;
+
+    io.phase = phaseFracPart;
+    io.intphase = phaseIntPart;
+    io.del = s->del;
+    io.dec = s->dec;
+    io.a = s->a;
+    io.h = s->h;
+    io.s = s->s;
+    io.r = s->r;
+    io.rate = s->rate;
+    io.amp = s->amp;
+    io.startphase = s->phase;
+    io.deform = s->deform;
+    io.tempo = s->tempo;
+    io.songpos = s->songpos;
+    io.released = s->released;
+    io.isVoice = s->isVoice;
+    io.key = s->key;
+    io.velocity = s->velocity;
+    io.channel = s->channel;
+    io.subAnyMacro = s->subAnyMacro;
 
-    if (/* s->subVoice  && */ s->isVoice)
+    if (s->subAnyMacro)
     {
-        addb("is_voice", s->isVoice);
-        addn("key", s->key);
-        addn("velocity", s->velocity);
-        addn("channel", s->channel);
-        addb("released", s->released);
+        for (int i = 0; i < n_customcontrollers; ++i)
+        {
+            io.subMacros[i] = s->subMacros[i];
+            io.macros[i] = s->macrovalues[i];
+        }
     }
-    else
+
+    for (auto &o : io.output)
     {
-        addb("is_voice", false);
+        o = 0;
     }
+}
 
-    addnil("retrigger_AEG");
-    addnil("retrigger_FEG");
+/*
+ * With the result of process (or the error from calling it) on the top of the stack, pop it and
+ * fill the outputs and flags of s from it. Returns whether process should stay in place, which
+ * is only the case when it returned a table.
+ */
+static bool readProcessResult(int lres, bool throughIO, SurgeStorage *storage, EvaluatorState *s,
+                              float output[max_formula_outputs])
+{
+    auto &io = s->io;
 
-    if (s->subAnyMacro)
+    if (throughIO && lres == LUA_OK && (io.resultKind == 0 || io.resultKind == 1))
     {
-        // load the macros
-        lua_pushstring(s->L, "macros");
-        lua_createtable(s->L, n_customcontrollers, 0);
-        for (int i = 0; i < n_customcontrollers; ++i)
+        s->isFinite = true;
+        auto checkFinite = [s](float f) {
+            if (!std::isfinite(f))
+            {
+                s->isFinite = false;
+                return 0.f;
+            }
+            return f;
+        };
+
+        if (io.resultKind == 0)
+        {
+            lua_pop(s->L, 1);
+            output[0] = checkFinite(io.output[0]);
+            return false;
+        }
+
+        lua_setglobal(s->L, s->stateName);
+
+        for (int i = 0; i < max_formula_outputs; ++i)
+        {
+            output[i] = checkFinite(io.output[i]);
+        }
+
+        s->activeoutputs = io.activeOutputs;
+        s->useEnvelope = io.useEnvelope;
+        s->retrigger_AEG = io.retriggerAEG;
+        s->retrigger_FEG = io.retriggerFEG;
+
+        if (io.clampOutput)
         {
-            if (s->subMacros[i])
+            for (int i = 0; i < 8; ++i)
             {
-                lua_pushinteger(s->L, i + 1);
-                lua_pushnumber(s->L, s->macrovalues[i]);
-                lua_settable(s->L, -3);
+                output[i] = limitpm1(output[i]);
             }
         }
-        lua_settable(s->L, -3);
-    }
 
-    if (justSetup)
-    {
-        // Don't call but still clear me from the stack
-        lua_pop(s->L, 2);
-        return;
+        return true;
     }
 
-    auto lres = lua_pcall(s->L, 1, 1, 0);
-    // stack is now just the result
+    // Otherwise the trampoline left it to us, and the stack is now just the result
     if (lres == LUA_OK)
     {
         s->isFinite = true;
@@ -596,7 +1412,7 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
             auto r = lua_tonumber(s->L, -1);
             lua_pop(s->L, 1);
             output[0] = checkFinite(r);
-            return;
+            return false;
         }
         if (!lua_istable(s->L, -1))
         {
@@ -605,7 +1421,7 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
                 "output set.");
             s->isvalid = false;
             lua_pop(s->L, 1);
-            return;
+            return false;
         }
         // Store the value and keep it on top of the stack
         lua_setglobal(s->L, s->stateName);
@@ -699,8 +1515,7 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
 
         // Finally pop the table result
         lua_pop(s->L, 1);
-        onerr.replace = false;
-        return;
+        return true;
     }
     else
     {
@@ -709,8 +1524,184 @@ void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
         oss << "Failed to evaluate 'process' function." << lua_tostring(s->L, -1);
         s->adderror(oss.str());
         lua_pop(s->L, 1);
+        return false;
+    }
+}
+#endif
+
+void valueAt(int phaseIntPart, float phaseFracPart, SurgeStorage *storage,
+             FormulaModulatorStorage *fs, EvaluatorState *s, float output[max_formula_outputs],
+             bool justSetup)
+{
+#if HAS_LUA
+    s->activeoutputs = 1;
+    memset(output, 0, max_formula_outputs * sizeof(float));
+    if (s->L == nullptr)
+        return;
+
+    if (!s->isvalid)
+        return;
+
+    auto gs = Surge::LuaSupport::SGLD("valueAt", s->L);
+    OnErrorReplaceWithZero onerr(s->L, s->funcName);
+    /*
+     * So: make the stack my evaluation func then my table; then push my table
+     * values; then call my function; then update my global
+     */
+    lua_getglobal(s->L, s->funcName);
+    if (!lua_isfunction(s->L, -1))
+    {
+        s->isvalid = false;
+        lua_pop(s->L, 1);
+        return;
+    }
+
+    int lres;
+    bool throughIO = s->ioRef && s->ioBoundTo == &s->io;
+    EvaluationBudgetScope budget(storage, s);
+
+    if (throughIO)
+    {
+        fillIO(s, phaseIntPart, phaseFracPart);
+
+        // Stack is func, so make it trampoline > func > table > justSetup
+        lua_rawgeti(s->L, LUA_REGISTRYINDEX, s->ioRef);
+        lua_insert(s->L, -2);
+        lua_getglobal(s->L, s->stateName);
+        lua_pushboolean(s->L, justSetup);
+
+        budget.arm();
+        lres = lua_pcall(s->L, 3, 1, 0);
+
+        if (justSetup)
+        {
+            lua_pop(s->L, 1);
+            return;
+        }
+    }
+    else
+    {
+        lua_getglobal(s->L, s->stateName);
+
+        lua_pushstring(s->L, "av");
+        lua_gettable(s->L, -2);
+        lua_pop(s->L, 1);
+
+        // Stack is now func > table  so we can update the table
+        lua_pushstring(s->L, "intphase");
+        lua_pushinteger(s->L, phaseIntPart);
+        lua_settable(s->L, -3);
+
+        // Alias cycle for intphase
+        lua_pushstring(s->L, "cycle");
+        lua_pushinteger(s->L, phaseIntPart);
+        lua_settable(s->L, -3);
+
+        auto addn = [s](const char *q, float f) {
+            lua_pushstring(s->L, q);
+            lua_pushnumber(s->L, f);
+            lua_settable(s->L, -3);
+        };
+
+        auto addb = [s](const char *q, bool b) {
+            lua_pushstring(s->L, q);
+            lua_pushboolean(s->L, b);
+            lua_settable(s->L, -3);
+        };
+
+        auto addnil = [s](const char *q) {
+            lua_pushstring(s->L, q);
+            lua_pushnil(s->L);
+            lua_settable(s->L, -3);
+        };
+
+        addn("phase", phaseFracPart);
+
+        if (true /* s->subLfoEnvelope */)
+        {
+            addn("delay", s->del);
+            addn("decay", s->dec);
+            addn("attack", s->a);
+            addn("hold", s->h);
+            addn("sustain", s->s);
+            addn("release", s->r);
+        }
+        if (true /* s->subLfoParams */)
+        {
+            addn("rate", s->rate);
+            addn("amplitude", s->amp);
+            addn("startphase", s->phase);
+            addn("deform", s->deform);
+        }
+
+        if (true /* s->subTiming */)
+        {
+            addn("tempo", s->tempo);
+            addn("songpos", s->songpos);
+            addb("released", s->released);
+        }
+
+        if (/* s->subVoice  && */ s->isVoice)
+        {
+            addb("is_voice", s->isVoice);
+            addn("key", s->key);
+            addn("velocity", s->velocity);
+            addn("channel", s->channel);
+            addb("released", s->released);
+        }
+        else
+        {
+            addb("is_voice", false);
+        }
+
+        addnil("retrigger_AEG");
+        addnil("retrigger_FEG");
+
+        if (s->subAnyMacro)
+        {
+            // load the macros
+            lua_pushstring(s->L, "macros");
+            lua_createtable(s->L, n_customcontrollers, 0);
+            for (int i = 0; i < n_customcontrollers; ++i)
+            {
+                if (s->subMacros[i])
+                {
+                    lua_pushinteger(s->L, i + 1);
+                    lua_pushnumber(s->L, s->macrovalues[i]);
+                    lua_settable(s->L, -3);
+                }
+            }
+            lua_settable(s->L, -3);
+        }
+
+        if (justSetup)
+        {
+            // Don't call but still clear me from the stack
+            lua_pop(s->L, 2);
+            return;
+        }
+
+        budget.arm();
+        lres = lua_pcall(s->L, 1, 1, 0);
+    }
+
+    auto overran = budget.finish();
+
+    if (lres != LUA_OK && budget.tripped() && isBudgetError(s->L))
+    {
+        // stopped for this block, which leaves the outputs at 0, but the function stays
+        lua_pop(s->L, 1);
+        onerr.replace = false;
+        noteOverrun(storage, fs, s, *budget.b);
         return;
     }
+
+    onerr.replace = !readProcessResult(lres, throughIO, storage, s, output);
+
+    if (overran)
+    {
+        noteOverrun(storage, fs, s, *budget.b);
+    }
 #else
 #endif
 }
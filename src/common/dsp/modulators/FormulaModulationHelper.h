@@ -28,6 +28,9 @@
 #include "LuaSupport.h"
 #include <variant>
 #include <memory>
+#include <chrono>
+#include <array>
+#include <limits>
 
 class SurgeVoice;
 
@@ -36,15 +39,112 @@ namespace Surge
 namespace Formula
 {
 
+/*
+ * A formula which has run over its budget. Blocks run long now and then for reasons of their
+ * own, and the formula which runs over a shared budget isn't always the one which spent it, so
+ * a formula is only switched off once it has run over in a number of periods within a second.
+ * It then stays off until its FormulaModulatorStorage is set again.
+ */
+struct OverrunRecord
+{
+    // the formula this counts for is the one fs held at generation
+    const FormulaModulatorStorage *fs{nullptr};
+    uint32_t generation{0};
+    size_t formulaHash{0};
+
+    int count{0};
+    uint64_t lastPeriod{0};
+    std::chrono::steady_clock::time_point windowStart;
+    bool switchedOff{false};
+
+    bool isFor(const FormulaModulatorStorage *f) const
+    {
+        return fs == f && generation == f->generation && formulaHash == f->formulaHash;
+    }
+};
+
+/*
+ * How long the formula evaluations running in a Lua state may take (see
+ * SurgeStorage::formulaTimeBudgetInBlocks). On the audio state the process calls of a block
+ * share it and endBlock starts the next one; the display state has no blocks, so there each
+ * call gets all of it. Checks parsed into the formulas look at it while an evaluation is armed,
+ * and stop the evaluation once it has run over. Each state keeps its own overruns, so the audio
+ * and display threads never share them.
+ */
+struct EvaluationBudget
+{
+    bool armed{false}, tripped{false};
+
+    // how many more checks may pass before one looks at the clock, which the formulas' checks
+    // count down through the FFI
+    int32_t left{std::numeric_limits<int32_t>::max()};
+
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::duration allowed{}, spent{};
+
+    // counts blocks on the audio state and calls on the display state
+    uint64_t period{0};
+
+    // the formulas which have run over on this state. A fixed number of them, so that counting
+    // an overrun never allocates on the audio thread
+    std::array<OverrunRecord, 2 * n_scenes * n_lfos> overruns;
+};
+
+struct EvaluatorIO;
+
 struct GlobalData
 {
     std::unordered_set<std::string> knownBadFunctions; // these are functions which cause an error
     std::unordered_map<FormulaModulatorStorage *, std::unordered_set<std::string>> functionsPerFMS;
     void *audioState{nullptr}, *displayState{nullptr};
+    EvaluationBudget audioBudget, displayBudget;
+
+    /*
+     * The audio thread states of voices which have finished, with their state table (still
+     * under stateName) and trampoline, for the next voices to start to reset in place rather
+     * than make new. Reserved up front so that the audio thread never grows it.
+     */
+    struct PooledState
+    {
+        char stateName[TXT_SIZE];
+        int ioRef;
+        const EvaluatorIO *ioBoundTo;
+    };
+    std::vector<PooledState> statePool;
+
+    // the size of the audio state heap after the last step of its collector, and when that
+    // last finished a cycle; see stepGarbageCollection
+    int heapKBAfterStep{0}, heapKBAtCycleEnd{0};
 };
 
 static constexpr int max_formula_outputs{max_lfo_indices};
 
+/*
+ * What valueAt hands the process function and gets back from it each block. Rather than
+ * pushing each of these into the state table through the Lua API, valueAt writes them here and
+ * a small trampoline, which sees this struct through the LuaJIT FFI, copies them in and the
+ * results out (see prepareForEvaluation). So this has to stay in step with the cdef there.
+ */
+struct EvaluatorIO
+{
+    // in
+    double phase;
+    int32_t intphase;
+    double del, dec, a, h, s, r;
+    double rate, amp, startphase, deform;
+    double tempo, songpos;
+    bool released, isVoice;
+    double key, velocity, channel;
+    bool subAnyMacro, subMacros[n_customcontrollers];
+    double macros[n_customcontrollers];
+
+    // out
+    int32_t resultKind;
+    int32_t activeOutputs;
+    bool useEnvelope, retriggerAEG, retriggerFEG, clampOutput;
+    double output[max_formula_outputs];
+};
+
 struct EvaluatorState
 {
     bool released;
@@ -85,6 +185,14 @@ struct EvaluatorState
     int activeoutputs;
 
     lua_State *L{nullptr}; // This is assigned by prepareForEvaluation to be one per thread
+
+    // The trampoline bound to io, as a reference in the registry of L, or 0 if there isn't one
+    EvaluatorIO io;
+    int ioRef{0};
+    const EvaluatorIO *ioBoundTo{nullptr};
+
+    // Where the state table and trampoline go when this is done, if they are pooled
+    GlobalData *pool{nullptr};
 };
 
 void setupStorage(SurgeStorage *s);
@@ -96,6 +204,18 @@ void removeFunctionsAssociatedWith(SurgeStorage *,
 bool prepareForEvaluation(SurgeStorage *storage, FormulaModulatorStorage *fs, EvaluatorState &s,
                           bool is_display);
 
+/*
+ * Runs a bounded step of the audio state's garbage collector. The collector doesn't run on its
+ * own in that state, so call this once a block from the audio thread.
+ */
+void stepGarbageCollection(SurgeStorage *storage);
+
+/*
+ * Closes this block of the audio state's time budget, so call it once a block from the audio
+ * thread once the formula modulators have run.
+ */
+void endBlock(SurgeStorage *storage);
+
 void setupEvaluatorStateFrom(EvaluatorState &s, const SurgePatch &p);
 void setupEvaluatorStateFrom(EvaluatorState &s, const SurgeVoice *v);
 
@@ -537,15 +537,124 @@ void LFOModulationSource::retriggerEnvelopeFrom(float start)
 
 void LFOModulationSource::process_block()
 {
-    if ((!phaseInitialized) || (lfo->trigmode.val.i == lm_keytrigger && lfo->rate.deactivated))
+    float frate = blockRate();
+
+    advance(frate);
+
+    if (lfo->shape.val.i == lt_formula)
     {
-        initPhaseFromStartPhase();
+        evaluateFormula();
+        return;
     }
 
-    retrigger_FEG = false;
-    retrigger_AEG = false;
+    evaluateShape(frate);
+    writeOutputs();
+}
 
+void LFOModulationSource::process_block_quad(LFOModulationSource *const *lfos, int n)
+{
+    // these are the same LFO in voices of one scene, so they share their settings
+    auto *lfo = lfos[0]->lfo;
+    auto *storage = lfos[0]->storage;
     int s = lfo->shape.val.i;
+
+    bool batched = s == lt_square || (lfo->deform.deform_type == type_1 &&
+                                      (s == lt_sine || s == lt_tri || s == lt_ramp));
+
+    if (!batched)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            lfos[i]->process_block();
+        }
+
+        return;
+    }
+
+    float frate alignas(16)[4]{}, phase alignas(16)[4]{}, deform alignas(16)[4]{};
+
+    for (int i = 0; i < n; ++i)
+    {
+        auto *l = lfos[i];
+
+        // voices whose rate isn't modulated apart share the work of turning it into a step
+        int j = 0;
+        while (j < i && lfos[j]->localcopy[l->rate].f != l->localcopy[l->rate].f)
+        {
+            j++;
+        }
+
+        frate[i] = (j < i) ? frate[j] : l->blockRate();
+
+        l->advance(frate[i]);
+
+        phase[i] = l->phase;
+        deform[i] = l->localcopy[l->ideform].f;
+    }
+
+    const auto one = _mm_set1_ps(1.f), half = _mm_set1_ps(0.5f);
+    auto ph = _mm_load_ps(phase), df = _mm_load_ps(deform);
+    __m128 out;
+
+    if (s == lt_square)
+    {
+        auto m = _mm_cmpgt_ps(ph, _mm_add_ps(half, _mm_mul_ps(half, df)));
+        out = _mm_or_ps(_mm_and_ps(m, _mm_set1_ps(-1.f)), _mm_andnot_ps(m, one));
+    }
+    else
+    {
+        __m128 x;
+
+        switch (s)
+        {
+        case lt_sine:
+        {
+            constexpr auto wst_sine = sst::waveshapers::WaveshaperType::wst_sine;
+            float w alignas(16)[4]{};
+
+            for (int i = 0; i < n; ++i)
+            {
+                w[i] = storage->lookup_waveshape_warp(wst_sine, 2.f - 4.f * phase[i]);
+            }
+
+            x = _mm_load_ps(w);
+            break;
+        }
+        case lt_tri:
+        {
+            auto m = _mm_cmpgt_ps(ph, half);
+            auto t = _mm_or_ps(_mm_and_ps(m, _mm_sub_ps(one, ph)), _mm_andnot_ps(m, ph));
+            x = _mm_add_ps(_mm_set1_ps(-1.f), _mm_mul_ps(_mm_set1_ps(4.f), t));
+            break;
+        }
+        default:
+            x = _mm_sub_ps(one, _mm_mul_ps(_mm_set1_ps(2.f), ph));
+            break;
+        }
+
+        // bend1, in lanes
+        auto a = _mm_mul_ps(half, _mm_max_ps(_mm_min_ps(df, _mm_set1_ps(3.f)), _mm_set1_ps(-3.f)));
+
+        for (int k = 0; k < 2; ++k)
+        {
+            x = _mm_add_ps(_mm_sub_ps(x, _mm_mul_ps(_mm_mul_ps(a, x), x)), a);
+        }
+
+        out = x;
+    }
+
+    float iout alignas(16)[4];
+    _mm_store_ps(iout, out);
+
+    for (int i = 0; i < n; ++i)
+    {
+        lfos[i]->iout = iout[i];
+        lfos[i]->writeOutputs();
+    }
+}
+
+float LFOModulationSource::blockRate()
+{
     float frate = 0;
 
     if (!lfo->rate.temposync)
@@ -576,6 +685,21 @@ void LFOModulationSource::process_block()
         frate *= storage->temposyncratio;
     }
 
+    return frate;
+}
+
+void LFOModulationSource::advance(float frate)
+{
+    if ((!phaseInitialized) || (lfo->trigmode.val.i == lm_keytrigger && lfo->rate.deactivated))
+    {
+        initPhaseFromStartPhase();
+    }
+
+    retrigger_FEG = false;
+    retrigger_AEG = false;
+
+    int s = lfo->shape.val.i;
+
     phase += frate * ratemult;
 
     if (frate == 0 && phase == 0 && s == lt_stepseq)
@@ -813,15 +937,21 @@ void LFOModulationSource::process_block()
             break;
         };
     }
+}
 
-    float useenvval = env_val;
-
+float LFOModulationSource::envelopeValue()
+{
     if (lfo->delay.deactivated)
     {
-        useenvval = 1.0; // constant envelope at 1
+        return 1.0; // constant envelope at 1
     }
 
-    switch (s)
+    return env_val;
+}
+
+void LFOModulationSource::evaluateShape(float frate)
+{
+    switch (lfo->shape.val.i)
     {
     case lt_envelope:
     {
@@ -1195,65 +1325,15 @@ void LFOModulationSource::process_block()
     }
 
     case lt_formula:
-    {
-        formulastate.released = (env_state == lfoeg_release || env_state == lfoeg_msegrelease);
-
-        formulastate.del = lfo->delay.value_to_normalized(localcopy[idelay].f);
-        formulastate.a = lfo->attack.value_to_normalized(localcopy[iattack].f);
-        formulastate.h = lfo->hold.value_to_normalized(localcopy[ihold].f);
-        formulastate.dec = lfo->decay.value_to_normalized(localcopy[idecay].f);
-        formulastate.s = lfo->sustain.value_to_normalized(localcopy[isustain].f);
-        formulastate.r = lfo->release.value_to_normalized(localcopy[irelease].f);
-
-        formulastate.rate = localcopy[rate].f;
-        formulastate.amp = localcopy[magn].f;
-        formulastate.phase = localcopy[startphase].f;
-        formulastate.deform = localcopy[ideform].f;
-        formulastate.tempo = storage->temposyncratio * 120.0;
-        formulastate.songpos = storage->songpos;
-
-        formulastate.isVoice = isVoice;
-
-        float tmpout[Surge::Formula::max_formula_outputs] = {0, 0, 0, 0, 0, 0, 0, 0};
-
-        Surge::Formula::valueAt(unwrappedphase_intpart, phase, storage, fs, &formulastate, tmpout);
-
-        if (!formulastate.useEnvelope)
-        {
-            useenvval = 1.0;
-        }
-
-        retrigger_AEG = formulastate.retrigger_AEG;
-        retrigger_FEG = formulastate.retrigger_FEG;
-
-        if (formulastate.raisedError)
-        {
-            auto em = *formulastate.error;
-            formulastate.error.reset();
-            formulastate.raisedError = false;
-            storage->reportError(em, "Formula Evaluator Error");
-            std::cout << "ERROR: " << em << std::endl;
-        }
-
-        // Since I'm (right now) the only vector valued modulator just do a little
-        // chute and ladder dance here on the output and return
-        auto magnf = limit_range(lfo->magnitude.get_extended(localcopy[magn].f), -3.f, 3.f);
-        auto uni = lfo->unipolar.val.b;
-
-        for (auto i = 0; i < formulastate.activeoutputs; ++i)
-        {
-            if (uni)
-            {
-                tmpout[i] = 0.5f + 0.5f * tmpout[i];
-            }
-
-            output_multi[i] = useenvval * magnf * tmpout[i];
-        }
-
-        return;
-    }
+        // formula modulators go through evaluateFormula instead
+        break;
     };
+}
 
+void LFOModulationSource::writeOutputs()
+{
+    int s = lfo->shape.val.i;
+    float useenvval = envelopeValue();
     float io2 = iout;
 
     // change this? pls check formula
@@ -1346,6 +1426,65 @@ void LFOModulationSource::process_block()
     }
 }
 
+void LFOModulationSource::evaluateFormula()
+{
+    float useenvval = envelopeValue();
+
+    formulastate.released = (env_state == lfoeg_release || env_state == lfoeg_msegrelease);
+
+    formulastate.del = lfo->delay.value_to_normalized(localcopy[idelay].f);
+    formulastate.a = lfo->attack.value_to_normalized(localcopy[iattack].f);
+    formulastate.h = lfo->hold.value_to_normalized(localcopy[ihold].f);
+    formulastate.dec = lfo->decay.value_to_normalized(localcopy[idecay].f);
+    formulastate.s = lfo->sustain.value_to_normalized(localcopy[isustain].f);
+    formulastate.r = lfo->release.value_to_normalized(localcopy[irelease].f);
+
+    formulastate.rate = localcopy[rate].f;
+    formulastate.amp = localcopy[magn].f;
+    formulastate.phase = localcopy[startphase].f;
+    formulastate.deform = localcopy[ideform].f;
+    formulastate.tempo = storage->temposyncratio * 120.0;
+    formulastate.songpos = storage->songpos;
+
+    formulastate.isVoice = isVoice;
+
+    float tmpout[Surge::Formula::max_formula_outputs] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+    Surge::Formula::valueAt(unwrappedphase_intpart, phase, storage, fs, &formulastate, tmpout);
+
+    if (!formulastate.useEnvelope)
+    {
+        useenvval = 1.0;
+    }
+
+    retrigger_AEG = formulastate.retrigger_AEG;
+    retrigger_FEG = formulastate.retrigger_FEG;
+
+    if (formulastate.raisedError)
+    {
+        auto em = *formulastate.error;
+        formulastate.error.reset();
+        formulastate.raisedError = false;
+        storage->reportError(em, "Formula Evaluator Error");
+        std::cout << "ERROR: " << em << std::endl;
+    }
+
+    // Since I'm (right now) the only vector valued modulator just do a little
+    // chute and ladder dance here on the output and return
+    auto magnf = limit_range(lfo->magnitude.get_extended(localcopy[magn].f), -3.f, 3.f);
+    auto uni = lfo->unipolar.val.b;
+
+    for (auto i = 0; i < formulastate.activeoutputs; ++i)
+    {
+        if (uni)
+        {
+            tmpout[i] = 0.5f + 0.5f * tmpout[i];
+        }
+
+        output_multi[i] = useenvval * magnf * tmpout[i];
+    }
+}
+
 void LFOModulationSource::completedModulation()
 {
     if (lfo->shape.val.i == lt_formula)
@@ -59,6 +59,14 @@ class LFOModulationSource : public ModulationSource
     void attackFrom(float);
     virtual void release() override;
     virtual void process_block() override;
+
+    /*
+     * Steps this LFO in up to four voices of a scene. Sine, triangle and saw with the first
+     * deform type, and square, compute their shape across the voices in SSE lanes, and voices
+     * whose rate is modulated to the same value share the rate calculation. Every other shape
+     * steps each voice on its own. The result is the same as calling process_block on each.
+     */
+    static void process_block_quad(LFOModulationSource *const *lfos, int n);
     virtual void retriggerEnvelope() { attackFrom(0.f); }
     virtual void retriggerEnvelopeFrom(float);
     virtual void completedModulation();
@@ -130,6 +138,14 @@ class LFOModulationSource : public ModulationSource
     void initPhaseFromStartPhase();
     void msegEnvelopePhaseAdjustment();
 
+    // the steps of process_block
+    float blockRate();
+    void advance(float frate);
+    float envelopeValue();
+    void evaluateShape(float frate);
+    void evaluateFormula();
+    void writeOutputs();
+
     float phase, target, noise, noised1, env_phase, priorPhase;
     int unwrappedphase_intpart;
     int priorStep = -1;
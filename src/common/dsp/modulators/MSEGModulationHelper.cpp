@@ -32,6 +32,164 @@ namespace Surge
 namespace MSEG
 {
 
+/*
+ * The parts of the segment curves in valueAt which only depend on the control point. These
+ * have to be computed exactly as valueAt would have, types and all, since valueAt uses them
+ * in its place.
+ */
+static MSEGStorage::SegmentCoefficients segmentCoefficientsFor(float cpv)
+{
+    MSEGStorage::SegmentCoefficients c;
+
+    c.valid = true;
+    c.cpv = cpv;
+
+    {
+        float V = 0.5 * cpv + 0.5;
+        float amul = 1;
+
+        if (V < 0.5)
+        {
+            amul = -1;
+            V = 1 - V;
+        }
+
+        float disc = (1 - 4 * V * (1 - V));
+        float a = 0;
+
+        if (fabs(V) > 1e-3)
+        {
+            float Q = limit_range((1 - sqrt(disc)) / (2 * V), 0.00001f, 1000000.f);
+            a = amul * 2 * log(Q);
+        }
+
+        c.curveA = a;
+        c.curveExpA = exp(a);
+    }
+
+    {
+        float pct = (cpv + 1) * 0.5;
+        float as = 5.0;
+        float scaledpct = (exp(as * pct) - 1) / (exp(as) - 1);
+        c.waveSteps = (int)(scaledpct * 100);
+    }
+
+    {
+        auto pct = (cpv + 1) * 0.5;
+        auto as = 5.0;
+        auto scaledpct = (exp(as * pct) - 1) / (exp(as) - 1);
+        c.stairSteps = (int)(scaledpct * 100) + 2;
+    }
+
+    return c;
+}
+
+static void rebuildTimeIndex(MSEGStorage *ms)
+{
+    int n = ms->n_activeSegments;
+
+    ms->timeIndexScale = 0;
+
+    if (n <= 0 || !(ms->totalDuration > 0))
+    {
+        return;
+    }
+
+    // The lookup relies on the segment times only ever going forward
+    for (int i = 0; i < n; ++i)
+    {
+        if (ms->segmentEnd[i] < ms->segmentStart[i] ||
+            (i > 0 && (ms->segmentStart[i] < ms->segmentStart[i - 1] ||
+                       ms->segmentEnd[i] < ms->segmentEnd[i - 1])))
+        {
+            return;
+        }
+    }
+
+    double scale = MSEGStorage::timeIndexSize / (double)ms->totalDuration;
+    int i = 0;
+
+    for (int b = 0; b < MSEGStorage::timeIndexSize; ++b)
+    {
+        double cellStart = b / scale;
+
+        while (i < n - 1 && ms->segmentEnd[i] <= cellStart)
+        {
+            i++;
+        }
+
+        ms->timeIndex[b] = i;
+    }
+
+    ms->timeIndexScale = scale;
+}
+
+/*
+ * The first segment with segmentStart <= t < segmentEnd (or t <= segmentEnd, if endInclusive),
+ * or -1 if there isn't one; the same answer as checking each segment from the first. With the
+ * segment times in order, that is the first segment t is before the end of, as long as t is
+ * past its start. The hint (the segment the last evaluation landed in) or the time index gets
+ * us to that segment without the walk.
+ */
+static int segmentAt(const MSEGStorage *ms, double t, bool endInclusive, int hint = -1)
+{
+    int n = ms->n_activeSegments;
+
+    auto beforeEnd = [ms, t, endInclusive](int i) {
+        return endInclusive ? t <= ms->segmentEnd[i] : t < ms->segmentEnd[i];
+    };
+
+    auto isFirst = [&beforeEnd](int i) { return beforeEnd(i) && (i == 0 || !beforeEnd(i - 1)); };
+
+    if (ms->timeIndexScale <= 0)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            if (t >= ms->segmentStart[i] && beforeEnd(i))
+            {
+                return i;
+            }
+        }
+
+        return -1;
+    }
+
+    int i = -1;
+
+    if (hint >= 0 && hint < n && isFirst(hint))
+    {
+        i = hint;
+    }
+    else if (hint >= 0 && hint + 1 < n && isFirst(hint + 1))
+    {
+        i = hint + 1;
+    }
+    else
+    {
+        double cell = t * ms->timeIndexScale;
+        int b = (cell > 0) ? (int)std::min(cell, (double)(MSEGStorage::timeIndexSize - 1)) : 0;
+
+        i = std::min((int)ms->timeIndex[b], n - 1);
+
+        while (i > 0 && beforeEnd(i - 1))
+        {
+            i--;
+        }
+
+        while (i < n && !beforeEnd(i))
+        {
+            i++;
+        }
+
+        if (i >= n)
+        {
+            return -1;
+        }
+    }
+
+    return (t >= ms->segmentStart[i]) ? i : -1;
+}
+
 void rebuildCache(MSEGStorage *ms)
 {
     forceToConstrainedNormalForm(ms);
@@ -114,6 +272,13 @@ void rebuildCache(MSEGStorage *ms)
             ms->segmentEnd[(ms->loop_end >= 0 ? ms->loop_end : ms->n_activeSegments - 1)] -
             ms->segmentStart[(ms->loop_start >= 0 ? ms->loop_start : 0)];
     }
+
+    for (int i = 0; i < ms->n_activeSegments; ++i)
+    {
+        ms->segmentCoefficients[i] = segmentCoefficientsFor(ms->segments[i].cpv);
+    }
+
+    rebuildTimeIndex(ms);
 }
 
 float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es, bool forceOneShot)
@@ -157,7 +322,7 @@ float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es,
         idx = timeToSegment(ms, up,
                             forceOneShot || ms->loopMode == MSEGStorage::ONESHOT ||
                                 ms->editMode == MSEGStorage::LFO,
-                            timeAlongSegment);
+                            timeAlongSegment, es->lastEval);
 
         if (idx < 0 || idx >= ms->n_activeSegments)
         {
@@ -182,15 +347,7 @@ float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es,
             double adjustedPhase = up - es->releaseStartPhase + ms->segmentEnd[ms->loop_end];
 
             // so now find the index
-            idx = -1;
-
-            for (int ai = 0; ai < ms->n_activeSegments && idx < 0; ai++)
-            {
-                if (ms->segmentStart[ai] <= adjustedPhase && ms->segmentEnd[ai] > adjustedPhase)
-                {
-                    idx = ai;
-                }
-            }
+            idx = segmentAt(ms, adjustedPhase, false, es->lastEval);
 
             if (idx < 0)
             {
@@ -212,6 +369,21 @@ float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es,
     auto r = ms->segments[idx];
     bool segInit = false;
 
+    // the cached coefficients stand in for computing them from cpv here, unless the segment
+    // was edited since the last rebuildCache; valueAt never writes to the cache
+    MSEGStorage::SegmentCoefficients uncachedCoefficients;
+    auto coefficients = [&](int i) -> const MSEGStorage::SegmentCoefficients & {
+        auto &c = ms->segmentCoefficients[i];
+
+        if (c.valid && c.cpv == r.cpv)
+        {
+            return c;
+        }
+
+        uncachedCoefficients = segmentCoefficientsFor(r.cpv);
+        return uncachedCoefficients;
+    };
+
     if (idx != es->lastEval || es->has_triggered)
     {
         segInit = true;
@@ -351,30 +523,16 @@ float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es,
          *
          */
 
-        float V = 0.5 * r.cpv + 0.5;
-        float amul = 1;
-
-        if (V < 0.5)
-        {
-            amul = -1;
-            V = 1 - V;
-        }
-
-        float disc = (1 - 4 * V * (1 - V));
-        float a = 0;
-
-        if (fabs(V) > 1e-3)
-        {
-            float Q = limit_range((1 - sqrt(disc)) / (2 * V), 0.00001f, 1000000.f);
-            a = amul * 2 * log(Q);
-        }
+        // which segmentCoefficientsFor works out, from cpv, at cache rebuild time
+        auto &coef = coefficients(idx);
+        float a = coef.curveA;
 
         // OK so frac is the 0,1 line point
         auto cpline = frac;
 
         if (fabs(a) > 1e-3)
         {
-            cpline = (exp(a * frac) - 1) / (exp(a) - 1);
+            cpline = (exp(a * frac) - 1) / ((decltype(exp(a)))coef.curveExpA - 1);
         }
 
         if (r.type == MSEGStorage::segment::LINEAR)
@@ -504,10 +662,7 @@ float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es,
     case MSEGStorage::segment::TRIANGLE:
     case MSEGStorage::segment::SQUARE:
     {
-        float pct = (r.cpv + 1) * 0.5;
-        float as = 5.0;
-        float scaledpct = (exp(as * pct) - 1) / (exp(as) - 1);
-        int steps = (int)(scaledpct * 100);
+        int steps = coefficients(idx).waveSteps;
         auto frac = timeAlongSegment / r.duration;
         float kernel = 0;
 
@@ -577,10 +732,7 @@ float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es,
 
     case MSEGStorage::segment::STAIRS:
     {
-        auto pct = (r.cpv + 1) * 0.5;
-        auto as = 5.0;
-        auto scaledpct = (exp(as * pct) - 1) / (exp(as) - 1);
-        auto steps = (int)(scaledpct * 100) + 2;
+        auto steps = coefficients(idx).stairSteps;
         auto frac = (float)((int)(steps * timeAlongSegment / r.duration)) / (steps - 1);
 
         if (df < 0)
@@ -598,10 +750,7 @@ float valueAt(int ip, float fup, float df, MSEGStorage *ms, EvaluatorState *es,
     }
     case MSEGStorage::segment::SMOOTH_STAIRS:
     {
-        auto pct = (r.cpv + 1) * 0.5;
-        auto as = 5.0;
-        auto scaledpct = (exp(as * pct) - 1) / (exp(as) - 1);
-        auto steps = (int)(scaledpct * 100) + 2;
+        auto steps = coefficients(idx).stairSteps;
         auto frac = timeAlongSegment / r.duration;
 
         auto c = df < 0.f ? 1.0 + df * 0.7 : 1.0 + df * 3.0;
@@ -728,7 +877,8 @@ int timeToSegment(MSEGStorage *ms, double t)
     return timeToSegment(ms, t, true, x);
 }
 
-int timeToSegment(MSEGStorage *ms, double t, bool ignoreLoops, float &amountAlongSegment)
+int timeToSegment(MSEGStorage *ms, double t, bool ignoreLoops, float &amountAlongSegment,
+                  int hint)
 {
     if (ms->totalDuration < MSEGStorage::minimumDuration)
     {
@@ -749,17 +899,11 @@ int timeToSegment(MSEGStorage *ms, double t, bool ignoreLoops, float &amountAlon
             }
         }
 
-        int idx = -1;
+        int idx = segmentAt(ms, t, false, hint);
 
-        for (int i = 0; i < ms->n_activeSegments; ++i)
+        if (idx >= 0)
         {
-            if (t >= ms->segmentStart[i] && t < ms->segmentEnd[i])
-            {
-                idx = i;
-                amountAlongSegment = t - ms->segmentStart[i];
-
-                break;
-            }
+            amountAlongSegment = t - ms->segmentStart[idx];
         }
 
         return idx;
@@ -773,13 +917,14 @@ int timeToSegment(MSEGStorage *ms, double t, bool ignoreLoops, float &amountAlon
         // So are we before the first loop end point
         if (t <= ms->durationToLoopEnd)
         {
-            for (int i = 0; i < ms->n_activeSegments; ++i)
-                if (t >= ms->segmentStart[i] && t <= ms->segmentEnd[i])
-                {
-                    amountAlongSegment = t - ms->segmentStart[i];
+            int i = segmentAt(ms, t, true, hint);
 
-                    return i;
-                }
+            if (i >= 0)
+            {
+                amountAlongSegment = t - ms->segmentStart[i];
+
+                return i;
+            }
         }
         else if (ms->loop_start > ms->loop_end && ms->loop_start >= 0 && ms->loop_end >= 0)
         {
@@ -807,13 +952,14 @@ int timeToSegment(MSEGStorage *ms, double t, bool ignoreLoops, float &amountAlon
             // and we need to offset it by the starting point
             nt += ms->segmentStart[ls];
 
-            for (int i = 0; i < ms->n_activeSegments; ++i)
-                if (nt >= ms->segmentStart[i] && nt <= ms->segmentEnd[i])
-                {
-                    amountAlongSegment = nt - ms->segmentStart[i];
+            int i = segmentAt(ms, nt, true, hint);
 
-                    return i;
-                }
+            if (i >= 0)
+            {
+                amountAlongSegment = nt - ms->segmentStart[i];
+
+                return i;
+            }
         }
 
         return 0;
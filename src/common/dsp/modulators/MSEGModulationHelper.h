@@ -65,7 +65,9 @@ float valueAt(int phaseIntPart, float phaseFracPart, float deform, MSEGStorage *
 ** Edit and Utility functions. After the call to all of these you will want to rebuild cache
 */
 int timeToSegment(MSEGStorage *ms, double t); // these are double to deal with very long phases
-int timeToSegment(MSEGStorage *ms, double t, bool ignoreLoops, float &timeAlongSegment);
+// hint is the segment the lookup is expected to land in (or the one before), or -1 if unknown
+int timeToSegment(MSEGStorage *ms, double t, bool ignoreLoops, float &timeAlongSegment,
+                  int hint = -1);
 void changeTypeAt(MSEGStorage *ms, float t, MSEGStorage::segment::Type type);
 void insertAfter(MSEGStorage *ms, float t);
 void insertBefore(MSEGStorage *ms, float t);
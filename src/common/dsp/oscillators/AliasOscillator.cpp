@@ -82,16 +82,37 @@ void AliasOscillator::init(float pitch, bool is_display, bool nonzero_init_drift
     {
         unisonOffsets[u] = us.detune(u);
         us.attenuatedPanLaw(u, mixL[u], mixR[u]);
+    }
+
+    charFilt.init(storage->getPatch().character.val.i);
+
+    initVoice(pitch, is_display, nonzero_init_drift);
+}
 
+void AliasOscillator::initVoice(float pitch, bool is_display, bool nonzero_init_drift)
+{
+    for (int u = 0; u < n_unison; ++u)
+    {
         phase[u] = oscdata->retrigger.val.b || is_display ? 0.f : storage->rand_u32();
 
         driftLFO[u].init(nonzero_init_drift);
-        // Seed the RNGs in display mode
+        // Seed the RNGs in display mode, and give each voice its own otherwise
         if (is_display)
             urng8[u].a = 73;
+        else
+            urng8[u] = UInt8RNG();
     }
+}
 
-    charFilt.init(storage->getPatch().character.val.i);
+Oscillator *AliasOscillator::cloneInto(unsigned char *onto, pdata *localcopy) const
+{
+    return cloneAs<AliasOscillator>(onto, localcopy);
+}
+
+uint64_t AliasOscillator::prototypeKey() const
+{
+    return prototypeKeyFrom({storage->dsamplerate_os, (double)storage->getPatch().character.val.i,
+                             (double)oscdata->p[ao_unison_voices].val.i});
 }
 
 template <typename T> inline T localClamp(const T &a, const T &l, const T &h)
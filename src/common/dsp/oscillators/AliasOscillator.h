@@ -81,6 +81,9 @@ class AliasOscillator : public Oscillator
     }
 
     virtual void init(float pitch, bool is_display = false, bool nonzero_init_drift = true);
+    virtual void initVoice(float pitch, bool is_display, bool nonzero_init_drift);
+    virtual Oscillator *cloneInto(unsigned char *onto, pdata *localcopy) const;
+    virtual uint64_t prototypeKey() const;
     virtual void init_ctrltypes(int scene, int oscnum) { init_ctrltypes(); };
     virtual void init_ctrltypes();
     virtual void init_default_values();
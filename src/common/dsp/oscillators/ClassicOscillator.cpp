@@ -185,6 +185,7 @@ void ClassicOscillator::init(float pitch, bool is_display, bool nonzero_init_dri
     assert(storage);
     first_run = true;
     charFilt.init(storage->getPatch().character.val.i);
+    kernels = &Surge::Oscillator::activeBlitKernels();
 
     osc_out = _mm_set1_ps(0.f);
     osc_out2 = _mm_set1_ps(0.f);
@@ -222,6 +223,11 @@ void ClassicOscillator::init(float pitch, bool is_display, bool nonzero_init_dri
     memset(last_level, 0, MAX_UNISON * sizeof(float));
     memset(elapsed_time, 0, MAX_UNISON * sizeof(float));
 
+    initVoice(pitch, is_display, nonzero_init_drift);
+}
+
+void ClassicOscillator::initVoice(float pitch, bool is_display, bool nonzero_init_drift)
+{
     this->pitch = pitch;
     update_lagvals<true>();
 
@@ -251,6 +257,18 @@ void ClassicOscillator::init(float pitch, bool is_display, bool nonzero_init_dri
     }
 }
 
+Oscillator *ClassicOscillator::cloneInto(unsigned char *onto, pdata *localcopy) const
+{
+    return cloneAs<ClassicOscillator>(onto, localcopy);
+}
+
+uint64_t ClassicOscillator::prototypeKey() const
+{
+    return prototypeKeyFrom({storage->dsamplerate_os, (double)storage->getPatch().character.val.i,
+                             (double)oscdata->p[co_unison_voices].val.i,
+                             (double)Surge::CPUFeatures::activeSIMDLevel()});
+}
+
 void ClassicOscillator::init_ctrltypes()
 {
     oscdata->p[co_shape].set_name("Shape");
@@ -383,10 +401,7 @@ template <bool FM> void ClassicOscillator::convolute(int voice, bool stereo)
     */
     unsigned int m = ((ipos >> 16) & 0xff) * (FIRipol_N << 1);
     unsigned int lipolui16 = (ipos & 0xffff);
-    __m128 lipol128 = _mm_cvtsi32_ss(lipol128, lipolui16);
-    lipol128 = _mm_shuffle_ps(lipol128, lipol128, _MM_SHUFFLE(0, 0, 0, 0));
 
-    int k;
     const float s = 0.99952f;
     float sync = min((float)l_sync.v, (12 + 72 + 72) - pitch);
     float t;
@@ -492,51 +507,21 @@ template <bool FM> void ClassicOscillator::convolute(int voice, bool stereo)
         g *= panL[voice];
     }
 
+    /*
+    ** And this is the convolution described above, in whichever SIMD flavor
+    ** init() picked for this machine
+    */
+    const float *sinc = &storage->sinctable[m];
+    float lipol = (float)lipolui16;
+
     if (stereo)
     {
-        __m128 g128L = _mm_load_ss(&g);
-        g128L = _mm_shuffle_ps(g128L, g128L, _MM_SHUFFLE(0, 0, 0, 0));
-        __m128 g128R = _mm_load_ss(&gR);
-        g128R = _mm_shuffle_ps(g128R, g128R, _MM_SHUFFLE(0, 0, 0, 0));
-
-        for (k = 0; k < FIRipol_N; k += 4)
-        {
-            float *obfL = &oscbuffer[bufpos + k + delay];
-            float *obfR = &oscbufferR[bufpos + k + delay];
-            __m128 obL = _mm_loadu_ps(obfL);
-            __m128 obR = _mm_loadu_ps(obfR);
-            __m128 st = _mm_load_ps(&storage->sinctable[m + k]);
-            __m128 so = _mm_load_ps(&storage->sinctable[m + k + FIRipol_N]);
-            so = _mm_mul_ps(so, lipol128);
-            st = _mm_add_ps(st, so);
-            obL = _mm_add_ps(obL, _mm_mul_ps(st, g128L));
-            _mm_storeu_ps(obfL, obL);
-            obR = _mm_add_ps(obR, _mm_mul_ps(st, g128R));
-            _mm_storeu_ps(obfR, obR);
-        }
+        kernels->convolveStereo(&oscbuffer[bufpos + delay], &oscbufferR[bufpos + delay], sinc,
+                                lipol, g, gR);
     }
     else
     {
-        /*
-        ** This is SSE for the convolution described above
-        */
-        __m128 g128 = _mm_load_ss(&g);
-        g128 = _mm_shuffle_ps(g128, g128, _MM_SHUFFLE(0, 0, 0, 0));
-
-        for (k = 0; k < FIRipol_N; k += 4)
-        {
-            float *obf = &oscbuffer[bufpos + k + delay]; // Get buffer[pos + delay + k ]
-            __m128 ob = _mm_loadu_ps(obf);
-            __m128 st = _mm_load_ps(
-                &storage->sinctable[m + k]); // get the sinctable for our fractional position
-            __m128 so =
-                _mm_load_ps(&storage->sinctable[m + k + FIRipol_N]); // get the sinctable deriv
-            so = _mm_mul_ps(so, lipol128); // scale the deriv by the lipol fractional time
-            st = _mm_add_ps(st, so);       // this is now st = sinctable + dt * dsinctable
-            st = _mm_mul_ps(st, g128);     // so this is now the convolved difference, g * kernel
-            ob = _mm_add_ps(ob, st);       // which we add back onto the buffer
-            _mm_storeu_ps(obf, ob);        // and store.
-        }
+        kernels->convolve(&oscbuffer[bufpos + delay], sinc, lipol, g);
     }
 
     float olddc = dc_uni[voice];
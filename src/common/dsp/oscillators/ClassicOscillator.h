@@ -27,6 +27,7 @@
 #include "DSPUtils.h"
 #include <vembertech/lipol.h>
 #include "BiquadFilter.h"
+#include "OscillatorSIMDKernels.h"
 
 class ClassicOscillator : public AbstractBlitOscillator
 {
@@ -45,6 +46,9 @@ class ClassicOscillator : public AbstractBlitOscillator
     ClassicOscillator(SurgeStorage *storage, OscillatorStorage *oscdata, pdata *localcopy);
     virtual void init(float pitch, bool is_display = false,
                       bool nonzero_init_drift = true) override;
+    void initVoice(float pitch, bool is_display, bool nonzero_init_drift) override;
+    Oscillator *cloneInto(unsigned char *onto, pdata *localcopy) const override;
+    uint64_t prototypeKey() const override;
     virtual void init_ctrltypes() override;
     virtual void init_default_values() override;
     virtual void process_block(float pitch, float drift = 0.f, bool stereo = false, bool FM = false,
@@ -65,6 +69,7 @@ class ClassicOscillator : public AbstractBlitOscillator
     float FMmul_inv;
     float FMphase alignas(16)[BLOCK_SIZE_OS + 4];
     Surge::Oscillator::CharacterFilter<float> charFilt;
+    const Surge::Oscillator::BlitKernels *kernels{nullptr};
 };
 
 #endif // SURGE_SRC_COMMON_DSP_OSCILLATORS_CLASSICOSCILLATOR_H
@@ -43,8 +43,8 @@ void FM2Oscillator::init(float pitch, bool is_display, bool nonzero_init_drift)
     fb_val = 0.0;
     fb_mode = 0;
     double ph = (localcopy[oscdata->p[fm2_m12phase].param_id_in_scene].f + phase) * 2.0 * M_PI;
-    RM1.set_phase(ph);
-    RM2.set_phase(ph);
+    RM.set_phase(0, ph);
+    RM.set_phase(1, ph);
     phase = -sin(ph) * (calcmd(localcopy[oscdata->p[fm2_m1amount].param_id_in_scene].f) +
                         calcmd(localcopy[oscdata->p[fm2_m2amount].param_id_in_scene].f)) -
             ph;
@@ -89,12 +89,9 @@ void FM2Oscillator::process_block_internal(float pitch, float drift, float fmdep
     fb_val = oscdata->p[fm2_feedback].get_extended(
         localcopy[oscdata->p[fm2_feedback].param_id_in_scene].f);
 
-    RM1.set_rate(
-        min(M_PI,
-            (double)pitch_to_omega(pitch + driftlfo) * (double)oscdata->p[fm2_m1ratio].val.i + sh));
-    RM2.set_rate(
-        min(M_PI,
-            (double)pitch_to_omega(pitch + driftlfo) * (double)oscdata->p[fm2_m2ratio].val.i - sh));
+    double w = pitch_to_omega(pitch + driftlfo);
+    RM.set_rate(0, min(M_PI, w * (double)oscdata->p[fm2_m1ratio].val.i + sh));
+    RM.set_rate(1, min(M_PI, w * (double)oscdata->p[fm2_m2ratio].val.i - sh));
 
     double d1 = localcopy[oscdata->p[fm2_m1amount].param_id_in_scene].f;
     double d2 = localcopy[oscdata->p[fm2_m2amount].param_id_in_scene].f;
@@ -107,23 +104,27 @@ void FM2Oscillator::process_block_internal(float pitch, float drift, float fmdep
     if (FM)
         FMdepth.newValue(32.0 * M_PI * fmdepth * fmdepth * fmdepth);
 
+    /*
+     * The carrier's feedback makes each sample depend on the last, so first run the
+     * modulators (side by side in one register) and the lags to get the carrier phase for
+     * the block, then let fmCarrierBlock take the sines.
+     */
+    bool feedback = !(fb_val == 0 && FeedbackDepth.v == 0);
+    double carrierPhase[BLOCK_SIZE_OS], fbDepth[BLOCK_SIZE_OS];
+    float mr alignas(16)[4];
+    auto rm = RM.load();
+
     for (int k = 0; k < BLOCK_SIZE_OS; k++)
     {
-        RM1.process();
-        RM2.process();
-
-        double avg = mode == 1 ? ((oldout1 + oldout2) / 2.0) : oldout1;
-        double fb_amt = (fb_val < 0) ? avg * avg * FeedbackDepth.v : avg * FeedbackDepth.v;
+        rm.process();
+        _mm_store_ps(mr, rm.r);
 
-        output[k] =
-            phase + RelModDepth1.v * RM1.r + RelModDepth2.v * RM2.r + fb_amt + PhaseOffset.v;
+        carrierPhase[k] = phase + RelModDepth1.v * mr[0] + RelModDepth2.v * mr[1] + PhaseOffset.v;
 
         if (FM)
-            output[k] += FMdepth.v * master_osc[k];
+            carrierPhase[k] += FMdepth.v * master_osc[k];
 
-        oldout2 = oldout1;
-        oldout1 = sin(output[k]);
-        output[k] = oldout1;
+        fbDepth[k] = FeedbackDepth.v;
 
         phase += omega;
 
@@ -139,6 +140,11 @@ void FM2Oscillator::process_block_internal(float pitch, float drift, float fmdep
             FMdepth.process();
     }
 
+    RM.store(rm);
+
+    Surge::Oscillator::fmCarrierBlock<mode>(carrierPhase, fbDepth, feedback, fb_val < 0, oldout1,
+                                            oldout2, output);
+
     if (stereo)
     {
         memcpy(outputR, output, sizeof(float) * BLOCK_SIZE_OS);
@@ -28,7 +28,6 @@
 #include <vembertech/lipol.h>
 #include "BiquadFilter.h"
 #include "OscillatorCommonFunctions.h"
-#include "sst/basic-blocks/dsp/QuadratureOscillators.h"
 
 class FM2Oscillator : public Oscillator
 {
@@ -60,9 +59,8 @@ class FM2Oscillator : public Oscillator
 
     double phase, oldout1, oldout2;
 
-    using quadr_osc = sst::basic_blocks::dsp::SurgeQuadrOsc<float>;
-
-    quadr_osc RM1, RM2;
+    // the two modulators, M1 in lane 0 and M2 in lane 1
+    Surge::Oscillator::QuadrOscSSE RM;
     Surge::Oscillator::DriftLFO driftLFO;
     float fb_val;
     int fb_mode;
@@ -40,9 +40,9 @@ void FM3Oscillator::init(float pitch, bool is_display, bool nonzero_init_drift)
     driftLFO.init(nonzero_init_drift);
     fb_val = 0.f;
     fb_mode = 0;
-    AM.set_phase(phase);
-    RM1.set_phase(phase);
-    RM2.set_phase(phase);
+    RM.set_phase(0, phase);
+    RM.set_phase(1, phase);
+    RM.set_phase(2, phase);
 }
 
 FM3Oscillator::~FM3Oscillator() {}
@@ -94,11 +94,11 @@ void FM3Oscillator::process_block_internal(float pitch, float drift, float fmdep
         float bpv = (f - 16.0) / 16.0;
         auto note = 69 + 69 * bpv;
 
-        RM1.set_rate(min(M_PI, (double)pitch_to_omega(note)));
+        RM.set_rate(0, min(M_PI, (double)pitch_to_omega(note)));
     }
     else
     {
-        RM1.set_rate(min(M_PI, (double)pitch_to_omega(pitch + driftlfo) * m1));
+        RM.set_rate(0, min(M_PI, (double)pitch_to_omega(pitch + driftlfo) * m1));
     }
 
     auto m2 = oscdata->p[fm3_m2ratio].get_extended(
@@ -115,15 +115,15 @@ void FM3Oscillator::process_block_internal(float pitch, float drift, float fmdep
         float bpv = (f - 16.0) / 16.0;
         auto note = 69 + 69 * bpv;
 
-        RM2.set_rate(min(M_PI, (double)pitch_to_omega(note)));
+        RM.set_rate(1, min(M_PI, (double)pitch_to_omega(note)));
     }
     else
     {
-        RM2.set_rate(min(M_PI, (double)pitch_to_omega(pitch + driftlfo) * m2));
+        RM.set_rate(1, min(M_PI, (double)pitch_to_omega(pitch + driftlfo) * m2));
     }
 
-    AM.set_rate(min(M_PI, (double)pitch_to_omega(
-                              60.0 + localcopy[oscdata->p[fm3_m3freq].param_id_in_scene].f)));
+    RM.set_rate(2, min(M_PI, (double)pitch_to_omega(
+                                 60.0 + localcopy[oscdata->p[fm3_m3freq].param_id_in_scene].f)));
 
     double d1 = localcopy[oscdata->p[fm3_m1amount].param_id_in_scene].f;
     double d2 = localcopy[oscdata->p[fm3_m2amount].param_id_in_scene].f;
@@ -140,26 +140,26 @@ void FM3Oscillator::process_block_internal(float pitch, float drift, float fmdep
 
     FeedbackDepth.newValue(abs(fb_val));
 
+    // As in FM2, the operators and lags first, then the carrier sines in fmCarrierBlock
+    bool feedback = !(fb_val == 0 && FeedbackDepth.v == 0);
+    double carrierPhase[BLOCK_SIZE_OS], fbDepth[BLOCK_SIZE_OS];
+    float mr alignas(16)[4];
+    auto rm = RM.load();
+
     for (int k = 0; k < BLOCK_SIZE_OS; k++)
     {
-        RM1.process();
-        RM2.process();
-        AM.process();
-
-        double avg = mode == 1 ? ((oldout1 + oldout2) / 2.0) : oldout1;
-        double fb_amt = (fb_val < 0) ? avg * avg * FeedbackDepth.v : avg * FeedbackDepth.v;
+        rm.process();
+        _mm_store_ps(mr, rm.r);
 
-        output[k] =
-            phase + RelModDepth1.v * RM1.r + RelModDepth2.v * RM2.r + AbsModDepth.v * AM.r + fb_amt;
+        carrierPhase[k] =
+            phase + RelModDepth1.v * mr[0] + RelModDepth2.v * mr[1] + AbsModDepth.v * mr[2];
 
         if (FM)
         {
-            output[k] += FMdepth.v * master_osc[k];
+            carrierPhase[k] += FMdepth.v * master_osc[k];
         }
 
-        oldout2 = oldout1;
-        oldout1 = sin(output[k]);
-        output[k] = oldout1;
+        fbDepth[k] = FeedbackDepth.v;
 
         phase += omega;
 
@@ -180,6 +180,11 @@ void FM3Oscillator::process_block_internal(float pitch, float drift, float fmdep
         FeedbackDepth.process();
     }
 
+    RM.store(rm);
+
+    Surge::Oscillator::fmCarrierBlock<mode>(carrierPhase, fbDepth, feedback, fb_val < 0, oldout1,
+                                            oldout2, output);
+
     if (stereo)
     {
         memcpy(outputR, output, sizeof(float) * BLOCK_SIZE_OS);
@@ -28,7 +28,6 @@
 #include <vembertech/lipol.h>
 #include "BiquadFilter.h"
 #include "OscillatorCommonFunctions.h"
-#include "sst/basic-blocks/dsp/QuadratureOscillators.h"
 
 class FM3Oscillator : public Oscillator
 {
@@ -58,9 +57,8 @@ class FM3Oscillator : public Oscillator
 
     double phase, oldout1, oldout2;
 
-    using quadr_osc = sst::basic_blocks::dsp::SurgeQuadrOsc<float>;
-
-    quadr_osc RM1, RM2, AM;
+    // the three modulators, M1 in lane 0, M2 in lane 1 and M3 in lane 2
+    Surge::Oscillator::QuadrOscSSE RM;
     Surge::Oscillator::DriftLFO driftLFO;
     float fb_val;
     int fb_mode;
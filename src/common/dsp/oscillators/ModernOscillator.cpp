@@ -123,10 +123,6 @@
 
 void ModernOscillator::init(float pitch, bool is_display, bool nonzero_init_drift)
 {
-    // we need a tiny little portamento since the derivative is pretty
-    // unstable under super big pitch changes
-    pitchlag.setRate(0.5);
-    pitchlag.startValue(pitch);
     pwidth.setRate(0.001); // 4x slower
     sync.setRate(0.001 * BLOCK_SIZE_OS);
 
@@ -140,7 +136,26 @@ void ModernOscillator::init(float pitch, bool is_display, bool nonzero_init_drif
     {
         unisonOffsets[u] = us.detune(u);
         us.attenuatedPanLaw(u, mixL[u], mixR[u]);
+    }
+
+    subphase = 0;
+    subsphase = 0;
 
+    // This is the same implementation as ClassicOscillator, just as doubles
+    charFilt.init(storage->getPatch().character.val.i);
+
+    initVoice(pitch, is_display, nonzero_init_drift);
+}
+
+void ModernOscillator::initVoice(float pitch, bool is_display, bool nonzero_init_drift)
+{
+    // we need a tiny little portamento since the derivative is pretty
+    // unstable under super big pitch changes
+    pitchlag.setRate(0.5);
+    pitchlag.startValue(pitch);
+
+    for (int u = 0; u < n_unison; ++u)
+    {
         phase[u] =
             oscdata->retrigger.val.b || is_display ? pitch_to_dphase(pitch) : storage->rand_01();
         sphase[u] = phase[u];
@@ -152,12 +167,17 @@ void ModernOscillator::init(float pitch, bool is_display, bool nonzero_init_drif
 
         sReset[u] = false;
     }
+}
 
-    subphase = 0;
-    subsphase = 0;
+Oscillator *ModernOscillator::cloneInto(unsigned char *onto, pdata *localcopy) const
+{
+    return cloneAs<ModernOscillator>(onto, localcopy);
+}
 
-    // This is the same implementation as ClassicOscillator, just as doubles
-    charFilt.init(storage->getPatch().character.val.i);
+uint64_t ModernOscillator::prototypeKey() const
+{
+    return prototypeKeyFrom({storage->dsamplerate_os, (double)storage->getPatch().character.val.i,
+                             (double)oscdata->p[mo_unison_voices].val.i});
 }
 
 template <ModernOscillator::mo_multitypes multitype, bool subOctave, bool FM>
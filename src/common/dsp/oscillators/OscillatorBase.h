@@ -26,6 +26,9 @@
 #include "SurgeStorage.h"
 #include "OscillatorCommonFunctions.h"
 #include "sst/basic-blocks/dsp/Lag.h"
+#include <cstring>
+#include <initializer_list>
+#include <new>
 
 class alignas(16) Oscillator
 {
@@ -70,12 +73,44 @@ class alignas(16) Oscillator
 
     virtual void setGate(bool g) { gate = g; }
 
+    /*
+     * Oscillators which a voice can start by copying a fully initialized prototype (see
+     * OscillatorPrototype in Oscillator.h) split their init in two. initVoice is the part
+     * which differs from voice to voice (phases, drift, and anything which reads the pitch
+     * or the voice's modulated parameters) and init calls it last. cloneInto copies this
+     * oscillator onto a voice's buffer, and prototypeKey summarizes the patch state the
+     * rest of init depends on, so a stale prototype can be spotted and rebuilt.
+     */
+    virtual void initVoice(float pitch, bool is_display, bool nonzero_init_drift) {}
+    virtual Oscillator *cloneInto(unsigned char *onto, pdata *localcopy) const { return nullptr; }
+    virtual uint64_t prototypeKey() const { return 0; }
+
     virtual void handleStreamingMismatches(int streamingRevision, int currentSynthStreamingRevision)
     {
         // No-op here.
     }
 
   protected:
+    template <typename T> Oscillator *cloneAs(unsigned char *onto, pdata *localcopy) const
+    {
+        Oscillator *res = new (onto) T(*static_cast<const T *>(this));
+        res->localcopy = localcopy;
+        return res;
+    }
+
+    // FNV-1a over the bits of each input, which is plenty to tell patch states apart
+    static uint64_t prototypeKeyFrom(std::initializer_list<double> inputs)
+    {
+        uint64_t h = 14695981039346656037ULL;
+        for (auto d : inputs)
+        {
+            uint64_t b;
+            memcpy(&b, &d, sizeof(b));
+            h = (h ^ b) * 1099511628211ULL;
+        }
+        return h;
+    }
+
     SurgeStorage *storage;
     OscillatorStorage *oscdata;
     pdata *localcopy;
@@ -228,6 +228,146 @@ template <typename valtype> struct UnisonSetup
     double sqrt_uni, sqrt_uni_inv;
 };
 
+/*
+ * A four wide sine (and cosine) for the sinusoidal oscillators. The argument is reduced
+ * to [-pi, pi] with a two part 2 pi, folded into [-pi/2, pi/2] and fed to an odd degree 11
+ * minimax polynomial. For |x| <= 1e4 the absolute error is under 5e-7 (the "Oscillator
+ * Fast Sine" test checks this), which is float precision for the 1.0 scale outputs these
+ * feed. Past 2^31 * 2 pi the reduction overflows, so keep arguments well inside that.
+ */
+namespace FastSine
+{
+inline __m128 reduceToPi(__m128 x)
+{
+    const auto k = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.5 / M_PI))));
+    auto r = _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(6.28125f)));
+    return _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(2.0 * M_PI - 6.28125)));
+}
+
+inline __m128 foldToHalfPi(__m128 r)
+{
+    // sin(r) = sin(pi - r) above pi/2 and sin(-pi - r) below -pi/2
+    const auto signbit = _mm_set1_ps(-0.f);
+    auto signedPi = _mm_or_ps(_mm_set1_ps(M_PI), _mm_and_ps(r, signbit));
+    auto over = _mm_cmpgt_ps(_mm_andnot_ps(signbit, r), _mm_set1_ps(M_PI_2));
+    return _mm_or_ps(_mm_and_ps(over, _mm_sub_ps(signedPi, r)), _mm_andnot_ps(over, r));
+}
+
+inline __m128 sinHalfPi(__m128 r)
+{
+    const auto r2 = _mm_mul_ps(r, r);
+    auto p = _mm_set1_ps(-2.3868346521031027639830001794722295e-8f);
+    p = _mm_add_ps(_mm_mul_ps(p, r2), _mm_set1_ps(2.75239710746326498401791551303359689e-6f));
+    p = _mm_add_ps(_mm_mul_ps(p, r2), _mm_set1_ps(-1.98408328232619552901560108010257242e-4f));
+    p = _mm_add_ps(_mm_mul_ps(p, r2), _mm_set1_ps(8.33333072055773645376566203656709979e-3f));
+    p = _mm_add_ps(_mm_mul_ps(p, r2), _mm_set1_ps(-0.166666666088260696413164261885310067f));
+    p = _mm_add_ps(_mm_mul_ps(p, r2), _mm_set1_ps(0.99999999997884898600402426033768998f));
+    return _mm_mul_ps(p, r);
+}
+
+inline __m128 sin(__m128 x) { return sinHalfPi(foldToHalfPi(reduceToPi(x))); }
+
+inline void sincos(__m128 x, __m128 &s, __m128 &c)
+{
+    // the cosine is the sine a quarter turn on, which shares the reduction
+    auto r = reduceToPi(x);
+    s = sinHalfPi(foldToHalfPi(r));
+
+    auto rc = _mm_add_ps(r, _mm_set1_ps(M_PI_2));
+    rc = _mm_sub_ps(rc, _mm_and_ps(_mm_cmpgt_ps(rc, _mm_set1_ps(M_PI)), _mm_set1_ps(2.0 * M_PI)));
+    c = sinHalfPi(foldToHalfPi(rc));
+}
+
+inline float sin(float x) { return _mm_cvtss_f32(sin(_mm_set_ss(x))); }
+} // namespace FastSine
+
+/*
+ * Four quadrature oscillators, one per SSE lane, for oscillators which run several sine
+ * operators in lockstep. Each lane rotates like sst's SurgeQuadrOsc, so r is the sine of
+ * the phase and i is minus the cosine. Load the lanes into registers for a block, process
+ * them once per sample, and store them back at the end.
+ */
+struct QuadrOscSSE
+{
+    float r alignas(16)[4]{0, 0, 0, 0}, i alignas(16)[4]{-1, -1, -1, -1};
+    float dr alignas(16)[4]{1, 1, 1, 1}, di alignas(16)[4]{0, 0, 0, 0};
+
+    inline void set_rate(int lane, float w)
+    {
+        dr[lane] = std::cos(w);
+        di[lane] = std::sin(w);
+
+        // renormalize, since the rotation slowly drifts off the unit circle
+        float n = 1.f / std::sqrt(r[lane] * r[lane] + i[lane] * i[lane]);
+        r[lane] *= n;
+        i[lane] *= n;
+    }
+
+    inline void set_phase(int lane, float w)
+    {
+        r[lane] = std::sin(w);
+        i[lane] = -std::cos(w);
+    }
+
+    struct Lanes
+    {
+        __m128 r, i, dr, di;
+
+        inline void process()
+        {
+            auto lr = r;
+            r = _mm_sub_ps(_mm_mul_ps(dr, lr), _mm_mul_ps(di, i));
+            i = _mm_add_ps(_mm_mul_ps(dr, i), _mm_mul_ps(di, lr));
+        }
+    };
+
+    inline Lanes load() const
+    {
+        return {_mm_load_ps(r), _mm_load_ps(i), _mm_load_ps(dr), _mm_load_ps(di)};
+    }
+
+    inline void store(const Lanes &l)
+    {
+        _mm_store_ps(r, l.r);
+        _mm_store_ps(i, l.i);
+    }
+};
+
+/*
+ * The carrier of the FM2 and FM3 oscillators, output[k] = sin(phase[k] + fb), where fb is
+ * fbDepth[k] times the last output (the average of the last two in mode 1), squared when
+ * the feedback is negative. Without feedback the samples don't depend on each other, so
+ * those blocks take their sines four at a time.
+ */
+template <int mode>
+inline void fmCarrierBlock(const double *phase, const double *fbDepth, bool feedback,
+                           bool negativeFeedback, double &oldout1, double &oldout2, float *output)
+{
+    if (feedback)
+    {
+        for (int k = 0; k < BLOCK_SIZE_OS; ++k)
+        {
+            double avg = mode == 1 ? ((oldout1 + oldout2) / 2.0) : oldout1;
+            double fb_amt = negativeFeedback ? avg * avg * fbDepth[k] : avg * fbDepth[k];
+
+            oldout2 = oldout1;
+            oldout1 = FastSine::sin((float)(phase[k] + fb_amt));
+            output[k] = oldout1;
+        }
+
+        return;
+    }
+
+    for (int k = 0; k < BLOCK_SIZE_OS; k += 4)
+    {
+        auto x = _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(&phase[k])),
+                               _mm_cvtpd_ps(_mm_loadu_pd(&phase[k + 2])));
+        _mm_store_ps(&output[k], FastSine::sin(x));
+    }
+
+    oldout2 = output[BLOCK_SIZE_OS - 2];
+    oldout1 = output[BLOCK_SIZE_OS - 1];
+}
 } // namespace Oscillator
 } // namespace Surge
 
@@ -0,0 +1,135 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "OscillatorSIMDKernels.h"
+
+static_assert(FIRipol_N % 4 == 0, "BLIT kernels assume the FIR length is a multiple of 4");
+
+namespace Surge
+{
+namespace Oscillator
+{
+namespace SSE2
+{
+static void convolve(float *__restrict ob, const float *__restrict sinc, float lipol, float g)
+{
+    const auto lipol128 = _mm_set1_ps(lipol);
+    const auto g128 = _mm_set1_ps(g);
+
+    for (int k = 0; k < FIRipol_N; k += 4)
+    {
+        auto st = _mm_load_ps(&sinc[k]);             // the sinctable for our fractional position
+        auto so = _mm_load_ps(&sinc[k + FIRipol_N]); // and its derivative
+        so = _mm_mul_ps(so, lipol128);               // scaled by the fractional time
+        st = _mm_add_ps(st, so);                     // so st = sinctable + dt * dsinctable
+        st = _mm_mul_ps(st, g128);                   // the convolved difference, g * kernel
+        _mm_storeu_ps(&ob[k], _mm_add_ps(_mm_loadu_ps(&ob[k]), st)); // added onto the buffer
+    }
+}
+
+static void convolveStereo(float *__restrict obL, float *__restrict obR,
+                           const float *__restrict sinc, float lipol, float gL, float gR)
+{
+    const auto lipol128 = _mm_set1_ps(lipol);
+    const auto g128L = _mm_set1_ps(gL);
+    const auto g128R = _mm_set1_ps(gR);
+
+    for (int k = 0; k < FIRipol_N; k += 4)
+    {
+        auto st = _mm_load_ps(&sinc[k]);
+        auto so = _mm_load_ps(&sinc[k + FIRipol_N]);
+        so = _mm_mul_ps(so, lipol128);
+        st = _mm_add_ps(st, so);
+        _mm_storeu_ps(&obL[k], _mm_add_ps(_mm_loadu_ps(&obL[k]), _mm_mul_ps(st, g128L)));
+        _mm_storeu_ps(&obR[k], _mm_add_ps(_mm_loadu_ps(&obR[k]), _mm_mul_ps(st, g128R)));
+    }
+}
+} // namespace SSE2
+
+#if SURGE_SIMD_X86
+namespace AVX2
+{
+/*
+ * FIRipol_N is 12, so each impulse is one 8-wide and one 4-wide step. The sinctable rows
+ * are only 16 byte aligned, hence the unaligned 256 bit loads.
+ */
+SURGE_TARGET_AVX2 static void convolve(float *__restrict ob, const float *__restrict sinc,
+                                       float lipol, float g)
+{
+    int k = 0;
+
+    for (; k + 8 <= FIRipol_N; k += 8)
+    {
+        auto st = _mm256_fmadd_ps(_mm256_loadu_ps(&sinc[k + FIRipol_N]), _mm256_set1_ps(lipol),
+                                  _mm256_loadu_ps(&sinc[k]));
+        _mm256_storeu_ps(&ob[k], _mm256_fmadd_ps(st, _mm256_set1_ps(g), _mm256_loadu_ps(&ob[k])));
+    }
+
+    for (; k < FIRipol_N; k += 4)
+    {
+        auto st = _mm_fmadd_ps(_mm_load_ps(&sinc[k + FIRipol_N]), _mm_set1_ps(lipol),
+                               _mm_load_ps(&sinc[k]));
+        _mm_storeu_ps(&ob[k], _mm_fmadd_ps(st, _mm_set1_ps(g), _mm_loadu_ps(&ob[k])));
+    }
+}
+
+SURGE_TARGET_AVX2 static void convolveStereo(float *__restrict obL, float *__restrict obR,
+                                             const float *__restrict sinc, float lipol, float gL,
+                                             float gR)
+{
+    int k = 0;
+
+    for (; k + 8 <= FIRipol_N; k += 8)
+    {
+        auto st = _mm256_fmadd_ps(_mm256_loadu_ps(&sinc[k + FIRipol_N]), _mm256_set1_ps(lipol),
+                                  _mm256_loadu_ps(&sinc[k]));
+        _mm256_storeu_ps(&obL[k],
+                         _mm256_fmadd_ps(st, _mm256_set1_ps(gL), _mm256_loadu_ps(&obL[k])));
+        _mm256_storeu_ps(&obR[k],
+                         _mm256_fmadd_ps(st, _mm256_set1_ps(gR), _mm256_loadu_ps(&obR[k])));
+    }
+
+    for (; k < FIRipol_N; k += 4)
+    {
+        auto st = _mm_fmadd_ps(_mm_load_ps(&sinc[k + FIRipol_N]), _mm_set1_ps(lipol),
+                               _mm_load_ps(&sinc[k]));
+        _mm_storeu_ps(&obL[k], _mm_fmadd_ps(st, _mm_set1_ps(gL), _mm_loadu_ps(&obL[k])));
+        _mm_storeu_ps(&obR[k], _mm_fmadd_ps(st, _mm_set1_ps(gR), _mm_loadu_ps(&obR[k])));
+    }
+}
+} // namespace AVX2
+#endif
+
+const BlitKernels &blitKernelsFor(CPUFeatures::SIMDLevel l)
+{
+    static const BlitKernels sse2{SSE2::convolve, SSE2::convolveStereo};
+#if SURGE_SIMD_X86
+    static const BlitKernels avx2{AVX2::convolve, AVX2::convolveStereo};
+
+    if (l >= CPUFeatures::simd_avx2_fma)
+        return avx2;
+#endif
+
+    return sse2;
+}
+} // namespace Oscillator
+} // namespace Surge
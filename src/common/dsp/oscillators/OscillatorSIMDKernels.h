@@ -0,0 +1,62 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_DSP_OSCILLATORS_OSCILLATORSIMDKERNELS_H
+#define SURGE_SRC_COMMON_DSP_OSCILLATORS_OSCILLATORSIMDKERNELS_H
+
+#include "SurgeStorage.h"
+#include "CPUFeatures.h"
+
+namespace Surge
+{
+namespace Oscillator
+{
+/*
+ * The inner loops of the BLIT oscillators, with one implementation per SIMD level.
+ *
+ * convolve adds a windowed sinc impulse of height g into an oscillator buffer, namely
+ *
+ *     ob[k] += g * (sinc[k] + lipol * sinc[k + FIRipol_N])   for k in [0, FIRipol_N)
+ *
+ * where sinc points at the appropriate row of storage->sinctable (which interleaves the
+ * window and its derivative; see the comment atop ClassicOscillator.cpp) and lipol is the
+ * 0..0xffff fractional position. ob is unaligned, sinc is 16 byte aligned.
+ *
+ * The SSE2 versions are bit-identical to the loops they replaced. The AVX2 versions use
+ * FMA and so round differently, at the level of a float ulp per tap.
+ */
+struct BlitKernels
+{
+    void (*convolve)(float *__restrict ob, const float *__restrict sinc, float lipol, float g);
+    void (*convolveStereo)(float *__restrict obL, float *__restrict obR,
+                           const float *__restrict sinc, float lipol, float gL, float gR);
+};
+
+const BlitKernels &blitKernelsFor(CPUFeatures::SIMDLevel l);
+inline const BlitKernels &activeBlitKernels()
+{
+    return blitKernelsFor(CPUFeatures::activeSIMDLevel());
+}
+} // namespace Oscillator
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_DSP_OSCILLATORS_OSCILLATORSIMDKERNELS_H
@@ -97,6 +97,13 @@ void SineOscillator::prepare_unison(int voices)
         us.panLaw(v, panL[v], panR[v]);
     }
 
+    // the lanes past the last voice run along in the SSE code, but mustn't be heard
+    for (int v = voices; v < MAX_UNISON; ++v)
+    {
+        panL[v] = 0.f;
+        panR[v] = 0.f;
+    }
+
     // normalize to be sample rate independent amount of time for 50 44.1k samples
     dplaying = 1.0 / 50.0 * 44100 / storage->samplerate;
     playingramp[0] = 1;
@@ -116,18 +123,13 @@ void SineOscillator::init(float pitch, bool is_display, bool nonzero_init_drift)
 
     prepare_unison(n_unison);
 
-    for (int i = 0; i < n_unison; i++)
+    for (int i = n_unison; i < MAX_UNISON; i++)
     {
-        phase[i] = // phase in range -PI to PI
-            (oscdata->retrigger.val.b || is_display) ? 0.f : 2.0 * M_PI * storage->rand_01() - M_PI;
+        phase[i] = 0.0;
         lastvalue[0][i] = 0.f;
         lastvalue[1][i] = 0.f;
-        driftLFO[i].init(nonzero_init_drift);
-        sine[i].set_phase(phase[i]);
     }
 
-    firstblock = (oscdata->retrigger.val.b || is_display);
-
     fb_val = 0.f;
 
     id_mode = oscdata->p[sine_shape].param_id_in_scene;
@@ -142,6 +144,35 @@ void SineOscillator::init(float pitch, bool is_display, bool nonzero_init_drift)
     lp.coeff_LP2B(lp.calc_omega(oscdata->p[sine_highcut].val.f / 12.0) / OSC_OVERSAMPLING, 0.707);
 
     charFilt.init(storage->getPatch().character.val.i);
+
+    initVoice(pitch, is_display, nonzero_init_drift);
+}
+
+void SineOscillator::initVoice(float pitch, bool is_display, bool nonzero_init_drift)
+{
+    for (int i = 0; i < n_unison; i++)
+    {
+        phase[i] = // phase in range -PI to PI
+            (oscdata->retrigger.val.b || is_display) ? 0.f : 2.0 * M_PI * storage->rand_01() - M_PI;
+        lastvalue[0][i] = 0.f;
+        lastvalue[1][i] = 0.f;
+        driftLFO[i].init(nonzero_init_drift);
+        sine[i].set_phase(phase[i]);
+    }
+
+    firstblock = (oscdata->retrigger.val.b || is_display);
+}
+
+Oscillator *SineOscillator::cloneInto(unsigned char *onto, pdata *localcopy) const
+{
+    return cloneAs<SineOscillator>(onto, localcopy);
+}
+
+uint64_t SineOscillator::prototypeKey() const
+{
+    return prototypeKeyFrom({storage->dsamplerate_os, (double)storage->getPatch().character.val.i,
+                             (double)oscdata->p[sine_unison_voices].val.i,
+                             oscdata->p[sine_lowcut].val.f, oscdata->p[sine_highcut].val.f});
 }
 
 SineOscillator::~SineOscillator() {}
@@ -593,7 +624,7 @@ template <int mode, bool stereo, bool FM>
 void SineOscillator::process_block_internal(float pitch, float drift, float fmdepth)
 {
     double detune;
-    double omega[MAX_UNISON];
+    double omega[MAX_UNISON]{}; // the unused lanes stand still
 
     for (int l = 0; l < n_unison; l++)
     {
@@ -630,15 +661,6 @@ void SineOscillator::process_block_internal(float pitch, float drift, float fmde
     FMdepth.newValue(fv);
     FB.newValue(fb_val);
 
-    float p alignas(16)[MAX_UNISON];
-    float sx alignas(16)[MAX_UNISON];
-    float cx alignas(16)[MAX_UNISON];
-    float olv alignas(16)[MAX_UNISON];
-    float orv alignas(16)[MAX_UNISON];
-
-    for (int i = 0; i < MAX_UNISON; ++i)
-        p[i] = 0.0;
-
     auto outattensse = _mm_set1_ps(out_attenuation);
     __m128 playramp[4], dramp[4];
     if (firstblock)
@@ -678,9 +700,11 @@ void SineOscillator::process_block_internal(float pitch, float drift, float fmde
         fb1weight = _mm_set1_ps(0.5f);
     }
 
+    const auto pi = _mm_set1_pd(M_PI), twoPi = _mm_set1_pd(2.0 * M_PI);
+
     for (int k = 0; k < BLOCK_SIZE_OS; k++)
     {
-        float outL = 0.f, outR = 0.f;
+        auto sumL = _mm_setzero_ps(), sumR = _mm_setzero_ps();
 
         float fmpd = FM ? FMdepth.v * master_osc[k] : 0.f;
         auto fmpds = _mm_set1_ps(fmpd);
@@ -689,9 +713,8 @@ void SineOscillator::process_block_internal(float pitch, float drift, float fmde
 
         for (int u = 0; u < n_unison; u += 4)
         {
-            float fph alignas(16)[4] = {(float)phase[u], (float)phase[u + 1], (float)phase[u + 2],
-                                        (float)phase[u + 3]};
-            auto ph = _mm_load_ps(&fph[0]);
+            auto ph = _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(&phase[u])),
+                                    _mm_cvtpd_ps(_mm_loadu_pd(&phase[u + 2])));
             auto lv0 = _mm_load_ps(&lastvalue[0][u]);
             auto lv1 = _mm_load_ps(&lastvalue[1][u]);
 
@@ -701,10 +724,8 @@ void SineOscillator::process_block_internal(float pitch, float drift, float fmde
                 fbv);
             auto x = _mm_add_ps(_mm_add_ps(ph, fba), fmpds);
 
-            x = sst::basic_blocks::dsp::clampToPiRangeSSE(x);
-
-            auto sxl = sst::basic_blocks::dsp::fastsinSSE(x);
-            auto cxl = sst::basic_blocks::dsp::fastcosSSE(x);
+            __m128 sxl, cxl;
+            Surge::Oscillator::FastSine::sincos(x, sxl, cxl);
 
             auto out_local = valueFromSinAndCosForMode<mode>(sxl, cxl, std::min(n_unison - u, 4));
 
@@ -718,23 +739,24 @@ void SineOscillator::process_block_internal(float pitch, float drift, float fmde
 
             auto l = _mm_mul_ps(_mm_mul_ps(pl, olpr), outattensse);
             auto r = _mm_mul_ps(_mm_mul_ps(pr, olpr), outattensse);
-            _mm_store_ps(&olv[u], l);
-            _mm_store_ps(&orv[u], r);
+            sumL = _mm_add_ps(sumL, l);
+            sumR = _mm_add_ps(sumR, r);
 
             _mm_store_ps(&lastvalue[0][u], lv1);
             _mm_store_ps(&lastvalue[1][u], out_local);
-        }
 
-        for (int u = 0; u < n_unison; ++u)
-        {
-            outL += olv[u];
-            outR += orv[u];
-
-            // These are doubles and need to be so keep it unrolled
-            phase[u] += omega[u];
-            phase[u] -= (phase[u] > M_PI) * 2.0 * M_PI;
+            // These are doubles and need to be, so two to a register
+            for (int d = 0; d < 4; d += 2)
+            {
+                auto phd = _mm_add_pd(_mm_loadu_pd(&phase[u + d]), _mm_loadu_pd(&omega[u + d]));
+                phd = _mm_sub_pd(phd, _mm_and_pd(_mm_cmpgt_pd(phd, pi), twoPi));
+                _mm_storeu_pd(&phase[u + d], phd);
+            }
         }
 
+        float outL = _mm_cvtss_f32(mech::sum_ps_to_ss(sumL));
+        float outR = _mm_cvtss_f32(mech::sum_ps_to_ss(sumR));
+
         FMdepth.process();
         FB.process();
 
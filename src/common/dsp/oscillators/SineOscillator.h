@@ -47,6 +47,9 @@ class SineOscillator : public Oscillator
     SineOscillator(SurgeStorage *storage, OscillatorStorage *oscdata, pdata *localcopy);
     virtual void init(float pitch, bool is_display = false,
                       bool nonzero_init_drift = true) override;
+    void initVoice(float pitch, bool is_display, bool nonzero_init_drift) override;
+    Oscillator *cloneInto(unsigned char *onto, pdata *localcopy) const override;
+    uint64_t prototypeKey() const override;
     virtual void process_block(float pitch, float drift = 0.f, bool stereo = false, bool FM = false,
                                float FMdepth = 0.f) override;
     template <int mode, bool stereo, bool FM>
@@ -88,44 +88,185 @@ std::string stringosc_excitation_name(int i)
     return "Unknown";
 }
 
-StringOscillator::~StringOscillator()
+template <typename F> void StringOscillator::withDelayLines(F &&f)
 {
-    if (storage && !ownDelayLines)
+    switch (delayTier)
     {
-        if (delayLine[0])
-            storage->memoryPools->stringDelayLines.returnItem(delayLine[0]);
-        if (delayLine[1])
-            storage->memoryPools->stringDelayLines.returnItem(delayLine[1]);
+    case delay_short:
+        f(delayLineShort);
+        break;
+    case delay_medium:
+        f(delayLineMedium);
+        break;
+    case delay_long:
+        f(delayLineLong);
+        break;
     }
-    else
+}
+
+template <typename DL> void StringOscillator::acquireDelayLines(std::array<DL *, 2> &dl)
+{
+    for (auto &d : dl)
     {
-        if (delayLine[0])
-            delete delayLine[0];
-        if (delayLine[1])
-            delete delayLine[1];
+        if (ownDelayLines)
+            d = new DL(storage->sinctable);
+        else
+            d = storage->memoryPools->stringDelayLines<DL>().getItem(storage->sinctable);
     }
-};
+}
 
-void StringOscillator::init(float pitch, bool is_display, bool nzi)
+template <typename DL> void StringOscillator::releaseDelayLines(std::array<DL *, 2> &dl)
 {
-    // fixme - alloc in is_display but for now just deal with the race
-    // delayLine[0] = std::make_unique<SSESincDelayLine<16384>>();
-    // delayLine[1] = std::make_unique<SSESincDelayLine<16384>>();
-    if (is_display)
+    for (auto &d : dl)
     {
-        ownDelayLines = true;
-        delayLine[0] = new SSESincDelayLine<16384>(storage->sinctable);
-        delayLine[1] = new SSESincDelayLine<16384>(storage->sinctable);
+        if (!d)
+            continue;
+
+        if (storage && !ownDelayLines)
+            storage->memoryPools->stringDelayLines<DL>().returnItem(d);
+        else
+            delete d;
+
+        d = nullptr;
     }
-    else
+}
+
+void StringOscillator::releaseAllDelayLines()
+{
+    releaseDelayLines(delayLineShort);
+    releaseDelayLines(delayLineMedium);
+    releaseDelayLines(delayLineLong);
+}
+
+template <typename F> auto StringOscillator::onDelayLine(int t, F &&f)
+{
+    switch (delayTier)
+    {
+    case delay_short:
+        return f(delayLineShort[t]);
+    case delay_medium:
+        return f(delayLineMedium[t]);
+    default:
+        return f(delayLineLong[t]);
+    }
+}
+
+StringOscillator::~StringOscillator() { releaseAllDelayLines(); }
+
+template <typename DL> static constexpr double maxDelayTaps() { return DL::comb_size - 100; }
+
+StringOscillator::delay_tiers StringOscillator::tierForDelay(double taps)
+{
+    if (taps < maxDelayTaps<delayShort_t>())
+        return delay_short;
+    if (taps < maxDelayTaps<delayMedium_t>())
+        return delay_medium;
+    return delay_long;
+}
+
+StringOscillator::delay_tiers StringOscillator::initialDelayTier(double pitchmult_inv,
+                                                                 double pitchmult2_inv)
+{
+    /*
+     * Pick the shortest line which fits the lowest pitch this voice is likely to play: an
+     * octave below where it starts, less the pitch bend down range and the depth of whatever
+     * modulates the scene or oscillator pitch. An FM modulated string can stretch its delay
+     * fifty-fold, so it always gets the long line. Should a voice go lower anyway,
+     * ensureDelayCapacity moves it to a longer line.
+     */
+    auto &patch = storage->getPatch();
+    float bendDown = 0, modDown = 0;
+
+    for (int s = 0; s < n_scenes; ++s)
     {
-        ownDelayLines = false;
-        if (!delayLine[0])
-            delayLine[0] = storage->memoryPools->stringDelayLines.getItem(storage->sinctable);
-        if (!delayLine[1])
-            delayLine[1] = storage->memoryPools->stringDelayLines.getItem(storage->sinctable);
+        for (int o = 0; o < n_oscs; ++o)
+        {
+            if (&patch.scene[s].osc[o] != oscdata)
+                continue;
+
+            auto &scene = patch.scene[s];
+            auto fm = scene.fm_switch.val.i;
+
+            if ((o == 0 && fm != fm_off) || (o == 1 && fm == fm_3to2to1))
+                return delay_long;
+
+            bendDown = scene.pbrange_dn.val.i;
+
+            for (auto *routings : {&scene.modulation_voice, &scene.modulation_scene})
+            {
+                for (const auto &r : *routings)
+                {
+                    if (r.muted)
+                        continue;
+
+                    if (r.destination_id == scene.pitch.param_id_in_scene)
+                    {
+                        modDown += fabs(r.depth) * (scene.pitch.extend_range ? 12.f : 1.f);
+                    }
+                    else if (r.destination_id == oscdata->pitch.param_id_in_scene)
+                    {
+                        // an absolute pitch offset is in Hz, which can take us anywhere
+                        if (oscdata->pitch.absolute)
+                            return delay_long;
+
+                        modDown += fabs(r.depth) * (oscdata->pitch.extend_range ? 12.f : 1.f);
+                    }
+                }
+            }
+        }
     }
 
+    if (storage->mpeEnabled)
+        bendDown = std::max(bendDown, storage->mpePitchBendRange);
+
+    auto stretch = std::pow(2.0, (12 + bendDown + modDown) / 12.0);
+
+    return tierForDelay(std::max(pitchmult_inv, pitchmult2_inv) * getOversampleLevel() * stretch);
+}
+
+template <typename From, typename To> static void copyDelayHistory(const From &from, To &to)
+{
+    to.clear();
+
+    // replay the whole history, oldest first
+    for (int i = From::comb_size; i > 0; --i)
+        to.write(from.buffer[(from.wp - i) & (From::comb_size - 1)]);
+}
+
+void StringOscillator::ensureDelayCapacity(double taps)
+{
+    /*
+     * The voice has gone lower than its line can serve, so move it onto a longer one. The
+     * longer line gets the shorter one's history, so it reads identically for every delay the
+     * short one could, and it is only a glide which outruns the samples written since which
+     * would read the silence before them.
+     */
+    auto want = tierForDelay(taps);
+
+    if (want <= delayTier || ownDelayLines)
+        return;
+
+    withDelayLines([&](auto &from) {
+        auto promote = [&](auto &to) {
+            acquireDelayLines(to);
+
+            for (int t = 0; t < 2; ++t)
+                copyDelayHistory(*from[t], *to[t]);
+        };
+
+        if (want == delay_medium)
+            promote(delayLineMedium);
+        else
+            promote(delayLineLong);
+
+        releaseDelayLines(from);
+    });
+
+    delayTier = want;
+}
+
+void StringOscillator::init(float pitch, bool is_display, bool nzi)
+{
     memset((void *)dustBuffer, 0, 2 * (BLOCK_SIZE_OS) * sizeof(float));
 
     id_exciterlvl = oscdata->p[str_exciter_level].param_id_in_scene;
@@ -170,8 +311,21 @@ void StringOscillator::init(float pitch, bool is_display, bool nzi)
                                            storage->note_to_pitch_inv(pitch2_t));
     }
 
-    pitchmult_inv = std::min(pitchmult_inv, (delayLine[0]->comb_size - 100) * 1.0);
-    pitchmult2_inv = std::min(pitchmult2_inv, (delayLine[0]->comb_size - 100) * 1.0);
+    pitchmult_inv = std::min(pitchmult_inv, maxDelayTaps<delayLong_t>());
+    pitchmult2_inv = std::min(pitchmult2_inv, maxDelayTaps<delayLong_t>());
+
+    // the display has lines of its own, since it runs off the audio thread
+    auto tier = is_display ? delay_long : initialDelayTier(pitchmult_inv, pitchmult2_inv);
+    bool haveLines{false};
+    withDelayLines([&](auto &delayLine) { haveLines = delayLine[0] != nullptr; });
+
+    if (!haveLines || tier != delayTier || ownDelayLines != is_display)
+    {
+        releaseAllDelayLines();
+        ownDelayLines = is_display;
+        delayTier = tier;
+        withDelayLines([this](auto &delayLine) { acquireDelayLines(delayLine); });
+    }
 
     noiseLp.coeff_LP2B(noiseLp.calc_omega(0) * OSC_OVERSAMPLING, 0.9);
     for (int i = 0; i < 3; ++i)
@@ -188,7 +342,7 @@ void StringOscillator::init(float pitch, bool is_display, bool nzi)
 
     for (int i = 0; i < 2; ++i)
     {
-        delayLine[i]->clear();
+        onDelayLine(i, [](auto *dl) { dl->clear(); });
         driftLFO[i].init(nzi);
     }
 
@@ -366,13 +520,14 @@ void StringOscillator::init(float pitch, bool is_display, bool nzi)
 
         for (int t = 0; t < 2; ++t)
         {
-            delayLine[t]->write(tone.v < 0 ? lpt[t] : hpt[t]);
+            onDelayLine(t, [&](auto *dl) { dl->write(tone.v < 0 ? lpt[t] : hpt[t]); });
         }
     }
 
     for (int t = 0; t < 2; ++t)
     {
-        priorSample[t] = delayLine[t]->buffer[(delayLine[t]->wp - 1) & delayLine[t]->comb_size];
+        priorSample[t] =
+            onDelayLine(t, [](auto *dl) { return dl->buffer[(dl->wp - 1) & dl->comb_size]; });
     }
 
     charFilt.init(storage->getPatch().character.val.i);
@@ -585,8 +740,16 @@ void StringOscillator::process_block_internal(float pitch, float drift, bool ste
     dp1 /= OS;
     dp2 /= OS;
 
-    pitchmult_inv = std::min(pitchmult_inv, (delayLine[0]->comb_size - 100) * 1.0);
-    pitchmult2_inv = std::min(pitchmult2_inv, (delayLine[0]->comb_size - 100) * 1.0);
+    pitchmult_inv = std::min(pitchmult_inv, maxDelayTaps<delayLong_t>());
+    pitchmult2_inv = std::min(pitchmult2_inv, maxDelayTaps<delayLong_t>());
+
+    /*
+     * The taps lag from where they are to these targets over the block, which OS scales
+     * and FM can stretch by up to fastexp(4) below, so this is the longest read we can make.
+     */
+    ensureDelayCapacity(std::max({(double)tap[0].v, (double)tap[1].v, pitchmult_inv,
+                                  pitchmult2_inv}) *
+                        OS * (FM ? 60.0 : 1.0));
 
     tap[0].newValue(pitchmult_inv);
     tap[1].newValue(pitchmult2_inv);
@@ -708,13 +871,13 @@ void StringOscillator::process_block_internal(float pitch, float drift, bool ste
             switch (interp_mode)
             {
             case StringOscillator::interp_sinc:
-                val[t] = delayLine[t]->read(v);
+                val[t] = onDelayLine(t, [v](auto *dl) { return dl->read(v); });
                 break;
             case StringOscillator::interp_lin:
-                val[t] = delayLine[t]->readLinear(v);
+                val[t] = onDelayLine(t, [v](auto *dl) { return dl->readLinear(v); });
                 break;
             case StringOscillator::interp_zoh:
-                val[t] = delayLine[t]->readZOH(v);
+                val[t] = onDelayLine(t, [v](auto *dl) { return dl->readZOH(v); });
                 break;
             }
 
@@ -813,7 +976,7 @@ void StringOscillator::process_block_internal(float pitch, float drift, bool ste
 
             if (fabs(filtv) < 1e-16)
                 filtv = 0;
-            delayLine[t]->write(filtv * feedback[t].v);
+            onDelayLine(t, [&](auto *dl) { dl->write(filtv * feedback[t].v); });
         }
 
         float out = val[0] + t2level.v * (val[1] - val[0]);
@@ -24,6 +24,7 @@
 #include "SurgeStorage.h"
 #include "DSPUtils.h"
 #include "SSESincDelayLine.h"
+#include "SurgeMemoryPools.h"
 #include "BiquadFilter.h"
 #include "OscillatorCommonFunctions.h"
 #include <random>
@@ -109,8 +110,38 @@ class StringOscillator : public Oscillator
 
     lag<float, true> examp, tap[2], t2level, feedback[2], tone, fmdepth;
 
-    std::array<SSESincDelayLine<16384> *, 2> delayLine{nullptr, nullptr};
+    /*
+     * The delay lines come in three lengths from SurgeMemoryPools. Exactly one of these
+     * pairs is populated, as given by delayTier, and withDelayLines (or onDelayLine, for a
+     * single line) hands it to a generic lambda so the processing code is written once.
+     */
+    using delayShort_t = Surge::Memory::SurgeMemoryPools::stringDelayShort_t;
+    using delayMedium_t = Surge::Memory::SurgeMemoryPools::stringDelayMedium_t;
+    using delayLong_t = Surge::Memory::SurgeMemoryPools::stringDelayLong_t;
+
+    enum delay_tiers
+    {
+        delay_short,
+        delay_medium,
+        delay_long,
+    };
+
+    delay_tiers delayTier{delay_long};
+    std::array<delayShort_t *, 2> delayLineShort{nullptr, nullptr};
+    std::array<delayMedium_t *, 2> delayLineMedium{nullptr, nullptr};
+    std::array<delayLong_t *, 2> delayLineLong{nullptr, nullptr};
     bool ownDelayLines{false};
+
+    template <typename F> void withDelayLines(F &&f);
+    // line t of the current pair, for the per sample reads and writes in the block loop
+    template <typename F> auto onDelayLine(int t, F &&f);
+    template <typename DL> void acquireDelayLines(std::array<DL *, 2> &dl);
+    template <typename DL> void releaseDelayLines(std::array<DL *, 2> &dl);
+    void releaseAllDelayLines();
+    delay_tiers tierForDelay(double taps);
+    delay_tiers initialDelayTier(double pitchmult_inv, double pitchmult2_inv);
+    void ensureDelayCapacity(double taps);
+
     float priorSample[2] = {0, 0};
     Surge::Oscillator::DriftLFO driftLFO[2];
     Surge::Oscillator::CharacterFilter<float> charFilt;
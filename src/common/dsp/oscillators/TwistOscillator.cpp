@@ -21,6 +21,7 @@
  */
 
 #include "TwistOscillator.h"
+#include "SurgeMemoryPools.h"
 #include "DebugHelpers.h"
 
 #define TEST
@@ -278,14 +279,10 @@ static struct EngineDynamicDeact : public ParameterDynamicDeactivationFunction
     }
 } etDynamicDeact;
 
-TwistOscillator::TwistOscillator(SurgeStorage *storage, OscillatorStorage *oscdata,
-                                 pdata *localcopy)
-    : Oscillator(storage, oscdata, localcopy), charFilt(storage)
+TwistOscillator::Resources::Resources()
 {
 #if SAMPLERATE_LANCZOS
-    lancRes = std::make_unique<sst::basic_blocks::dsp::LanczosResampler<BLOCK_SIZE>>(
-        48000, storage->dsamplerate_os);
-    srcstate = nullptr;
+    lancRes = std::make_unique<sst::basic_blocks::dsp::LanczosResampler<BLOCK_SIZE>>(48000, 48000);
 #else
     int error;
     srcstate = src_new(SRC_SINC_FASTEST, 2, &error);
@@ -296,20 +293,168 @@ TwistOscillator::TwistOscillator(SurgeStorage *storage, OscillatorStorage *oscda
     }
 #endif
     voice = std::make_unique<plaits::Voice>();
-    shared_buffer = new char[16384];
-    alloc = std::make_unique<stmlib::BufferAllocator>(shared_buffer, 16384);
+    shared_buffer = std::make_unique<char[]>(sharedBufferSize);
+    alloc = std::make_unique<stmlib::BufferAllocator>(shared_buffer.get(), sharedBufferSize);
     patch = std::make_unique<plaits::Patch>();
     mod = std::make_unique<plaits::Modulations>();
 
     // FM downsampling with a linear interpolator is absolutely fine
-    int error;
-    fmdownsamplestate = src_new(SRC_LINEAR, 1, &error);
-    if (error != 0)
+    int fmerror;
+    fmdownsamplestate = src_new(SRC_LINEAR, 1, &fmerror);
+    if (fmerror != 0)
     {
         fmdownsamplestate = nullptr;
     }
 }
 
+TwistOscillator::Resources::~Resources()
+{
+    if (srcstate)
+        srcstate = src_delete(srcstate);
+
+    if (fmdownsamplestate)
+        fmdownsamplestate = src_delete(fmdownsamplestate);
+}
+
+void TwistOscillator::Resources::reset(double dsamplerate_os, int integerRatio)
+{
+    // Hand the voice its scratch memory back as a fresh oscillator would have it
+    memset(shared_buffer.get(), 0, sharedBufferSize);
+    alloc->Free();
+
+#if SAMPLERATE_LANCZOS
+    if (integerRatio)
+    {
+        upsampler.reset(integerRatio);
+    }
+    else
+    {
+        // reconstruct in place, which clears the history without allocating
+        using lanczos_t = sst::basic_blocks::dsp::LanczosResampler<BLOCK_SIZE>;
+        lancRes->~lanczos_t();
+        new (lancRes.get()) lanczos_t(48000, dsamplerate_os);
+    }
+#else
+    if (srcstate)
+        src_reset(srcstate);
+#endif
+
+    if (fmdownsamplestate)
+        src_reset(fmdownsamplestate);
+}
+
+void TwistOscillator::IntegerUpsampler::reset(int r)
+{
+    if (r != ratio)
+    {
+        ratio = r;
+
+        // output phase p lands p / ratio of the way past the sample A behind the newest
+        for (int p = 0; p < ratio; ++p)
+        {
+            for (int j = 0; j < filterWidth; ++j)
+            {
+                double x = j - A + (double)p / ratio;
+                double k = 1.0;
+
+                if (x != 0)
+                {
+                    k = A * std::sin(M_PI * x) * std::sin(M_PI * x / A) / (M_PI * M_PI * x * x);
+                }
+
+                taps[p][j] = (float)k;
+            }
+        }
+    }
+
+    memset(history, 0, sizeof(history));
+    wp = 0;
+    rp = 0;
+}
+
+void TwistOscillator::IntegerUpsampler::push(float fL, float fR)
+{
+    for (int j = filterWidth - 1; j > 0; --j)
+    {
+        history[0][j] = history[0][j - 1];
+        history[1][j] = history[1][j - 1];
+    }
+
+    history[0][0] = fL;
+    history[1][0] = fR;
+
+    for (int p = 0; p < ratio; ++p)
+    {
+        float oL = 0.f, oR = 0.f;
+
+        for (int j = 0; j < filterWidth; ++j)
+        {
+            oL += taps[p][j] * history[0][j];
+            oR += taps[p][j] * history[1][j];
+        }
+
+        outputs[0][wp & (bufferSize - 1)] = oL;
+        outputs[1][wp & (bufferSize - 1)] = oR;
+        wp++;
+    }
+}
+
+void TwistOscillator::IntegerUpsampler::populateNextBlockSizeOS(float *fL, float *fR)
+{
+    for (int i = 0; i < BLOCK_SIZE_OS; ++i)
+    {
+        fL[i] = outputs[0][rp & (bufferSize - 1)];
+        fR[i] = outputs[1][rp & (bufferSize - 1)];
+        rp++;
+    }
+}
+
+TwistOscillator::TwistOscillator(SurgeStorage *storage, OscillatorStorage *oscdata,
+                                 pdata *localcopy)
+    : Oscillator(storage, oscdata, localcopy), charFilt(storage)
+{
+}
+
+void TwistOscillator::acquireResources(bool is_display)
+{
+    if (res && ownResources != is_display)
+        releaseResources();
+
+    if (!res)
+    {
+        // the display runs off the audio thread so can't touch the pools
+        ownResources = is_display;
+        res = is_display ? new Resources() : storage->memoryPools->twistResources.getItem();
+    }
+
+    plaitsRatio = 0;
+    fmDecimatePhase = 0;
+
+#if SAMPLERATE_LANCZOS
+    auto ratio = storage->dsamplerate_os / 48000.0;
+
+    if (ratio >= 1 && ratio == std::floor(ratio) && ratio <= IntegerUpsampler::maxRatio)
+    {
+        plaitsRatio = (int)ratio;
+    }
+#endif
+
+    res->reset(storage->dsamplerate_os, plaitsRatio);
+}
+
+void TwistOscillator::releaseResources()
+{
+    if (!res)
+        return;
+
+    if (storage && !ownResources)
+        storage->memoryPools->twistResources.returnItem(res);
+    else
+        delete res;
+
+    res = nullptr;
+}
+
 float TwistOscillator::tuningAwarePitch(float pitch)
 {
     float p = pitch;
@@ -330,7 +475,13 @@ float TwistOscillator::tuningAwarePitch(float pitch)
 
 void TwistOscillator::init(float pitch, bool is_display, bool nonzero_drift)
 {
-    voice->Init(alloc.get());
+    acquireResources(is_display);
+
+    auto &voice = res->voice;
+    auto &patch = res->patch;
+    auto &mod = res->mod;
+
+    voice->Init(res->alloc.get());
 
     charFilt.init(storage->getPatch().character.val.i);
 
@@ -358,28 +509,28 @@ void TwistOscillator::init(float pitch, bool is_display, bool nonzero_drift)
 
     process_block_internal<false, true>(pitch, 0, false, 0, std::ceil(cycleInSamples));
 }
-TwistOscillator::~TwistOscillator()
-{
-    if (shared_buffer)
-        delete[] shared_buffer;
-
-    if (srcstate)
-        srcstate = src_delete(srcstate);
-
-    if (fmdownsamplestate)
-        fmdownsamplestate = src_delete(fmdownsamplestate);
-}
+TwistOscillator::~TwistOscillator() { releaseResources(); }
 
 template <bool FM, bool throwaway>
 void TwistOscillator::process_block_internal(float pitch, float drift, bool stereo, float FMdepth,
                                              int throwawayBlocks)
 {
+    if (!res)
+        return;
+
+    auto &voice = res->voice;
+    auto &patch = res->patch;
+    auto &mod = res->mod;
 #if SAMPLERATE_SRC
+    auto srcstate = res->srcstate;
+
     if (!srcstate)
         return;
+#else
+    auto &lancRes = res->lancRes;
 #endif
 
-    if (FM && !fmdownsamplestate)
+    if (FM && !plaitsRatio && !res->fmdownsamplestate)
         return;
 
     pitch = tuningAwarePitch(pitch);
@@ -421,26 +572,43 @@ void TwistOscillator::process_block_internal(float pitch, float drift, bool ster
 
     if (FM)
     {
-        float dsmaster[BLOCK_SIZE_OS << 2];
-        SRC_DATA fmdata;
-        fmdata.end_of_input = 0;
-        fmdata.src_ratio = 48000.0 / storage->dsamplerate_os; // going INTO the plaits rate
-        fmdata.data_in = master_osc;
-        fmdata.data_out = &(dsmaster[0]);
-        fmdata.input_frames = BLOCK_SIZE_OS;
-        fmdata.output_frames = BLOCK_SIZE_OS << 2;
-        src_process(fmdownsamplestate, &fmdata);
-
         const float bl = -143.5, bhi = 71.7, oos = 1.0 / (bhi - bl);
         float adb = limit_range(amp_to_db(FMdepth), bl, bhi);
         float nfm = (adb - bl) * oos;
 
         normFMdepth = limit_range(nfm, 0.f, 1.f);
 
-        for (int i = 0; i < fmdata.output_frames_gen; ++i)
+        if (plaitsRatio)
+        {
+            for (int i = 0; i < BLOCK_SIZE_OS; ++i)
+            {
+                if (fmDecimatePhase == 0)
+                {
+                    fmlagbuffer[fmwp] = master_osc[i];
+                    fmwp = (fmwp + 1) & ((BLOCK_SIZE_OS << 1) - 1);
+                }
+
+                if (++fmDecimatePhase == plaitsRatio)
+                    fmDecimatePhase = 0;
+            }
+        }
+        else
         {
-            fmlagbuffer[fmwp] = dsmaster[i];
-            fmwp = (fmwp + 1) & ((BLOCK_SIZE_OS << 1) - 1);
+            float dsmaster[BLOCK_SIZE_OS << 2];
+            SRC_DATA fmdata;
+            fmdata.end_of_input = 0;
+            fmdata.src_ratio = 48000.0 / storage->dsamplerate_os; // going INTO the plaits rate
+            fmdata.data_in = master_osc;
+            fmdata.data_out = &(dsmaster[0]);
+            fmdata.input_frames = BLOCK_SIZE_OS;
+            fmdata.output_frames = BLOCK_SIZE_OS << 2;
+            src_process(res->fmdownsamplestate, &fmdata);
+
+            for (int i = 0; i < fmdata.output_frames_gen; ++i)
+            {
+                fmlagbuffer[fmwp] = dsmaster[i];
+                fmwp = (fmwp + 1) & ((BLOCK_SIZE_OS << 1) - 1);
+            }
         }
     }
 
@@ -463,8 +631,11 @@ void TwistOscillator::process_block_internal(float pitch, float drift, bool ster
     int total_generated = carrover_size;
     carrover_size = 0;
 #else
+    // when throwing away we drop the upsampler output as we go, so count what we dropped
+    size_t discarded = 0;
     int total_generated =
-        required_blocks - lancRes->inputsRequiredToGenerateOutputs(required_blocks);
+        plaitsRatio ? res->upsampler.available()
+                    : required_blocks - lancRes->inputsRequiredToGenerateOutputs(required_blocks);
 #endif
 
     if (lpgIsOn)
@@ -507,12 +678,33 @@ void TwistOscillator::process_block_internal(float pitch, float drift, bool ster
         voice->Render(*patch, *mod, poutput, subblock);
 
 #if SAMPLERATE_LANCZOS
-        for (int i = 0; i < subblock; ++i)
+        if (plaitsRatio)
+        {
+            auto &ups = res->upsampler;
+
+            for (int i = 0; i < subblock; ++i)
+            {
+                ups.push(poutput[i].out / 32768.f, poutput[i].aux / 32768.f);
+            }
+
+            if (throwaway)
+            {
+                auto drop = std::min(ups.available(), (size_t)required_blocks - discarded);
+                ups.advanceReadPointer(drop);
+                discarded += drop;
+            }
+
+            total_generated = discarded + ups.available();
+        }
+        else
         {
-            lancRes->push(poutput[i].out / 32768.f, poutput[i].aux / 32768.f);
+            for (int i = 0; i < subblock; ++i)
+            {
+                lancRes->push(poutput[i].out / 32768.f, poutput[i].aux / 32768.f);
+            }
+            total_generated =
+                required_blocks - lancRes->inputsRequiredToGenerateOutputs(required_blocks);
         }
-        total_generated =
-            required_blocks - lancRes->inputsRequiredToGenerateOutputs(required_blocks);
 #else
         for (int i = 0; i < subblock; ++i)
         {
@@ -563,12 +755,17 @@ void TwistOscillator::process_block_internal(float pitch, float drift, bool ster
 #if SAMPLERATE_LANCZOS
     if (throwaway)
     {
-        lancRes->advanceReadPointer(required_blocks);
+        if (!plaitsRatio)
+            lancRes->advanceReadPointer(required_blocks);
     }
     else
     {
         float tL[BLOCK_SIZE_OS], tR[BLOCK_SIZE_OS];
-        lancRes->populateNextBlockSizeOS(tL, tR);
+
+        if (plaitsRatio)
+            res->upsampler.populateNextBlockSizeOS(tL, tR);
+        else
+            lancRes->populateNextBlockSizeOS(tL, tR);
 
         for (int i = 0; i < BLOCK_SIZE_OS; ++i)
         {
@@ -585,7 +782,8 @@ void TwistOscillator::process_block_internal(float pitch, float drift, bool ster
             auxmix.process();
         }
     }
-    lancRes->renormalizePhases();
+    if (!plaitsRatio)
+        lancRes->renormalizePhases();
 #endif
 
     if (!throwaway && charFilt.doFilter)
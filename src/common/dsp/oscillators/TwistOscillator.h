@@ -20,6 +20,9 @@
  * https://github.com/surge-synthesizer/surge
  */
 
+#ifndef SURGE_SRC_COMMON_DSP_OSCILLATORS_TWISTOSCILLATOR_H
+#define SURGE_SRC_COMMON_DSP_OSCILLATORS_TWISTOSCILLATOR_H
+
 /*
  * What's our samplerate strategy
  */
@@ -88,22 +91,72 @@ class TwistOscillator : public Oscillator
         return clamp01((localcopy[oscdata->p[ps].param_id_in_scene].f + 1) * 0.5f);
     }
 
-    std::unique_ptr<plaits::Voice> voice;
-    std::unique_ptr<plaits::Patch> patch;
-    std::unique_ptr<plaits::Modulations> mod;
-    std::unique_ptr<stmlib::BufferAllocator> alloc;
-    char *shared_buffer{nullptr};
+    /*
+     * When the oversampled rate is a whole multiple of the 48 kHz plaits runs at, every
+     * output sample sits at one of a few fixed phases between plaits samples. So rather than
+     * run the general resampler we apply the same lanczos kernel with its taps worked out
+     * once per phase, and feed the FM input to plaits by just dropping samples.
+     */
+    struct IntegerUpsampler
+    {
+        static constexpr int A = 4, filterWidth = 2 * A, maxRatio = 16;
+        static constexpr int bufferSize = 1024; // >= BLOCK_SIZE_OS + 12 * maxRatio, pow2
+
+        void reset(int r);
+        void push(float fL, float fR);
+        size_t available() const { return wp - rp; }
+        void populateNextBlockSizeOS(float *fL, float *fR);
+        void advanceReadPointer(size_t n) { rp += n; }
+
+        int ratio{0};
+        float taps[maxRatio][filterWidth];
+        float history[2][filterWidth];
+        float outputs[2][bufferSize];
+        size_t wp{0}, rp{0};
+    };
 
-    // Keep this here for now even if using lanczos since I'm using SRC for FM still
-    SRC_STATE_tag *srcstate, *fmdownsamplestate;
-    float fmlagbuffer[BLOCK_SIZE_OS << 1];
-    int fmwp, fmrp;
+    /*
+     * Everything a voice needs which is expensive to make: the plaits voice and its scratch
+     * memory, and the resamplers. Playing voices get these from SurgeMemoryPools in init
+     * rather than making them on the audio thread at note on; the display makes its own.
+     */
+    struct Resources
+    {
+        Resources();
+        ~Resources();
 
-    bool useCorrectLPGBlockSize{false}; // See #6760
+        void reset(double dsamplerate_os, int integerRatio);
+
+        static constexpr size_t sharedBufferSize = 16384;
+
+        std::unique_ptr<plaits::Voice> voice;
+        std::unique_ptr<plaits::Patch> patch;
+        std::unique_ptr<plaits::Modulations> mod;
+        std::unique_ptr<stmlib::BufferAllocator> alloc;
+        std::unique_ptr<char[]> shared_buffer;
+
+        // Keep this here for now even if using lanczos since I'm using SRC for FM still
+        SRC_STATE_tag *srcstate{nullptr}, *fmdownsamplestate{nullptr};
 
 #if SAMPLERATE_LANCZOS
-    std::unique_ptr<sst::basic_blocks::dsp::LanczosResampler<BLOCK_SIZE>> lancRes;
+        std::unique_ptr<sst::basic_blocks::dsp::LanczosResampler<BLOCK_SIZE>> lancRes;
 #endif
+        IntegerUpsampler upsampler;
+    };
+
+    Resources *res{nullptr};
+    bool ownResources{false};
+    void acquireResources(bool is_display);
+    void releaseResources();
+
+    // dsamplerate_os / 48000 if that is a whole number we can take the fast path for, else 0
+    int plaitsRatio{0};
+    int fmDecimatePhase{0};
+
+    float fmlagbuffer[BLOCK_SIZE_OS << 1];
+    int fmwp, fmrp;
+
+    bool useCorrectLPGBlockSize{false}; // See #6760
 
     float carryover[BLOCK_SIZE_OS][2];
     int carrover_size = 0;
@@ -113,3 +166,5 @@ class TwistOscillator : public Oscillator
     Surge::Oscillator::DriftLFO driftLFO;
     Surge::Oscillator::CharacterFilter<float> charFilt;
 };
+
+#endif // SURGE_SRC_COMMON_DSP_OSCILLATORS_TWISTOSCILLATOR_H
@@ -43,6 +43,8 @@ void WavetableOscillator::init(float pitch, bool is_display, bool nonzero_init_d
 {
     assert(storage);
     first_run = true;
+    kernels = &Surge::Oscillator::activeBlitKernels();
+    impulses.count = 0;
     osc_out = _mm_set1_ps(0.f);
     osc_outR = _mm_set1_ps(0.f);
     bufpos = 0;
@@ -154,27 +156,120 @@ void WavetableOscillator::init_default_values()
     oscdata->p[wt_unison_voices].val.i = 1;
 }
 
-float WavetableOscillator::distort_level(float x)
+void WavetableOscillator::update_unison_timing()
 {
-    float a = l_vskew.v * 0.5;
-    float clip = l_clip.v;
+    /*
+     * The time to the next state change scales with the unison voice's detune, which only
+     * moves once per block (drift and detune are both block rate), so look it up once here
+     * rather than once per impulse in convolute.
+     */
+    for (int voice = 0; voice < n_unison; voice++)
+    {
+        double detune = drift * driftLFO[voice].val();
+        if (n_unison > 1)
+            detune += oscdata->p[wt_unison_detune].get_extended(localcopy[id_detune].f) *
+                      (detune_bias * float(voice) + detune_offset);
+
+        float tempt;
+        if (oscdata->p[wt_unison_detune].absolute)
+        {
+            // See the comment in ClassicOscillator.cpp at the absolute treatment
+            tempt = storage->note_to_pitch_inv_ignoring_tuning(
+                detune * storage->note_to_pitch_inv_ignoring_tuning(pitch_t) * 16 / 0.9443);
+            if (tempt < 0.1)
+                tempt = 0.1;
+        }
+        else
+        {
+            tempt = storage->note_to_pitch_inv_tuningctr(detune);
+        }
+
+        unison_tempt[voice] = tempt;
+    }
+}
+
+void WavetableOscillator::render_impulses(bool stereo)
+{
+    auto &q = impulses;
+
+    if (q.count == 0)
+        return;
 
-    x = x - a * x * x + a;
+    // pad to a full quad; the padding lanes are computed but never used
+    for (int i = q.count; i < ((q.count + 3) & ~3); i++)
+    {
+        q.frameA[i] = 0.f;
+        q.frameB[i] = 0.f;
+        q.morph[i] = 0.f;
+    }
+
+    /*
+     * Frame morph, then the vertical skew and saturation distortion, for four queued
+     * impulses per step. Namely
+     *
+     *   x = frameA * (1 - morph) + frameB * morph
+     *   x = x - a * x * x + a
+     *   x = limit_range(x * (1 - clip) + clip * x * x * x, -1, 1)
+     *
+     * evaluated in the same order as the scalar code this replaced, so the output is unchanged.
+     */
+    const auto a = _mm_set1_ps(l_vskew.v * 0.5f);
+    const auto clip = _mm_set1_ps(l_clip.v);
+    const auto oneMinusClip = _mm_set1_ps(1.f - l_clip.v);
+    const auto one = _mm_set1_ps(1.f);
+    const auto mone = _mm_set1_ps(-1.f);
+
+    for (int i = 0; i < q.count; i += 4)
+    {
+        auto fa = _mm_load_ps(&q.frameA[i]);
+        auto fb = _mm_load_ps(&q.frameB[i]);
+        auto mo = _mm_load_ps(&q.morph[i]);
 
-    x = limit_range(x * (1 - clip) + clip * x * x * x, -1.f, 1.f);
+        auto x = _mm_add_ps(_mm_mul_ps(fa, _mm_sub_ps(one, mo)), _mm_mul_ps(fb, mo));
+        x = _mm_add_ps(_mm_sub_ps(x, _mm_mul_ps(_mm_mul_ps(a, x), x)), a);
+
+        auto x3 = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(clip, x), x), x);
+        x = _mm_add_ps(_mm_mul_ps(x, oneMinusClip), x3);
+        x = _mm_min_ps(_mm_max_ps(x, mone), one);
+
+        _mm_store_ps(&q.level[i], x);
+    }
+
+    /*
+     * The level differences are a running state per unison voice, so the rest is done in
+     * queue order, which is the order convolute generated the impulses in.
+     */
+    for (int i = 0; i < q.count; i++)
+    {
+        auto voice = q.voice[i];
+        float g = q.level[i] - last_level[voice];
+        last_level[voice] = q.level[i];
+
+        g *= out_attenuation;
+
+        const float *sinc = &storage->sinctable[q.sincofs[i]];
+        auto pos = bufpos + q.delay[i];
+
+        if (stereo)
+        {
+            float gR = g * panR[voice];
+            g *= panL[voice];
+
+            kernels->convolveStereo(&oscbuffer[pos], &oscbufferR[pos], sinc, q.lipol[i], g, gR);
+        }
+        else
+        {
+            kernels->convolve(&oscbuffer[pos], sinc, q.lipol[i], g);
+        }
+    }
 
-    return x;
+    q.count = 0;
 }
 
 void WavetableOscillator::convolute(int voice, bool FM, bool stereo)
 {
     float block_pos = oscstate[voice] * BLOCK_SIZE_OS_INV * pitchmult_inv;
 
-    double detune = drift * driftLFO[voice].val();
-    if (n_unison > 1)
-        detune += oscdata->p[wt_unison_detune].get_extended(localcopy[id_detune].f) *
-                  (detune_bias * float(voice) + detune_offset);
-
     const float p24 = (1 << 24);
     unsigned int ipos;
 
@@ -243,27 +338,12 @@ void WavetableOscillator::convolute(int voice, bool FM, bool stereo)
 
     unsigned int m = ((ipos >> 16) & 0xff) * (FIRipol_N << 1);
     unsigned int lipolui16 = (ipos & 0xffff);
-    __m128 lipol128 = _mm_cvtsi32_ss(lipol128, lipolui16);
-    lipol128 = _mm_shuffle_ps(lipol128, lipol128, _MM_SHUFFLE(0, 0, 0, 0));
 
-    float g, gR;
     int wt_inc = (1 << mipmap[voice]);
     float dt = (oscdata->wt.dt) * wt_inc;
 
     // add time until next statechange
-    float tempt;
-    if (oscdata->p[wt_unison_detune].absolute)
-    {
-        // See the comment in ClassicOscillator.cpp at the absolute treatment
-        tempt = storage->note_to_pitch_inv_ignoring_tuning(
-            detune * storage->note_to_pitch_inv_ignoring_tuning(pitch_t) * 16 / 0.9443);
-        if (tempt < 0.1)
-            tempt = 0.1;
-    }
-    else
-    {
-        tempt = storage->note_to_pitch_inv_tuningctr(detune);
-    }
+    float tempt = unison_tempt[voice];
 
     float t;
     float xt = ((float)state[voice] + 0.5f) * dt;
@@ -292,69 +372,34 @@ void WavetableOscillator::convolute(int voice, bool FM, bool stereo)
     state[voice] = state[voice] & (wtsize - 1);
 
     float tblip_ipol = (1 - block_pos) * last_tableipol + block_pos * tableipol;
-    float newlevel;
 
     // in Continuous Morph mode tblip_ipol gives us position between current and next frame
     // when not in Continuous Morph mode, we don't interpolate so this position should be zero
     float lipol = (1 - nointerp) * tblip_ipol;
 
-    // that 1 - nointerp makes sure we don't read the table off memory, keeps us bounded
-    // and since it gets multiplied by lipol, in morph mode ends up being zero - no sweat!
-    newlevel = distort_level(
-        (oscdata->wt.TableF32WeakPointers[mipmap[voice]][tableid][state[voice]] * (1.f - lipol)) +
-        (oscdata->wt.TableF32WeakPointers[mipmap[voice]][tableid + 1 - nointerp][state[voice]] *
-         lipol));
-
-    g = newlevel - last_level[voice];
-    last_level[voice] = newlevel;
-
-    g *= out_attenuation;
-    if (stereo)
+    /*
+     * Rather than morph, distort and convolve right here, queue the impulse. The morph and
+     * distortion only depend on block-constant parameters and the two table samples, so
+     * render_impulses can do them four impulses at a time, across all the unison voices,
+     * before running the convolutions.
+     *
+     * that 1 - nointerp makes sure we don't read the table off memory, keeps us bounded
+     * and since it gets multiplied by lipol, in morph mode ends up being zero - no sweat!
+     */
+    auto &q = impulses;
+    q.frameA[q.count] = oscdata->wt.TableF32WeakPointers[mipmap[voice]][tableid][state[voice]];
+    q.frameB[q.count] =
+        oscdata->wt.TableF32WeakPointers[mipmap[voice]][tableid + 1 - nointerp][state[voice]];
+    q.morph[q.count] = lipol;
+    q.lipol[q.count] = (float)lipolui16;
+    q.sincofs[q.count] = m;
+    q.delay[q.count] = delay;
+    q.voice[q.count] = voice;
+    q.count++;
+
+    if (q.count == ImpulseQueue::capacity)
     {
-        gR = g * panR[voice];
-        g *= panL[voice];
-    }
-
-    if (stereo)
-    {
-        __m128 g128L = _mm_load_ss(&g);
-        g128L = _mm_shuffle_ps(g128L, g128L, _MM_SHUFFLE(0, 0, 0, 0));
-        __m128 g128R = _mm_load_ss(&gR);
-        g128R = _mm_shuffle_ps(g128R, g128R, _MM_SHUFFLE(0, 0, 0, 0));
-
-        for (int k = 0; k < FIRipol_N; k += 4)
-        {
-            float *obfL = &oscbuffer[bufpos + k + delay];
-            float *obfR = &oscbufferR[bufpos + k + delay];
-            __m128 obL = _mm_loadu_ps(obfL);
-            __m128 obR = _mm_loadu_ps(obfR);
-            __m128 st = _mm_load_ps(&storage->sinctable[m + k]);
-            __m128 so = _mm_load_ps(&storage->sinctable[m + k + FIRipol_N]);
-            so = _mm_mul_ps(so, lipol128);
-            st = _mm_add_ps(st, so);
-            obL = _mm_add_ps(obL, _mm_mul_ps(st, g128L));
-            _mm_storeu_ps(obfL, obL);
-            obR = _mm_add_ps(obR, _mm_mul_ps(st, g128R));
-            _mm_storeu_ps(obfR, obR);
-        }
-    }
-    else
-    {
-        __m128 g128 = _mm_load_ss(&g);
-        g128 = _mm_shuffle_ps(g128, g128, _MM_SHUFFLE(0, 0, 0, 0));
-
-        for (int k = 0; k < FIRipol_N; k += 4)
-        {
-            float *obf = &oscbuffer[bufpos + k + delay];
-            __m128 ob = _mm_loadu_ps(obf);
-            __m128 st = _mm_load_ps(&storage->sinctable[m + k]);
-            __m128 so = _mm_load_ps(&storage->sinctable[m + k + FIRipol_N]);
-            so = _mm_mul_ps(so, lipol128);
-            st = _mm_add_ps(st, so);
-            st = _mm_mul_ps(st, g128);
-            ob = _mm_add_ps(ob, st);
-            _mm_storeu_ps(obf, ob);
-        }
+        render_impulses(stereo);
     }
 
     rate[voice] = t;
@@ -461,13 +506,15 @@ void WavetableOscillator::process_block(float pitch0, float drift, bool stereo,
         }
     }
 
-    if (FM)
+    for (int l = 0; l < n_unison; l++)
     {
-        for (int l = 0; l < n_unison; l++)
-        {
-            driftLFO[l].next();
-        }
+        driftLFO[l].next();
+    }
+
+    update_unison_timing();
 
+    if (FM)
+    {
         for (int s = 0; s < BLOCK_SIZE_OS; s++)
         {
             float fmmul = limit_range(1.f + depth * master_osc[s], 0.1f, 1.9f);
@@ -491,13 +538,14 @@ void WavetableOscillator::process_block(float pitch0, float drift, bool stereo,
         float a = (float)BLOCK_SIZE_OS * pitchmult;
         for (int l = 0; l < n_unison; l++)
         {
-            driftLFO[l].next();
             while (oscstate[l] < a)
                 convolute(l, false, stereo);
             oscstate[l] -= a;
         }
     }
 
+    render_impulses(stereo);
+
     float hpfblock alignas(16)[BLOCK_SIZE_OS];
     li_hpf.store_block(hpfblock, BLOCK_SIZE_OS_QUAD);
 
@@ -27,6 +27,7 @@
 #include "DSPUtils.h"
 #include <vembertech/lipol.h>
 #include "BiquadFilter.h"
+#include "OscillatorSIMDKernels.h"
 
 class WavetableOscillator : public AbstractBlitOscillator
 {
@@ -55,9 +56,26 @@ class WavetableOscillator : public AbstractBlitOscillator
                                            int currentSynthStreamingRevision) override;
 
   private:
+    /*
+     * Impulses generated by convolute but not yet rendered into oscbuffer. Structure of
+     * arrays so render_impulses can morph and distort them four at a time.
+     */
+    struct ImpulseQueue
+    {
+        static constexpr int capacity = 64;
+        float frameA alignas(16)[capacity], frameB alignas(16)[capacity];
+        float morph alignas(16)[capacity], level alignas(16)[capacity];
+        float lipol[capacity];
+        unsigned int sincofs[capacity], delay[capacity];
+        int voice[capacity];
+        int count{0};
+    } impulses;
+    static_assert(ImpulseQueue::capacity % 4 == 0, "ImpulseQueue is processed in quads");
+
     void convolute(int voice, bool FM, bool stereo);
+    void render_impulses(bool stereo);
+    void update_unison_timing();
     template <bool is_init> void update_lagvals();
-    inline float distort_level(float);
     bool first_run;
     float oscpitch[MAX_UNISON];
     float dc, dc_uni[MAX_UNISON], last_level[MAX_UNISON];
@@ -72,6 +90,8 @@ class WavetableOscillator : public AbstractBlitOscillator
     int nointerp;
     float FMmul_inv;
     int sampleloop;
+    float unison_tempt[MAX_UNISON];
+    const Surge::Oscillator::BlitKernels *kernels{nullptr};
 };
 
 #endif // SURGE_SRC_COMMON_DSP_OSCILLATORS_WAVETABLEOSCILLATOR_H
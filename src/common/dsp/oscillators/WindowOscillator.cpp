@@ -38,6 +38,26 @@ inline bool _BitScanReverse(unsigned long *result, unsigned long bits)
 }
 } // anonymous namespace
 #endif
+namespace
+{
+// the sums of the four lanes of each of a, b, c and d, in that order
+inline __m128i sumLanes4(__m128i a, __m128i b, __m128i c, __m128i d)
+{
+    auto ab = _mm_add_epi32(_mm_unpacklo_epi32(a, b), _mm_unpackhi_epi32(a, b));
+    auto cd = _mm_add_epi32(_mm_unpacklo_epi32(c, d), _mm_unpackhi_epi32(c, d));
+    return _mm_add_epi32(_mm_unpacklo_epi64(ab, cd), _mm_unpackhi_epi64(ab, cd));
+}
+
+// _mm_mullo_epi32 is SSE4.1, so build the low halves of the products from two 32x32->64s
+inline __m128i mulLo32(__m128i a, __m128i b)
+{
+    auto even = _mm_mul_epu32(a, b);
+    auto odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+} // namespace
+
 int Float2Int(float x)
 {
 #ifdef ARM_NEON
@@ -268,83 +288,81 @@ void WindowOscillator::ProcessWindowOscs(bool stereo, bool FM)
             short *WaveAdrP1 = oscdata->wt.TableI16WeakPointers[MipMapB][Window.Table[1][so]];
             short *WinAdr = storage->WindowWT.TableI16WeakPointers[MipMapA][SelWindow];
 
-            for (int i = 0; i < BLOCK_SIZE_OS; i++)
+            /*
+             * Four samples at a time. Where each sample reads from has to be worked out in
+             * turn, since the grain can wrap and pick up new tables part way through, but
+             * each read is an 8 tap FIR on int16 with madd, and the sums of those, the morph
+             * between tables, the window and the panning all then go four wide.
+             */
+            const auto morphA = _mm_set1_ps(1.f - FTable), morphB = _mm_set1_ps(FTable);
+            const auto gainL = _mm_set1_epi32(Window.Gain[so][0]);
+            const auto gainR = _mm_set1_epi32(Window.Gain[so][1]);
+
+            for (int i = 0; i < BLOCK_SIZE_OS; i += 4)
             {
-                if (FM)
-                {
-                    Pos += Window.FMRatio[so][i];
-                }
-                else
-                {
-                    Pos += RatioA;
-                }
+                __m128i Wave[4], WaveP1[4], Win[4];
 
-                if (Pos & ~SizeMaskWin)
+                for (int j = 0; j < 4; j++)
                 {
-                    Window.FormantMul[so] = FormantMul;
-                    Window.Table[0][so] = Table;
-                    Window.Table[1][so] = TablePlusOne;
-                    WaveAdr = oscdata->wt.TableI16WeakPointers[MipMapB][Table];
-                    WaveAdrP1 = oscdata->wt.TableI16WeakPointers[MipMapB][TablePlusOne];
-                    Pos = Pos & SizeMaskWin;
+                    if (FM)
+                    {
+                        Pos += Window.FMRatio[so][i + j];
+                    }
+                    else
+                    {
+                        Pos += RatioA;
+                    }
+
+                    if (Pos & ~SizeMaskWin)
+                    {
+                        Window.FormantMul[so] = FormantMul;
+                        Window.Table[0][so] = Table;
+                        Window.Table[1][so] = TablePlusOne;
+                        WaveAdr = oscdata->wt.TableI16WeakPointers[MipMapB][Table];
+                        WaveAdrP1 = oscdata->wt.TableI16WeakPointers[MipMapB][TablePlusOne];
+                        Pos = Pos & SizeMaskWin;
+                    }
+
+                    unsigned int WinPos = Pos >> (16 + MipMapA);
+                    unsigned int WinSPos = (Pos >> (8 + MipMapA)) & 0xFF;
+
+                    unsigned int FPos = BigMULr16(Window.FormantMul[so], Pos) & SizeMask;
+
+                    unsigned int MPos = FPos >> (16 + MipMapB);
+                    unsigned int MSPos = ((FPos >> (8 + MipMapB)) & 0xFF);
+
+                    auto sinc = _mm_load_si128((__m128i *)storage->sinctableI16 + MSPos);
+
+                    Wave[j] = _mm_madd_epi16(sinc, _mm_loadu_si128((__m128i *)&WaveAdr[MPos]));
+                    WaveP1[j] = _mm_madd_epi16(sinc, _mm_loadu_si128((__m128i *)&WaveAdrP1[MPos]));
+                    Win[j] =
+                        _mm_madd_epi16(_mm_load_si128(((__m128i *)storage->sinctableI16 + WinSPos)),
+                                       _mm_loadu_si128((__m128i *)&WinAdr[WinPos]));
                 }
 
-                unsigned int WinPos = Pos >> (16 + MipMapA);
-                unsigned int WinSPos = (Pos >> (8 + MipMapA)) & 0xFF;
-
-                unsigned int FPos = BigMULr16(Window.FormantMul[so], Pos) & SizeMask;
-
-                unsigned int MPos = FPos >> (16 + MipMapB);
-                unsigned int MSPos = ((FPos >> (8 + MipMapB)) & 0xFF);
-
-                __m128i Wave =
-                    _mm_madd_epi16(_mm_load_si128(((__m128i *)storage->sinctableI16 + MSPos)),
-                                   _mm_loadu_si128((__m128i *)&WaveAdr[MPos]));
-                __m128i WaveP1 =
-                    _mm_madd_epi16(_mm_load_si128(((__m128i *)storage->sinctableI16 + MSPos)),
-                                   _mm_loadu_si128((__m128i *)&WaveAdrP1[MPos]));
-
-                __m128i Win =
-                    _mm_madd_epi16(_mm_load_si128(((__m128i *)storage->sinctableI16 + WinSPos)),
-                                   _mm_loadu_si128((__m128i *)&WinAdr[WinPos]));
-
-                // Sum
-                int iWin alignas(16)[4], iWaveP1 alignas(16)[4], iWave alignas(16)[4];
-#if MAC
-                // this should be very fast on C2D/C1D (and there are no macs with K8's)
-                iWin[0] = _mm_cvtsi128_si32(Win);
-                iWin[1] = _mm_cvtsi128_si32(_mm_shuffle_epi32(Win, _MM_SHUFFLE(1, 1, 1, 1)));
-                iWin[2] = _mm_cvtsi128_si32(_mm_shuffle_epi32(Win, _MM_SHUFFLE(2, 2, 2, 2)));
-                iWin[3] = _mm_cvtsi128_si32(_mm_shuffle_epi32(Win, _MM_SHUFFLE(3, 3, 3, 3)));
-                iWave[0] = _mm_cvtsi128_si32(Wave);
-                iWave[1] = _mm_cvtsi128_si32(_mm_shuffle_epi32(Wave, _MM_SHUFFLE(1, 1, 1, 1)));
-                iWave[2] = _mm_cvtsi128_si32(_mm_shuffle_epi32(Wave, _MM_SHUFFLE(2, 2, 2, 2)));
-                iWave[3] = _mm_cvtsi128_si32(_mm_shuffle_epi32(Wave, _MM_SHUFFLE(3, 3, 3, 3)));
-                iWaveP1[0] = _mm_cvtsi128_si32(WaveP1);
-                iWaveP1[1] = _mm_cvtsi128_si32(_mm_shuffle_epi32(WaveP1, _MM_SHUFFLE(1, 1, 1, 1)));
-                iWaveP1[2] = _mm_cvtsi128_si32(_mm_shuffle_epi32(WaveP1, _MM_SHUFFLE(2, 2, 2, 2)));
-                iWaveP1[3] = _mm_cvtsi128_si32(_mm_shuffle_epi32(WaveP1, _MM_SHUFFLE(3, 3, 3, 3)));
-
-#else
-                _mm_store_si128((__m128i *)&iWin, Win);
-                _mm_store_si128((__m128i *)&iWave, Wave);
-                _mm_store_si128((__m128i *)&iWaveP1, WaveP1);
-#endif
+                auto iWin = _mm_srai_epi32(sumLanes4(Win[0], Win[1], Win[2], Win[3]), 13);
+                auto iWave = _mm_srai_epi32(sumLanes4(Wave[0], Wave[1], Wave[2], Wave[3]), 13);
+                auto iWaveP1 =
+                    _mm_srai_epi32(sumLanes4(WaveP1[0], WaveP1[1], WaveP1[2], WaveP1[3]), 13);
 
-                iWin[0] = (iWin[0] + iWin[1] + iWin[2] + iWin[3]) >> 13;
-                iWave[0] = (iWave[0] + iWave[1] + iWave[2] + iWave[3]) >> 13;
-                iWaveP1[0] = (iWaveP1[0] + iWaveP1[1] + iWaveP1[2] + iWaveP1[3]) >> 13;
+                iWave = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(morphA, _mm_cvtepi32_ps(iWave)),
+                                                    _mm_mul_ps(morphB, _mm_cvtepi32_ps(iWaveP1))));
 
-                iWave[0] = (int)((1.f - FTable) * iWave[0] + FTable * iWaveP1[0]);
+                auto Out = mulLo32(iWin, iWave);
+                auto OutL = (__m128i *)&IOutputL[i];
 
                 if (stereo)
                 {
-                    int Out = (iWin[0] * iWave[0]) >> 7;
-                    IOutputL[i] += (Out * (int)Window.Gain[so][0]) >> 6;
-                    IOutputR[i] += (Out * (int)Window.Gain[so][1]) >> 6;
+                    auto OutR = (__m128i *)&IOutputR[i];
+
+                    Out = _mm_srai_epi32(Out, 7);
+                    *OutL = _mm_add_epi32(*OutL, _mm_srai_epi32(mulLo32(Out, gainL), 6));
+                    *OutR = _mm_add_epi32(*OutR, _mm_srai_epi32(mulLo32(Out, gainR), 6));
                 }
                 else
-                    IOutputL[i] += (iWin[0] * iWave[0]) >> 6;
+                {
+                    *OutL = _mm_add_epi32(*OutL, _mm_srai_epi32(Out, 6));
+                }
             }
 
             Window.Pos[so] = Pos;
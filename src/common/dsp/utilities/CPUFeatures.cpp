@@ -0,0 +1,105 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "CPUFeatures.h"
+
+#include <algorithm>
+#include <atomic>
+
+#if SURGE_SIMD_X86 && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace Surge
+{
+namespace CPUFeatures
+{
+static SIMDLevel probeSIMDLevel()
+{
+#if SURGE_SIMD_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    auto maxLeaf = info[0];
+
+    if (maxLeaf < 7)
+        return simd_sse2;
+
+    __cpuid(info, 1);
+    bool fma = (info[2] & (1 << 12)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+
+    if (!(fma && osxsave && avx))
+        return simd_sse2;
+
+    // the OS has to save the YMM registers on a context switch for us to be able to use them
+    if ((_xgetbv(0) & 0x6) != 0x6)
+        return simd_sse2;
+
+    __cpuidex(info, 7, 0);
+    bool avx2 = (info[1] & (1 << 5)) != 0;
+
+    return avx2 ? simd_avx2_fma : simd_sse2;
+#else
+    // libgcc and compiler-rt check OS YMM support as part of the avx bits
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return simd_avx2_fma;
+
+    return simd_sse2;
+#endif
+#else
+    return simd_sse2;
+#endif
+}
+
+static std::atomic<int> maximumSIMDLevel{simd_avx2_fma};
+
+SIMDLevel detectedSIMDLevel()
+{
+    static SIMDLevel detected = probeSIMDLevel();
+    return detected;
+}
+
+SIMDLevel activeSIMDLevel()
+{
+    return (SIMDLevel)std::min((int)detectedSIMDLevel(), maximumSIMDLevel.load());
+}
+
+void setMaximumSIMDLevel(SIMDLevel l) { maximumSIMDLevel.store(l); }
+
+const char *simdLevelName(SIMDLevel l)
+{
+    switch (l)
+    {
+    case simd_sse2:
+        return "SSE2";
+    case simd_avx2_fma:
+        return "AVX2/FMA";
+    }
+
+    return "Unknown";
+}
+} // namespace CPUFeatures
+} // namespace Surge
@@ -0,0 +1,105 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_DSP_UTILITIES_CPUFEATURES_H
+#define SURGE_SRC_COMMON_DSP_UTILITIES_CPUFEATURES_H
+
+#include "globals.h"
+
+/*
+ * Surge is built for SSE2 (or SSE2 through simde on ARM). Wider kernels are compiled
+ * alongside the SSE2 ones using per-function target attributes, so a single binary runs
+ * everywhere, and are chosen at runtime based on what the CPU reports.
+ *
+ * SURGE_SIMD_X86 tells you if we can emit x86 intrinsics at all, and SURGE_TARGET_AVX2
+ * is the attribute to put on a function which uses AVX2 and FMA intrinsics. MSVC allows
+ * these intrinsics anywhere so the attributes are empty there.
+ *
+ * To build a whole hot loop once per level, write the body as a SURGE_ALWAYS_INLINE
+ * function and call it from one small wrapper per target attribute. The compiler inlines
+ * the body (and the inline helpers it calls) into each wrapper and so generates it for
+ * that instruction set. Nothing does at the moment: an AVX build of the quad filter chain
+ * only changed its encoding and never showed a gain, so it went. The wider kernels are the
+ * oscillators' hand written AVX2 ones and the eight voice filter chain (OctFilterChain.h),
+ * and the vembertech lipol and halfband helpers are only built for SSE2. We don't compile
+ * translation units with different -m flags, since inline functions and templates from
+ * shared headers would then be emitted with AVX2 instructions under the same symbol as
+ * their SSE2 copies, and the linker is free to pick either one.
+ *
+ * SURGE_TARGET_AVX is for eight wide float code which needs to round exactly like its
+ * SSE2 counterpart. With FMA enabled GCC will fuse a multiply and an add on its own, so
+ * such functions only ask for AVX (which every AVX2 machine has).
+ */
+#if !defined(ARM_NEON) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) ||         \
+                           defined(_M_AMD64) || defined(_M_IX86))
+#define SURGE_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define SURGE_SIMD_X86 0
+#endif
+
+#if SURGE_SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+#define SURGE_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define SURGE_TARGET_AVX __attribute__((target("avx")))
+#else
+#define SURGE_TARGET_AVX2
+#define SURGE_TARGET_AVX
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SURGE_ALWAYS_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define SURGE_ALWAYS_INLINE __forceinline
+#else
+#define SURGE_ALWAYS_INLINE inline
+#endif
+
+namespace Surge
+{
+namespace CPUFeatures
+{
+enum SIMDLevel
+{
+    simd_sse2 = 0,
+    simd_avx2_fma,
+};
+
+/*
+ * What the CPU (and OS) we are running on supports. Computed once and cached.
+ */
+SIMDLevel detectedSIMDLevel();
+
+/*
+ * What the DSP code should dispatch to. This is the detected level unless it has been
+ * capped with setMaximumSIMDLevel, which lets the test suite compare kernels against each
+ * other and lets a user fall back to SSE2 if a wide path misbehaves on their machine.
+ * Objects choose their kernels at init() time, so changing the cap only affects
+ * subsequently initialized objects.
+ */
+SIMDLevel activeSIMDLevel();
+void setMaximumSIMDLevel(SIMDLevel l);
+
+const char *simdLevelName(SIMDLevel l);
+} // namespace CPUFeatures
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_DSP_UTILITIES_CPUFEATURES_H
@@ -0,0 +1,118 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#include "WaveshaperApproximations.h"
+
+namespace Surge
+{
+namespace WaveshaperApprox
+{
+/*
+ * e^x for x in [-87, 88], as 2^n e^r with |r| <= ln(2)/2 and a degree 6 polynomial for e^r
+ * (the cephes expf one). Relative error about 2e-7.
+ */
+static inline __m128 exp_ps(__m128 x)
+{
+    x = _mm_max_ps(_mm_min_ps(x, _mm_set1_ps(88.f)), _mm_set1_ps(-87.f));
+
+    // n = round(x / ln 2), done as floor(x / ln 2 + 1/2)
+    auto fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f));
+    auto tf = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+    tf = _mm_sub_ps(tf, _mm_and_ps(_mm_cmpgt_ps(tf, fx), _mm_set1_ps(1.f)));
+
+    // r = x - n ln 2, with ln 2 split so that n ln2_hi is exact
+    auto r = _mm_sub_ps(x, _mm_mul_ps(tf, _mm_set1_ps(0.693359375f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(tf, _mm_set1_ps(-2.12194440e-4f)));
+
+    auto p = _mm_set1_ps(1.9875691500e-4f);
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.3981999507e-3f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(8.3334519073e-3f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(4.1665795894e-2f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.6666665459e-1f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(5.0000001201e-1f));
+    p = _mm_add_ps(_mm_mul_ps(p, _mm_mul_ps(r, r)), _mm_add_ps(r, _mm_set1_ps(1.f)));
+
+    auto n = _mm_add_epi32(_mm_cvttps_epi32(tf), _mm_set1_epi32(127));
+    return _mm_mul_ps(p, _mm_castsi128_ps(_mm_slli_epi32(n, 23)));
+}
+
+__m128 asym(sst::waveshapers::QuadWaveshaperState *__restrict, __m128 in, __m128 drive)
+{
+    auto x = _mm_mul_ps(in, drive);
+    x = _mm_max_ps(_mm_min_ps(x, _mm_set1_ps(16.f - 1.f / 32.f)), _mm_set1_ps(-16.f));
+
+    /*
+     * With y = x + 1/2, (e^y - e^-1.2y) / (e^y + e^-y) = (1 - e^-2.2y) / (1 + e^-2y), and
+     * e^-2.2y = e^-2y e^-0.2y. At the bottom of the range that is about 23, which is what
+     * makes this one asymmetric.
+     */
+    auto y = _mm_add_ps(x, _mm_set1_ps(0.5f));
+    auto e2 = exp_ps(_mm_mul_ps(y, _mm_set1_ps(-2.f)));
+    auto e02 = exp_ps(_mm_mul_ps(y, _mm_set1_ps(-0.2f)));
+    auto num = _mm_sub_ps(_mm_set1_ps(1.f), _mm_mul_ps(e2, e02));
+    auto den = _mm_add_ps(_mm_set1_ps(1.f), e2);
+
+    // shafted_tanh(0.5) = (e^0.5 - e^-0.6) / (e^0.5 + e^-0.5)
+    static constexpr float offset = 0.48771032f;
+    return _mm_sub_ps(_mm_div_ps(num, den), _mm_set1_ps(offset));
+}
+
+__m128 sine(sst::waveshapers::QuadWaveshaperState *__restrict, __m128 in, __m128 drive)
+{
+    auto x = _mm_mul_ps(in, drive);
+    x = _mm_max_ps(_mm_min_ps(x, _mm_set1_ps(2.f)), _mm_set1_ps(-2.f));
+
+    // fold [1, 2] back onto [1, 0] (and the same below zero) since sin(pi - t) = sin(t)
+    const auto signMask = _mm_set1_ps(-0.f);
+    auto sign = _mm_and_ps(x, signMask);
+    auto ax = _mm_andnot_ps(signMask, x);
+    ax = _mm_min_ps(ax, _mm_sub_ps(_mm_set1_ps(2.f), ax));
+
+    // sin(t) on [0, pi/2] by its Taylor series to t^11; the first term left out is < 6e-8
+    auto t = _mm_mul_ps(ax, _mm_set1_ps(1.57079632679489662f));
+    auto t2 = _mm_mul_ps(t, t);
+    auto p = _mm_set1_ps(-2.50521084e-8f);
+    p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(2.75573192e-6f));
+    p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(-1.98412698e-4f));
+    p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(8.33333333e-3f));
+    p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(-1.66666667e-1f));
+    p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(1.f));
+
+    return _mm_or_ps(_mm_mul_ps(p, t), sign);
+}
+
+sst::waveshapers::QuadWaveshaperPtr GetQuadWaveshaper(sst::waveshapers::WaveshaperType type)
+{
+    switch (type)
+    {
+    case sst::waveshapers::WaveshaperType::wst_asym:
+        return asym;
+    case sst::waveshapers::WaveshaperType::wst_sine:
+        return sine;
+    default:
+        break;
+    }
+
+    return nullptr;
+}
+} // namespace WaveshaperApprox
+} // namespace Surge
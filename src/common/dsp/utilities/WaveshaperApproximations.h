@@ -0,0 +1,66 @@
+/*
+ * Surge XT - a free and open source hybrid synthesizer,
+ * built by Surge Synth Team
+ *
+ * Learn more at https://surge-synthesizer.github.io/
+ *
+ * Copyright 2018-2024, various authors, as described in the GitHub
+ * transaction log.
+ *
+ * Surge XT is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * Surge was a commercial product from 2004-2018, copyright and ownership
+ * held by Claes Johanson at Vember Audio during that period.
+ * Claes made Surge open source in September 2018.
+ *
+ * All source for Surge XT is available at
+ * https://github.com/surge-synthesizer/surge
+ */
+
+#ifndef SURGE_SRC_COMMON_DSP_UTILITIES_WAVESHAPERAPPROXIMATIONS_H
+#define SURGE_SRC_COMMON_DSP_UTILITIES_WAVESHAPERAPPROXIMATIONS_H
+
+#include "globals.h"
+#include "sst/waveshapers.h"
+
+/*
+ * Table free versions of the quad waveshapers which sst-waveshapers evaluates by looking up
+ * its 1024 point tables. Those lookups compute four indices in SIMD, pull them out into
+ * scalars to read the table and put the results back together, and with a few shapes in use
+ * the tables are also a fair chunk of cache. These compute the curve the table was sampled
+ * from directly, four lanes at a time.
+ *
+ * Asymmetric: (e^y - e^-1.2y) / (e^y + e^-y) - c, where y = x + 1/2 and c is its value at
+ *     x = 0, over the table's x range of [-16, 16). Within 4e-7 of the curve (relative to
+ *     it, where the curve goes past -1).
+ * Sine: sin(pi x / 2) over the table's range of [-2, 2]. Within 2e-7 of the curve.
+ *
+ * The tables interpolate linearly between points 1/32 (asymmetric) and 1/256 (sine) apart,
+ * so they are themselves around 1e-4 and 5e-6 away from the curve, and that is the size of
+ * the difference between the two paths. As with the tables, inputs beyond the range are
+ * clamped to it.
+ *
+ * Soft, hard and digital are already arithmetic in sst-waveshapers. The fuzz shapes are
+ * tables of a curve with noise added, which no polynomial will follow, so they stay tables.
+ *
+ * Which path the filter block uses is up to SurgeStorage::approximateWaveshapers, which the
+ * user sets per instance in Settings > Processing.
+ */
+namespace Surge
+{
+namespace WaveshaperApprox
+{
+__m128 asym(sst::waveshapers::QuadWaveshaperState *__restrict, __m128 in, __m128 drive);
+__m128 sine(sst::waveshapers::QuadWaveshaperState *__restrict, __m128 in, __m128 drive);
+
+/*
+ * The approximation for a shape, or nullptr if there isn't one.
+ */
+sst::waveshapers::QuadWaveshaperPtr GetQuadWaveshaper(sst::waveshapers::WaveshaperType type);
+} // namespace WaveshaperApprox
+} // namespace Surge
+
+#endif // SURGE_SRC_COMMON_DSP_UTILITIES_WAVESHAPERAPPROXIMATIONS_H
@@ -22,8 +22,15 @@
 #include "HeadlessUtils.h"
 #include "Player.h"
 #include "filesystem/import.h"
+#include "StringOscillator.h"
+#include "WindowOscillator.h"
+#include "ClassicOscillator.h"
+#include "CPUFeatures.h"
+#include "QuadFilterChain.h"
+#include "WaveshaperApproximations.h"
 #include <iostream>
 #include <sstream>
+#include <iomanip>
 #include <chrono>
 #include <deque>
 
@@ -743,6 +750,451 @@ void generateNLFeedbackNorms()
               << "      if (useNormalization) normNumerator = lpNormTable[subtype];\n";
 }
 
+void wavetableCacheBenchmark()
+{
+    /*
+     * Times loading every factory wavetable three ways: without the disk cache, into an
+     * empty disk cache (build plus write, which is what a first session pays) and from a
+     * populated disk cache. Each table is released before the next is loaded so the in-memory
+     * WavetableCache never hits.
+     *
+     * Run with surge-testrunner --non-test --wavetable-cache-benchmark
+     */
+    auto surge = Surge::Headless::createSurge(48000, true);
+    auto &storage = surge->storage;
+
+    if (!storage.userDataPathValid)
+    {
+        std::cout << "User data path is not valid, so the disk cache is disabled" << std::endl;
+        return;
+    }
+
+    std::vector<std::string> paths;
+    for (const auto &w : storage.wt_list)
+    {
+        if (w.category >= 0 && w.category < (int)storage.wt_category.size() &&
+            storage.wt_category[w.category].isFactory)
+        {
+            paths.push_back(path_to_string(w.path));
+        }
+    }
+
+    // a scratch directory so we neither use nor disturb the user's cache
+    auto cacheDir = fs::temp_directory_path() / "surge-wavetable-cache-benchmark";
+    std::error_code ec;
+    fs::remove_all(cacheDir, ec);
+
+    auto origCachePath = storage.userWavetableCachePath;
+    auto origUseCache = storage.useWavetableDiskCache;
+    storage.userWavetableCachePath = cacheDir;
+
+    auto loadAll = [&](bool useDiskCache) {
+        storage.useWavetableDiskCache = useDiskCache;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const auto &p : paths)
+        {
+            auto wt = std::make_unique<Wavetable>();
+            storage.load_wt(p, wt.get(), nullptr);
+        }
+        // cache writes happen in the background, but count them for the cold pass
+        storage.wavetableDiskCacheWriter.flush();
+        auto end = std::chrono::high_resolution_clock::now();
+
+        return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+    };
+
+    std::cout << "Loading " << paths.size() << " factory wavetables" << std::endl;
+
+    double uncached = 1e9, cold = 1e9, warm = 1e9;
+    for (int i = 0; i < 5; ++i)
+    {
+        uncached = std::min(uncached, loadAll(false));
+
+        fs::remove_all(cacheDir, ec);
+        cold = std::min(cold, loadAll(true));
+        warm = std::min(warm, loadAll(true));
+    }
+
+    uintmax_t cacheBytes = 0;
+    for (const auto &f : fs::directory_iterator(cacheDir, ec))
+    {
+        cacheBytes += fs::file_size(f.path(), ec);
+    }
+
+    std::cout << "Best of 5 (ms)\n"
+              << "  no disk cache : " << uncached << "\n"
+              << "  cold (write)  : " << cold << "\n"
+              << "  warm (read)   : " << warm << "\n"
+              << "  speedup       : " << uncached / warm << "x\n"
+              << "  cache on disk : " << cacheBytes / 1024 << " kB" << std::endl;
+
+    fs::remove_all(cacheDir, ec);
+    storage.userWavetableCachePath = origCachePath;
+    storage.useWavetableDiskCache = origUseCache;
+}
+
+void stringDelayFootprint()
+{
+    /*
+     * Renders 64 String oscillator voices spread over five octaves twice: with the pitch
+     * tiered delay lines, and with the 16k lines for every voice (which the display
+     * oscillator still uses, so we borrow its init path). Reports the delay memory each way
+     * and the render time, which is where the smaller cache footprint shows.
+     *
+     * Run with surge-testrunner --non-test --string-delay-footprint
+     */
+    auto surge = Surge::Headless::createSurge(48000);
+    auto storage = &surge->storage;
+    auto oscstorage = &(storage->getPatch().scene[0].osc[0]);
+
+    static constexpr int nVoices = 64, nBlocks = 4000;
+
+    struct alignas(16) OscBuffer
+    {
+        unsigned char b[oscillator_buffer_size];
+    };
+    auto buffers = std::make_unique<OscBuffer[]>(nVoices);
+
+    auto run = [&](bool allLong) {
+        std::array<StringOscillator *, nVoices> oscs;
+        size_t bytes = 0;
+
+        for (int v = 0; v < nVoices; ++v)
+        {
+            auto o = spawn_osc(ot_string, storage, oscstorage, storage->getPatch().scenedata[0],
+                               buffers[v].b);
+            o->init_ctrltypes();
+            o->init_default_values();
+            o->init_extra_config();
+            o->init(36 + 60.f * v / nVoices, allLong, false);
+
+            oscs[v] = static_cast<StringOscillator *>(o);
+
+            switch (oscs[v]->delayTier)
+            {
+            case StringOscillator::delay_short:
+                bytes += 2 * sizeof(StringOscillator::delayShort_t);
+                break;
+            case StringOscillator::delay_medium:
+                bytes += 2 * sizeof(StringOscillator::delayMedium_t);
+                break;
+            case StringOscillator::delay_long:
+                bytes += 2 * sizeof(StringOscillator::delayLong_t);
+                break;
+            }
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int b = 0; b < nBlocks; ++b)
+        {
+            for (int v = 0; v < nVoices; ++v)
+            {
+                oscs[v]->process_block(36 + 60.f * v / nVoices, 0, false);
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+
+        for (auto o : oscs)
+        {
+            o->~StringOscillator();
+        }
+
+        auto ms =
+            std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+
+        std::cout << (allLong ? "  16k lines : " : "  tiered    : ") << bytes / 1024 << " kB, "
+                  << ms << " ms" << std::endl;
+    };
+
+    std::cout << "String delay lines for " << nVoices << " voices, " << nBlocks << " blocks"
+              << std::endl;
+    run(true);
+    run(false);
+}
+
+void windowOscillatorBenchmark()
+{
+    /*
+     * Times a held four note chord through the whole synth with the Window oscillator in
+     * each of its window shapes, next to Classic at the same unison count.
+     *
+     * Run with surge-testrunner --non-test --window-osc-benchmark
+     */
+    static constexpr int nBlocks = 10000;
+
+    auto timeChord = [](int oscType, int window, int unison) {
+        auto surge = Surge::Headless::createSurge(48000, true);
+        auto &osc = surge->storage.getPatch().scene[0].osc[0];
+
+        osc.queue_type = oscType;
+        for (int i = 0; i < 10; ++i)
+            surge->process();
+
+        if (oscType == ot_window)
+        {
+            osc.p[WindowOscillator::win_window].val.i = window;
+            osc.p[WindowOscillator::win_unison_voices].val.i = unison;
+        }
+        else
+        {
+            osc.p[ClassicOscillator::co_unison_voices].val.i = unison;
+        }
+
+        for (auto n : {48, 55, 60, 64})
+            surge->playNote(0, n, 127, 0);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int b = 0; b < nBlocks; ++b)
+            surge->process();
+        auto end = std::chrono::high_resolution_clock::now();
+
+        return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+    };
+
+    for (auto unison : {1, 4, 8, 15})
+    {
+        std::cout << "Unison " << unison << ", " << nBlocks << " blocks\n"
+                  << "  Classic  : " << timeChord(ot_classic, 0, unison) << " ms" << std::endl;
+
+        for (int w = 0; w < 9; ++w)
+        {
+            std::cout << "  " << std::setw(9) << std::left << window_names[w]
+                      << ": " << timeChord(ot_window, w, unison) << " ms" << std::endl;
+        }
+    }
+}
+
+void filterChainBenchmark()
+{
+    /*
+     * Times sixteen held voices through the whole synth with each filter type in filter 1,
+     * with the filter block running four voices at a time and eight at a time. The rest of
+     * the synth is the same in both, so the difference is the filter chain.
+     *
+     * Run with surge-testrunner --non-test --filter-chain-benchmark
+     */
+    using namespace Surge::CPUFeatures;
+    static constexpr int nBlocks = 5000;
+
+    if (detectedSIMDLevel() < simd_avx2_fma)
+    {
+        std::cout << "This machine doesn't support AVX2/FMA, so there is no 8 voice chain"
+                  << std::endl;
+        return;
+    }
+
+    auto timeVoices = [](int type, SIMDLevel level) {
+        setMaximumSIMDLevel(level);
+
+        auto surge = Surge::Headless::createSurge(48000, true);
+        surge->storage.useOctFilterChain = true;
+        surge->storage.useFixedFilterChains = false;
+        surge->storage.getPatch().scene[0].filterunit[0].type.val.i = type;
+        surge->storage.getPatch().scene[0].filterunit[0].subtype.val.i = 0;
+
+        for (int i = 0; i < 10; ++i)
+            surge->process();
+
+        for (int n = 0; n < 16; ++n)
+            surge->playNote(0, 36 + 3 * n, 127, 0);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int b = 0; b < nBlocks; ++b)
+            surge->process();
+        auto end = std::chrono::high_resolution_clock::now();
+
+        setMaximumSIMDLevel(simd_avx2_fma);
+
+        return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+    };
+
+    std::cout << "16 voices, " << nBlocks << " blocks: 4 lane / 8 lane ms" << std::endl;
+
+    for (int ft = 0; ft < sst::filters::num_filter_types; ++ft)
+    {
+        auto quad = timeVoices(ft, simd_sse2);
+        auto oct = timeVoices(ft, simd_avx2_fma);
+
+        std::cout << "  " << std::setw(24) << std::left << sst::filters::filter_type_names[ft]
+                  << ": " << quad << " / " << oct << std::endl;
+    }
+}
+
+void fixedFilterChainBenchmark()
+{
+    /*
+     * Times the filter chain on its own for every filter type and subtype which has a chain
+     * with the kernel compiled in, against the generic chain calling it through a pointer,
+     * in each filter configuration.
+     *
+     * Run with surge-testrunner --non-test --fixed-filter-chain-benchmark
+     */
+    using namespace sst::filters;
+    static constexpr int nBlocks = 20000;
+
+    auto surge = Surge::Headless::createSurge(48000, true);
+    auto *Q = new QuadFilterChainState();
+
+    auto timeChain = [Q](FBQFPtr chain, fbq_global &g) {
+        float OutL[BLOCK_SIZE_OS], OutR[BLOCK_SIZE_OS];
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int b = 0; b < nBlocks; ++b)
+        {
+            memset(OutL, 0, sizeof(OutL));
+            memset(OutR, 0, sizeof(OutR));
+            chain(*Q, g, OutL, OutR);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+
+        return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+    };
+
+    std::cout << "4 voices, " << nBlocks << " blocks: pointer / fixed ms" << std::endl;
+
+    for (int ft = 0; ft < num_filter_types; ++ft)
+    {
+        for (int fst = 0; fst < std::max(1, fut_subcount[ft]); ++fst)
+        {
+            fbq_global g;
+            g.FU1ptr = GetQFPtrFilterUnit((FilterType)ft, (FilterSubType)fst);
+            g.FU2ptr = nullptr;
+            g.WSptr = nullptr;
+
+            if (!GetFixedFBQPointer(fc_serial1, g))
+                continue;
+
+            std::cout << "  " << filter_type_names[ft] << " subtype " << fst << std::endl;
+
+            for (int c = 0; c < n_filter_configs; ++c)
+            {
+                InitQuadFilterChainStateToZero(Q);
+
+                FilterCoefficientMaker<SurgeStorage> cm;
+                cm.MakeCoeffs(0.f, 0.5f, (FilterType)ft, (FilterSubType)fst, &surge->storage,
+                              false);
+
+                for (int e = 0; e < 4; ++e)
+                {
+                    for (int u = 0; u < 4; ++u)
+                    {
+                        cm.updateState(Q->FU[u], e);
+                        Q->FU[u].active[e] = 0xffffffff;
+                    }
+
+                    ((float *)&Q->Gain)[e] = 1.f;
+                    ((float *)&Q->Mix1)[e] = 1.f;
+                    ((float *)&Q->Mix2)[e] = 1.f;
+                    ((float *)&Q->OutL)[e] = 0.25f;
+                    ((float *)&Q->OutR)[e] = 0.25f;
+                    ((float *)&Q->Out2L)[e] = 0.25f;
+                    ((float *)&Q->Out2R)[e] = 0.25f;
+                }
+
+                for (int k = 0; k < BLOCK_SIZE_OS; ++k)
+                {
+                    Q->DL[k] = _mm_set1_ps(sinf(k * 0.1f));
+                    Q->DR[k] = _mm_set1_ps(cosf(k * 0.1f));
+                }
+
+                auto generic = timeChain(GetFBQPointer(c, true, false, false), g);
+                auto fixed = timeChain(GetFixedFBQPointer(c, g), g);
+
+                std::cout << "    " << std::setw(16) << std::left << fbc_names[c] << ": "
+                          << generic << " / " << fixed << std::endl;
+            }
+        }
+    }
+
+    delete Q;
+}
+
+void waveshaperApproxBenchmark()
+{
+    /*
+     * Times the filter chain with just the waveshaper in it, using the table shaper and then
+     * the approximation, for each shape which has an approximation. Also prints the largest
+     * difference between the two over the table's range.
+     *
+     * Run with surge-testrunner --non-test --waveshaper-approx-benchmark
+     */
+    using namespace sst::waveshapers;
+    static constexpr int nBlocks = 20000;
+
+    auto *Q = new QuadFilterChainState();
+
+    auto timeChain = [Q](fbq_global &g) {
+        float OutL[BLOCK_SIZE_OS], OutR[BLOCK_SIZE_OS];
+        auto chain = GetFBQPointer(fc_serial1, false, true, false);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int b = 0; b < nBlocks; ++b)
+        {
+            memset(OutL, 0, sizeof(OutL));
+            memset(OutR, 0, sizeof(OutR));
+            chain(*Q, g, OutL, OutR);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+
+        return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+    };
+
+    std::cout << "4 voices, " << nBlocks << " blocks: table / approximation ms, max difference"
+              << std::endl;
+
+    for (int wst = 0; wst < (int)WaveshaperType::n_ws_types; ++wst)
+    {
+        auto approx = Surge::WaveshaperApprox::GetQuadWaveshaper((WaveshaperType)wst);
+
+        if (!approx)
+            continue;
+
+        auto table = sst::waveshapers::GetQuadWaveshaper((WaveshaperType)wst);
+
+        InitQuadFilterChainStateToZero(Q);
+
+        for (int e = 0; e < 4; ++e)
+        {
+            ((float *)&Q->Gain)[e] = 1.f;
+            ((float *)&Q->Drive)[e] = 2.f + e;
+            ((float *)&Q->OutL)[e] = 0.25f;
+            ((float *)&Q->OutR)[e] = 0.25f;
+        }
+
+        for (int k = 0; k < BLOCK_SIZE_OS; ++k)
+        {
+            Q->DL[k] = _mm_set1_ps(sinf(k * 0.1f));
+            Q->DR[k] = _mm_set1_ps(cosf(k * 0.1f));
+        }
+
+        fbq_global g;
+        g.FU1ptr = nullptr;
+        g.FU2ptr = nullptr;
+
+        g.WSptr = table;
+        auto tableMs = timeChain(g);
+        g.WSptr = approx;
+        auto approxMs = timeChain(g);
+
+        float maxDiff = 0.f;
+        for (int i = -100000; i < 100000; ++i)
+        {
+            float a[4], b[4];
+            auto x = _mm_set1_ps(i * 0.0002f);
+            initializeWaveshaperRegister((WaveshaperType)wst, Q->WSS[0].R);
+            _mm_storeu_ps(a, table(&Q->WSS[0], x, _mm_set1_ps(1.f)));
+            _mm_storeu_ps(b, approx(&Q->WSS[0], x, _mm_set1_ps(1.f)));
+            maxDiff = std::max(maxDiff, std::fabs(a[0] - b[0]));
+        }
+
+        std::cout << "  " << std::setw(16) << std::left << wst_names[wst] << ": " << tableMs
+                  << " / " << approxMs << ", " << maxDiff << std::endl;
+    }
+
+    delete Q;
+}
+
 } // namespace NonTest
 } // namespace Headless
 } // namespace Surge
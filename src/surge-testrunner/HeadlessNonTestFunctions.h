@@ -34,6 +34,12 @@ void restreamTemplatesWithModifications();
 void statsFromPlayingEveryPatch();
 void filterAnalyzer(int ft, int fst, std::ostream &os);
 void generateNLFeedbackNorms();
+void wavetableCacheBenchmark();
+void stringDelayFootprint();
+void windowOscillatorBenchmark();
+void filterChainBenchmark();
+void fixedFilterChainBenchmark();
+void waveshaperApproxBenchmark();
 [[noreturn]] void performancePlay(const std::string &patchName, int mode);
 } // namespace NonTest
 } // namespace Headless
@@ -21,6 +21,7 @@
  */
 #include <iostream>
 #include <algorithm>
+#include <random>
 
 #include "HeadlessUtils.h"
 #include "Player.h"
@@ -37,6 +38,14 @@
 
 #include "sst/plugininfra/cpufeatures.h"
 
+#include "CPUFeatures.h"
+#include "OscillatorSIMDKernels.h"
+#include "ClassicOscillator.h"
+#include "StringOscillator.h"
+#include "TwistOscillator.h"
+#include "SurgeMemoryPools.h"
+#include "SceneOutputStage.h"
+
 using namespace Surge::Test;
 
 TEST_CASE("Simple Single Oscillator is Constant", "[osc]")
@@ -818,4 +827,506 @@ TEST_CASE("Oscillator Onset", "[dsp]") // See issue 7570
                       << std::endl;*/
         }
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Classic Oscillator AVX2 Matches SSE2", "[osc]")
+{
+    using namespace Surge::CPUFeatures;
+
+    if (detectedSIMDLevel() < simd_avx2_fma)
+    {
+        SKIP("This machine doesn't support AVX2/FMA");
+    }
+
+    SECTION("Kernels")
+    {
+        auto surge = Surge::Headless::createSurge(44100);
+        auto &sse = Surge::Oscillator::blitKernelsFor(simd_sse2);
+        auto &avx = Surge::Oscillator::blitKernelsFor(simd_avx2_fma);
+
+        float bufSSE[64], bufAVX[64], bufSSER[64], bufAVXR[64];
+        std::fill(bufSSE, bufSSE + 64, 0.f);
+        std::fill(bufAVX, bufAVX + 64, 0.f);
+        std::fill(bufSSER, bufSSER + 64, 0.f);
+        std::fill(bufAVXR, bufAVXR + 64, 0.f);
+
+        for (int i = 0; i < 5000; ++i)
+        {
+            auto off = (int)(surge->storage.rand_01() * (64 - FIRipol_N));
+            auto row = (int)(surge->storage.rand_01() * 255) * (FIRipol_N << 1);
+            auto lipol = (float)(int)(surge->storage.rand_01() * 0xffff);
+            auto g = surge->storage.rand_pm1();
+            auto sinc = &surge->storage.sinctable[row];
+
+            sse.convolve(&bufSSE[off], sinc, lipol, g);
+            avx.convolve(&bufAVX[off], sinc, lipol, g);
+            sse.convolveStereo(&bufSSE[off], &bufSSER[off], sinc, lipol, g, -g);
+            avx.convolveStereo(&bufAVX[off], &bufAVXR[off], sinc, lipol, g, -g);
+        }
+
+        for (int i = 0; i < 64; ++i)
+        {
+            INFO("Sample " << i);
+            REQUIRE(bufAVX[i] == Approx(bufSSE[i]).margin(1e-4));
+            REQUIRE(bufAVXR[i] == Approx(bufSSER[i]).margin(1e-4));
+        }
+    }
+
+    SECTION("Oscillator Output")
+    {
+        for (auto fm : {false, true})
+        {
+            auto render = [fm](SIMDLevel level) {
+                setMaximumSIMDLevel(level);
+
+                auto surge = Surge::Headless::createSurge(48000);
+                auto storage = &surge->storage;
+                auto oscstorage = &(storage->getPatch().scene[0].osc[0]);
+
+                unsigned char oscbuffer alignas(16)[oscillator_buffer_size];
+                float fmbuffer alignas(16)[BLOCK_SIZE_OS];
+
+                auto o = spawn_osc(ot_classic, storage, oscstorage,
+                                   storage->getPatch().scenedata[0], oscbuffer);
+                o->init_ctrltypes();
+                o->init_default_values();
+                o->init_extra_config();
+                oscstorage->retrigger.val.b = true;
+                oscstorage->p[ClassicOscillator::co_unison_voices].val.i = MAX_UNISON;
+                o->assign_fm(fmbuffer);
+                o->init(48);
+
+                std::vector<float> res;
+                double fmphase = 0;
+
+                for (int b = 0; b < 200; ++b)
+                {
+                    for (int i = 0; i < BLOCK_SIZE_OS; ++i)
+                    {
+                        fmbuffer[i] = std::sin(fmphase);
+                        fmphase += 0.03;
+                    }
+
+                    o->process_block(48, 0, true, fm, 0.3);
+
+                    for (int i = 0; i < BLOCK_SIZE_OS; ++i)
+                    {
+                        res.push_back(o->output[i]);
+                        res.push_back(o->outputR[i]);
+                    }
+                }
+
+                o->~Oscillator();
+                setMaximumSIMDLevel(simd_avx2_fma);
+
+                return res;
+            };
+
+            auto sseRes = render(simd_sse2);
+            auto avxRes = render(simd_avx2_fma);
+
+            REQUIRE(sseRes.size() == avxRes.size());
+
+            for (auto i = 0U; i < sseRes.size(); ++i)
+            {
+                INFO("FM " << fm << " sample " << i);
+                REQUIRE(avxRes[i] == Approx(sseRes[i]).margin(1e-4));
+            }
+        }
+    }
+}
+
+TEST_CASE("String Oscillator Delay Tiers Match The Long Line", "[osc]")
+{
+    /*
+     * The display oscillator always uses the long delay lines, so render a voice both ways
+     * with a deterministic exciter and compare, including a slow glide down which forces
+     * the tiered voice onto a longer line part way through.
+     */
+    auto render = [](bool longLine, float startPitch, float endPitch, int blocks,
+                     std::vector<StringOscillator::delay_tiers> &tiers) {
+        auto surge = Surge::Headless::createSurge(44100);
+        auto storage = &surge->storage;
+        auto oscstorage = &(storage->getPatch().scene[0].osc[0]);
+
+        unsigned char oscbuffer alignas(16)[oscillator_buffer_size];
+
+        auto o = spawn_osc(ot_string, storage, oscstorage, storage->getPatch().scenedata[0],
+                           oscbuffer);
+        o->init_ctrltypes();
+        o->init_default_values();
+        o->init_extra_config();
+        oscstorage->retrigger.val.b = true;
+        oscstorage->p[StringOscillator::str_exciter_mode].val.i = StringOscillator::burst_sine;
+        o->init(startPitch, longLine, false);
+
+        auto so = static_cast<StringOscillator *>(o);
+        std::vector<float> res;
+
+        for (int b = 0; b < blocks; ++b)
+        {
+            auto pitch = startPitch + (endPitch - startPitch) * b / blocks;
+            o->process_block(pitch, 0, false);
+            tiers.push_back(so->delayTier);
+
+            for (int i = 0; i < BLOCK_SIZE_OS; ++i)
+                res.push_back(o->output[i]);
+        }
+
+        o->~Oscillator();
+        return res;
+    };
+
+    SECTION("Steady Pitches")
+    {
+        for (auto pitch : {96.f, 72.f, 48.f, 24.f})
+        {
+            std::vector<StringOscillator::delay_tiers> lt, tt;
+            auto longRes = render(true, pitch, pitch, 100, lt);
+            auto tieredRes = render(false, pitch, pitch, 100, tt);
+
+            REQUIRE(lt.back() == StringOscillator::delay_long);
+            if (pitch > 60)
+                REQUIRE(tt.back() == StringOscillator::delay_short);
+
+            REQUIRE(longRes.size() == tieredRes.size());
+            for (auto i = 0U; i < longRes.size(); ++i)
+            {
+                INFO("Pitch " << pitch << " sample " << i);
+                REQUIRE(tieredRes[i] == longRes[i]);
+            }
+        }
+    }
+
+    SECTION("Gliding Down Promotes")
+    {
+        std::vector<StringOscillator::delay_tiers> lt, tt;
+        auto longRes = render(true, 84, 24, 1200, lt);
+        auto tieredRes = render(false, 84, 24, 1200, tt);
+
+        REQUIRE(tt.front() == StringOscillator::delay_short);
+        REQUIRE(tt.back() == StringOscillator::delay_medium);
+
+        REQUIRE(longRes.size() == tieredRes.size());
+        for (auto i = 0U; i < longRes.size(); ++i)
+        {
+            INFO("Sample " << i);
+            REQUIRE(tieredRes[i] == longRes[i]);
+        }
+    }
+
+    SECTION("Pitch Modulation Depth Picks A Longer Line")
+    {
+        auto surge = Surge::Headless::createSurge(44100);
+        auto storage = &surge->storage;
+        auto &scene = storage->getPatch().scene[0];
+        auto oscstorage = &scene.osc[0];
+
+        auto startTier = [&]() {
+            unsigned char oscbuffer alignas(16)[oscillator_buffer_size];
+            auto o = spawn_osc(ot_string, storage, oscstorage, storage->getPatch().scenedata[0],
+                               oscbuffer);
+            o->init_ctrltypes();
+            o->init_default_values();
+            o->init(96, false, false);
+            auto res = static_cast<StringOscillator *>(o)->delayTier;
+            o->~Oscillator();
+            return res;
+        };
+
+        REQUIRE(startTier() == StringOscillator::delay_short);
+
+        ModulationRouting r;
+        r.source_id = ms_lfo1;
+        r.destination_id = oscstorage->pitch.param_id_in_scene;
+        r.depth = 48.f;
+        scene.modulation_voice.push_back(r);
+
+        REQUIRE(startTier() == StringOscillator::delay_medium);
+
+        scene.modulation_voice.back().muted = true;
+        REQUIRE(startTier() == StringOscillator::delay_short);
+    }
+}
+
+TEST_CASE("Twist Oscillator Reuses Pooled Resources", "[osc]")
+{
+    // at 48k the oversampled rate is twice plaits' and takes the integer ratio path
+    for (auto sr : {44100, 48000})
+    {
+        DYNAMIC_SECTION("Sample Rate " << sr)
+        {
+            auto surge = Surge::Headless::createSurge(sr);
+            auto storage = &surge->storage;
+            auto oscstorage = &(storage->getPatch().scene[0].osc[0]);
+            auto &pool = storage->memoryPools->twistResources.pool;
+
+            oscstorage->retrigger.val.b = true;
+
+            auto render = [&](int &ratio) {
+                unsigned char oscbuffer alignas(16)[oscillator_buffer_size];
+                auto o = spawn_osc(ot_twist, storage, oscstorage,
+                                   storage->getPatch().scenedata[0], oscbuffer);
+                o->init_ctrltypes();
+                o->init_default_values();
+                o->init_extra_config();
+                o->init(60);
+
+                ratio = static_cast<TwistOscillator *>(o)->plaitsRatio;
+
+                std::vector<float> res;
+                for (int b = 0; b < 200; ++b)
+                {
+                    o->process_block(60, 0, true, false, 0);
+                    res.insert(res.end(), o->output, o->output + BLOCK_SIZE_OS);
+                }
+
+                o->~Oscillator();
+                return res;
+            };
+
+            auto held = pool.position;
+            int ratioA, ratioB;
+            auto first = render(ratioA);
+            REQUIRE(pool.position == held);
+            auto second = render(ratioB);
+
+            REQUIRE(ratioA == (sr == 48000 ? 2 : 0));
+            REQUIRE(ratioB == ratioA);
+            REQUIRE(first == second);
+
+            float peak = 0;
+            for (auto f : first)
+            {
+                REQUIRE(std::isfinite(f));
+                peak = std::max(peak, std::fabs(f));
+            }
+            REQUIRE(peak > 0.1);
+        }
+    }
+}
+
+TEST_CASE("Oscillator Prototypes Match Spawned Oscillators", "[osc]")
+{
+    for (auto ot : {ot_classic, ot_sine, ot_modern, ot_alias})
+    {
+        DYNAMIC_SECTION("Oscillator Type " << osc_type_names[ot])
+        {
+            auto surge = Surge::Headless::createSurge(48000);
+            auto storage = &surge->storage;
+            auto oscstorage = &(storage->getPatch().scene[0].osc[0]);
+            auto sceneParams = storage->getPatch().scenedata[0];
+
+            {
+                unsigned char setupbuffer alignas(16)[oscillator_buffer_size];
+                oscstorage->type.val.i = ot;
+                auto o = spawn_osc(ot, storage, oscstorage, sceneParams, setupbuffer);
+                o->init_ctrltypes();
+                o->init_default_values();
+                o->init_extra_config();
+                o->~Oscillator();
+            }
+            oscstorage->retrigger.val.b = true;
+
+            auto render = [&](Oscillator *o) {
+                std::vector<float> res;
+                for (int b = 0; b < 50; ++b)
+                {
+                    o->process_block(57, 0, true, false, 0);
+                    res.insert(res.end(), o->output, o->output + BLOCK_SIZE_OS);
+                    res.insert(res.end(), o->outputR, o->outputR + BLOCK_SIZE_OS);
+                }
+                o->~Oscillator();
+                return res;
+            };
+
+            unsigned char oscbuffer alignas(16)[oscillator_buffer_size];
+            auto spawned = spawn_osc(ot, storage, oscstorage, sceneParams, oscbuffer);
+            spawned->init(57, false, false);
+            auto reference = render(spawned);
+
+            auto proto = std::make_unique<OscillatorPrototype>();
+            auto cloned = render(proto->spawnVoice(ot, storage, oscstorage, sceneParams,
+                                                   sceneParams, oscbuffer, 57, false));
+            REQUIRE(proto->osc);
+            REQUIRE(cloned == reference);
+
+            // a second voice reuses the prototype
+            auto protoOsc = proto->osc;
+            auto again = render(proto->spawnVoice(ot, storage, oscstorage, sceneParams,
+                                                  sceneParams, oscbuffer, 57, false));
+            REQUIRE(proto->osc == protoOsc);
+            REQUIRE(again == reference);
+
+            // and a patch change which the prototype depends on makes it stale
+            REQUIRE(proto->isCurrentFor(ot));
+            storage->getPatch().character.val.i = (storage->getPatch().character.val.i + 1) % 3;
+            REQUIRE(!proto->isCurrentFor(ot));
+            REQUIRE(!proto->isCurrentFor(ot_wavetable));
+        }
+    }
+}
+
+TEST_CASE("Oscillator Fast Sine", "[osc]")
+{
+    using namespace Surge::Oscillator;
+
+    SECTION("Sine And Cosine Are Within Bounds")
+    {
+        std::mt19937 gen(2112);
+
+        for (auto range : {(float)M_PI, 10.f, 100.f, 1000.f, 10000.f})
+        {
+            std::uniform_real_distribution<float> dist(-range, range);
+            float maxErr = 0;
+
+            for (int i = 0; i < 100000; ++i)
+            {
+                float x alignas(16)[4], sv alignas(16)[4], cv alignas(16)[4];
+                for (auto &xv : x)
+                    xv = dist(gen);
+
+                __m128 s, c;
+                FastSine::sincos(_mm_load_ps(x), s, c);
+                _mm_store_ps(sv, s);
+                _mm_store_ps(cv, c);
+
+                for (int j = 0; j < 4; ++j)
+                {
+                    maxErr = std::max(maxErr, (float)std::fabs(sv[j] - std::sin((double)x[j])));
+                    maxErr = std::max(maxErr, (float)std::fabs(cv[j] - std::cos((double)x[j])));
+                }
+            }
+
+            INFO("Range " << range);
+            REQUIRE(maxErr < 5e-7);
+        }
+    }
+
+    SECTION("Quadrature Lanes Track Their Phases")
+    {
+        QuadrOscSSE q;
+        double rate[4] = {0.001, 0.01, 0.1, 1.0}, start[4] = {0, 0.5, -1, 3};
+
+        for (int l = 0; l < 4; ++l)
+            q.set_phase(l, start[l]);
+
+        float maxErr = 0;
+        for (int b = 0; b < 30; ++b)
+        {
+            // oscillators set their rate every block, which also renormalizes
+            for (int l = 0; l < 4; ++l)
+                q.set_rate(l, rate[l]);
+
+            auto lanes = q.load();
+            for (int k = 0; k < BLOCK_SIZE_OS; ++k)
+            {
+                lanes.process();
+                q.store(lanes);
+
+                auto n = b * BLOCK_SIZE_OS + k + 1;
+                for (int l = 0; l < 4; ++l)
+                {
+                    auto ph = start[l] + n * (double)(float)rate[l];
+                    maxErr = std::max(maxErr, (float)std::fabs(q.r[l] - std::sin(ph)));
+                    maxErr = std::max(maxErr, (float)std::fabs(q.i[l] + std::cos(ph)));
+                }
+            }
+        }
+        REQUIRE(maxErr < 1e-4);
+    }
+}
+
+TEST_CASE("Scene Output Stage", "[dsp]")
+{
+    auto surge = Surge::Headless::createSurge(48000);
+    REQUIRE(surge);
+
+    auto sos = std::make_unique<SceneOutputStage>(&surge->storage);
+    float sceneout alignas(16)[n_scenes][N_OUTPUTS][BLOCK_SIZE_OS];
+
+    // scene A gets 50Hz, scene B 2kHz, and the low cut is at 440Hz in both
+    auto run = [&](const SurgeStorage::HardClipMode (&clip)[n_scenes], float amp, int slope) {
+        sos->suspendAll();
+        float rms[n_scenes][N_OUTPUTS]{}, peak = 0;
+        int n = 0;
+
+        for (int b = 0; b < 500; ++b)
+        {
+            for (int k = 0; k < BLOCK_SIZE; ++k)
+            {
+                auto t = (b * BLOCK_SIZE + k) / 48000.0;
+                for (int c = 0; c < N_OUTPUTS; ++c)
+                {
+                    sceneout[0][c][k] = amp * std::sin(2 * M_PI * 50 * t);
+                    sceneout[1][c][k] = amp * std::sin(2 * M_PI * 2000 * t);
+                }
+            }
+
+            for (int sc = 0; sc < n_scenes; ++sc)
+                sos->setLowCut(sc, true, 0.f, slope);
+
+            sos->process(sceneout, clip);
+
+            if (b < 100)
+                continue;
+
+            for (int sc = 0; sc < n_scenes; ++sc)
+                for (int c = 0; c < N_OUTPUTS; ++c)
+                    for (int k = 0; k < BLOCK_SIZE; ++k)
+                    {
+                        rms[sc][c] += sceneout[sc][c][k] * sceneout[sc][c][k];
+                        peak = std::max(peak, std::fabs(sceneout[sc][c][k]));
+                    }
+            n += BLOCK_SIZE;
+        }
+
+        for (auto &sc : rms)
+            for (auto &c : sc)
+                c = std::sqrt(c / n);
+
+        return std::make_pair(std::vector<float>{rms[0][0], rms[0][1], rms[1][0], rms[1][1]},
+                              peak);
+    };
+
+    SECTION("Low Cut Steepens With Slope")
+    {
+        const SurgeStorage::HardClipMode bypass[n_scenes] = {SurgeStorage::BYPASS_HARDCLIP,
+                                                             SurgeStorage::BYPASS_HARDCLIP};
+        float last = 1.f;
+
+        for (int slope = 0; slope < SceneOutputStage::n_stages; ++slope)
+        {
+            INFO("Slope " << slope);
+            auto [rms, peak] = run(bypass, 1.f, slope);
+
+            // 50Hz is a bit over three octaves below the cutoff
+            REQUIRE(rms[0] == Approx(rms[1]));
+            REQUIRE(rms[0] < 0.02 / (slope + 1));
+            REQUIRE(rms[0] < last);
+            last = rms[0];
+
+            // and 2kHz two octaves above it, where the low Q costs us a dB per stage
+            REQUIRE(rms[2] == Approx(rms[3]));
+            REQUIRE(rms[2] > M_SQRT1_2 * 0.6);
+            REQUIRE(rms[2] < M_SQRT1_2);
+        }
+    }
+
+    SECTION("Hardclip Per Scene")
+    {
+        const SurgeStorage::HardClipMode clip[n_scenes] = {SurgeStorage::HARDCLIP_TO_0DBFS,
+                                                           SurgeStorage::BYPASS_HARDCLIP};
+        auto [rms, peak] = run(clip, 4.f, 0);
+
+        REQUIRE(rms[2] > 2.5);
+        REQUIRE(peak > 3.5);
+
+        const SurgeStorage::HardClipMode both[n_scenes] = {SurgeStorage::HARDCLIP_TO_0DBFS,
+                                                           SurgeStorage::HARDCLIP_TO_0DBFS};
+        auto [rmsC, peakC] = run(both, 4.f, 0);
+
+        REQUIRE(peakC <= 1.f);
+        REQUIRE(rmsC[2] < 1.f);
+    }
+}
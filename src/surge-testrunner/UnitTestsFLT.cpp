@@ -23,6 +23,7 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <tuple>
 
 #include "HeadlessUtils.h"
 #include "Player.h"
@@ -30,6 +31,10 @@
 #include "catch2/catch_amalgamated.hpp"
 
 #include "UnitTestUtilities.h"
+#include "CPUFeatures.h"
+#include "OctFilterChain.h"
+#include "QuadFilterChain.h"
+#include "WaveshaperApproximations.h"
 
 using namespace Surge::Test;
 
@@ -100,3 +105,333 @@ TEST_CASE("Run Every Waveshaper", "[flt]")
         }
     }
 }
+
+TEST_CASE("Waveshaper Approximations Match The Tables", "[flt]")
+{
+    using namespace sst::waveshapers;
+
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge);
+
+    REQUIRE(Surge::WaveshaperApprox::GetQuadWaveshaper(WaveshaperType::wst_soft) == nullptr);
+
+    for (auto [wst, range, tolerance] : {std::make_tuple(WaveshaperType::wst_asym, 16.f, 1e-3f),
+                                         std::make_tuple(WaveshaperType::wst_sine, 2.f, 1e-4f)})
+    {
+        DYNAMIC_SECTION("Waveshaper " << wst_names[(int)wst])
+        {
+            auto table = sst::waveshapers::GetQuadWaveshaper(wst);
+            auto approx = Surge::WaveshaperApprox::GetQuadWaveshaper(wst);
+            REQUIRE(approx);
+
+            QuadWaveshaperState s;
+            initializeWaveshaperRegister(wst, s.R);
+
+            // the range ends are where the tables stop, so stay a point inside them
+            for (float x = -range * 0.99f; x < range * 0.99f; x += range * 0.001f)
+            {
+                float t[4], a[4];
+                auto drive = _mm_setr_ps(1.f, 0.5f, 0.25f, 2.f);
+                auto in = _mm_div_ps(_mm_set1_ps(x), drive);
+
+                _mm_storeu_ps(t, table(&s, in, drive));
+                _mm_storeu_ps(a, approx(&s, in, drive));
+
+                for (int i = 0; i < 4; ++i)
+                {
+                    INFO("x = " << x << " lane " << i);
+                    REQUIRE(a[i] == Approx(t[i]).margin(tolerance));
+                }
+            }
+
+            // and outside of it both hold their end values, give or take the table's last step
+            float t[4], a[4];
+            auto far = _mm_setr_ps(-4.f * range, -2.f * range, 2.f * range, 4.f * range);
+            _mm_storeu_ps(t, table(&s, far, _mm_set1_ps(1.f)));
+            _mm_storeu_ps(a, approx(&s, far, _mm_set1_ps(1.f)));
+
+            for (int i = 0; i < 4; ++i)
+                REQUIRE(a[i] == Approx(t[i]).margin(0.02));
+        }
+    }
+}
+
+TEST_CASE("Eight Voice Filter Chain Matches Quads", "[flt]")
+{
+    using namespace Surge::CPUFeatures;
+
+    if (detectedSIMDLevel() < simd_avx2_fma)
+    {
+        SKIP("This machine doesn't support AVX2/FMA");
+    }
+
+    REQUIRE(GetFBOctPointer(fc_serial1, true, true, true, simd_sse2) == nullptr);
+
+    for (int q = 0; q < n_filter_configs; ++q)
+    {
+        DYNAMIC_SECTION("Filter Configuration " << fbc_names[q])
+        {
+            /*
+             * Seven voices, so one full quad and one with an inactive lane. Filter 1 is one
+             * without a fixed chain (see GetFixedFBQPointer), which would take over otherwise.
+             */
+            uint64_t octCalls = 0;
+
+            auto render = [q, &octCalls](SIMDLevel level) {
+                setMaximumSIMDLevel(level);
+
+                auto surge = surgeOnSine(48000);
+                surge->storage.useOctFilterChain = true;
+                surge->storage.useFixedFilterChains = false;
+
+                auto &sc = surge->storage.getPatch().scene[0];
+                sc.osc[0].retrigger.val.b = true;
+                sc.filterblock_configuration.val.i = q;
+                sc.filterunit[0].type.val.i = (int)sst::filters::FilterType::fut_bp12;
+                sc.filterunit[1].type.val.i = (int)sst::filters::FilterType::fut_vintageladder;
+                sc.wsunit.type.val.i = (int)sst::waveshapers::WaveshaperType::wst_soft;
+                sc.wsunit.drive.set_value_f01(0.7);
+                sc.feedback.set_value_f01(0.7);
+
+                for (int i = 0; i < 10; ++i)
+                    surge->process();
+
+                for (auto n : {48, 52, 55, 59, 62, 65, 69})
+                    surge->playNote(0, n, 100, 0);
+
+                std::vector<float> res;
+                for (int b = 0; b < 100; ++b)
+                {
+                    surge->process();
+                    res.insert(res.end(), surge->output[0], surge->output[0] + BLOCK_SIZE);
+                    res.insert(res.end(), surge->output[1], surge->output[1] + BLOCK_SIZE);
+                }
+
+                octCalls = surge->octFilterChainCalls;
+                setMaximumSIMDLevel(simd_avx2_fma);
+                return res;
+            };
+
+            auto quadRes = render(simd_sse2);
+            REQUIRE(octCalls == 0);
+
+            auto octRes = render(simd_avx2_fma);
+            REQUIRE(octCalls > 0);
+
+            REQUIRE(quadRes.size() == octRes.size());
+
+            float peak = 0;
+            for (auto i = 0U; i < quadRes.size(); ++i)
+            {
+                INFO("Sample " << i);
+                REQUIRE(octRes[i] == Approx(quadRes[i]).margin(1e-4));
+                peak = std::max(peak, std::fabs(quadRes[i]));
+            }
+            REQUIRE(peak > 0.01);
+        }
+    }
+}
+
+TEST_CASE("Voice Output Is The Same At Every SIMD Level", "[flt]")
+{
+    using namespace Surge::CPUFeatures;
+
+    for (int q = 0; q < n_filter_configs; ++q)
+    {
+        DYNAMIC_SECTION("Filter Configuration " << fbc_names[q])
+        {
+            /*
+             * Four voices, so the generic quad chain runs on its own at every level and only
+             * the oscillator kernels change with it. Filter unit 1 is kept out of the fixed
+             * chain table so that switching those on doesn't change what this covers.
+             */
+            auto render = [q](SIMDLevel level) {
+                setMaximumSIMDLevel(level);
+
+                auto surge = surgeOnSine(48000);
+                surge->storage.useFixedFilterChains = false;
+                auto &sc = surge->storage.getPatch().scene[0];
+                sc.osc[0].retrigger.val.b = true;
+                sc.filterblock_configuration.val.i = q;
+                sc.filterunit[0].type.val.i = (int)sst::filters::FilterType::fut_bp12;
+                sc.filterunit[1].type.val.i = (int)sst::filters::FilterType::fut_hp12;
+                sc.wsunit.type.val.i = (int)sst::waveshapers::WaveshaperType::wst_soft;
+                sc.wsunit.drive.set_value_f01(0.7);
+                sc.feedback.set_value_f01(0.7);
+
+                for (int i = 0; i < 10; ++i)
+                    surge->process();
+
+                for (auto n : {48, 55, 62, 69})
+                    surge->playNote(0, n, 100, 0);
+
+                std::vector<float> res;
+                for (int b = 0; b < 100; ++b)
+                {
+                    surge->process();
+                    res.insert(res.end(), surge->output[0], surge->output[0] + BLOCK_SIZE);
+                    res.insert(res.end(), surge->output[1], surge->output[1] + BLOCK_SIZE);
+                }
+
+                setMaximumSIMDLevel(simd_avx2_fma);
+                return res;
+            };
+
+            auto baseline = render(simd_sse2);
+
+            for (int l = simd_sse2 + 1; l <= detectedSIMDLevel(); ++l)
+            {
+                INFO("Comparing " << simdLevelName((SIMDLevel)l) << " to SSE2");
+                auto res = render((SIMDLevel)l);
+
+                REQUIRE(res.size() == baseline.size());
+
+                // the oscillators use FMA at the top level, so this can't be exact
+                for (auto i = 0U; i < res.size(); ++i)
+                {
+                    INFO("Sample " << i);
+                    REQUIRE(res[i] == Approx(baseline[i]).margin(1e-4));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Filter Coefficients Follow Cutoff After Holding", "[flt]")
+{
+    for (auto ft :
+         {sst::filters::FilterType::fut_lp24, sst::filters::FilterType::fut_vintageladder})
+    {
+        DYNAMIC_SECTION("Filter Type " << sst::filters::filter_type_names[(int)ft])
+        {
+            auto surge = surgeOnSine(48000);
+            auto &sc = surge->storage.getPatch().scene[0];
+            sc.filterunit[0].type.val.i = (int)ft;
+            sc.filterunit[0].subtype.val.i = 0;
+            sc.filterunit[0].cutoff.val.f = 60.f;
+
+            auto rms = [&surge](int blocks) {
+                double sum = 0;
+                for (int b = 0; b < blocks; ++b)
+                {
+                    surge->process();
+                    for (int i = 0; i < BLOCK_SIZE; ++i)
+                        sum += surge->output[0][i] * surge->output[0][i];
+                }
+                return std::sqrt(sum / (blocks * BLOCK_SIZE));
+            };
+
+            for (int i = 0; i < 10; ++i)
+                surge->process();
+
+            surge->playNote(0, 81, 127, 0);
+
+            // long enough for the coefficients to settle and be held
+            rms(500);
+            auto open = rms(100);
+            REQUIRE(open > 0.01);
+
+            // an A5 sine through a lowpass three and a half octaves below it should all but vanish
+            sc.filterunit[0].cutoff.val.f = -30.f;
+            rms(100);
+            auto closed = rms(100);
+            REQUIRE(closed < open * 0.1);
+
+            // and coming back should get us where we started
+            sc.filterunit[0].cutoff.val.f = 60.f;
+            rms(500);
+            REQUIRE(rms(100) == Approx(open).epsilon(0.01));
+        }
+    }
+}
+
+TEST_CASE("Fixed Filter Chains Match The Generic Chain", "[flt]")
+{
+    using namespace sst::filters;
+
+    auto surge = Surge::Headless::createSurge(48000);
+    REQUIRE(surge);
+
+    int fixedChains = 0;
+
+    for (int ft = 0; ft < num_filter_types; ++ft)
+    {
+        for (int fst = 0; fst < std::max(1, fut_subcount[ft]); ++fst)
+        {
+            fbq_global g;
+            g.FU1ptr = GetQFPtrFilterUnit((FilterType)ft, (FilterSubType)fst);
+            g.FU2ptr = GetQFPtrFilterUnit(fut_hp12, st_Standard);
+            g.WSptr =
+                sst::waveshapers::GetQuadWaveshaper(sst::waveshapers::WaveshaperType::wst_soft);
+
+            if (!GetFixedFBQPointer(fc_serial1, g))
+                continue;
+
+            fixedChains++;
+
+            for (int c = 0; c < n_filter_configs; ++c)
+            {
+                INFO("Filter " << filter_type_names[ft] << " subtype " << fst << " config "
+                               << fbc_names[c]);
+
+                auto generic = std::make_unique<QuadFilterChainState>();
+                InitQuadFilterChainStateToZero(generic.get());
+
+                FilterCoefficientMaker<SurgeStorage> cm1, cm2;
+                cm1.MakeCoeffs(12.f, 0.7f, (FilterType)ft, (FilterSubType)fst, &surge->storage,
+                               false);
+                cm2.MakeCoeffs(-12.f, 0.3f, fut_hp12, st_Standard, &surge->storage, false);
+
+                for (int e = 0; e < 4; ++e)
+                {
+                    cm1.updateState(generic->FU[0], e);
+                    cm1.updateState(generic->FU[2], e);
+                    cm2.updateState(generic->FU[1], e);
+                    cm2.updateState(generic->FU[3], e);
+
+                    for (int u = 0; u < 4; ++u)
+                        generic->FU[u].active[e] = 0xffffffff;
+
+                    ((float *)&generic->Gain)[e] = 1.f;
+                    ((float *)&generic->Drive)[e] = 2.f;
+                    ((float *)&generic->FB)[e] = 0.3f;
+                    ((float *)&generic->Mix1)[e] = 0.8f;
+                    ((float *)&generic->Mix2)[e] = 0.6f;
+                    ((float *)&generic->OutL)[e] = 0.25f;
+                    ((float *)&generic->OutR)[e] = 0.25f;
+                    ((float *)&generic->Out2L)[e] = 0.25f;
+                    ((float *)&generic->Out2R)[e] = 0.25f;
+                }
+
+                auto fixed = std::make_unique<QuadFilterChainState>(*generic);
+
+                float gL[BLOCK_SIZE_OS] = {}, gR[BLOCK_SIZE_OS] = {};
+                float fL[BLOCK_SIZE_OS] = {}, fR[BLOCK_SIZE_OS] = {};
+
+                for (int b = 0; b < 20; ++b)
+                {
+                    for (int k = 0; k < BLOCK_SIZE_OS; ++k)
+                    {
+                        generic->DL[k] = _mm_set_ps(sinf(k * 0.1f + b), sinf(k * 0.13f + b),
+                                                    sinf(k * 0.17f + b), sinf(k * 0.19f + b));
+                        generic->DR[k] = _mm_set_ps(cosf(k * 0.1f + b), cosf(k * 0.13f + b),
+                                                    cosf(k * 0.17f + b), cosf(k * 0.19f + b));
+                        fixed->DL[k] = generic->DL[k];
+                        fixed->DR[k] = generic->DR[k];
+                    }
+
+                    GetFBQPointer(c, true, true, true)(*generic, g, gL, gR);
+                    GetFixedFBQPointer(c, g)(*fixed, g, fL, fR);
+
+                    for (int k = 0; k < BLOCK_SIZE_OS; ++k)
+                    {
+                        REQUIRE(fL[k] == gL[k]);
+                        REQUIRE(fR[k] == gR[k]);
+                    }
+                }
+            }
+        }
+    }
+
+    REQUIRE(fixedChains > 0);
+}
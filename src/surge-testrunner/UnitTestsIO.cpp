@@ -22,6 +22,7 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <fstream>
 #include <algorithm>
 
 #include "HeadlessUtils.h"
@@ -95,6 +96,334 @@ TEST_CASE("All Factory Wavetables Are Loadable", "[io]")
     }
 }
 
+TEST_CASE("Wavetable Cache Shares Tables", "[io]")
+{
+    auto surgeA = Surge::Headless::createSurge(44100);
+    auto surgeB = Surge::Headless::createSurge(44100);
+    REQUIRE(surgeA.get());
+    REQUIRE(surgeB.get());
+
+    std::string fn = "resources/test-data/wav/Wavetable.wav";
+
+    auto oscA = &(surgeA->storage.getPatch().scene[0].osc[0]);
+    auto oscB = &(surgeB->storage.getPatch().scene[1].osc[2]);
+
+    surgeA->storage.load_wt(fn, &oscA->wt, oscA);
+    surgeB->storage.load_wt(fn, &oscB->wt, oscB);
+
+    SECTION("Instances Share The Same Memory")
+    {
+        REQUIRE(oscA->wt.getData() == oscB->wt.getData());
+        REQUIRE(oscB->wt.size == 2048);
+        REQUIRE(oscB->wt.n_tables == 256);
+        REQUIRE(oscB->wavetable_display_name == oscA->wavetable_display_name);
+
+        for (int l = 0; l < max_mipmap_levels; ++l)
+        {
+            for (int t = 0; t < (int)oscA->wt.n_tables; ++t)
+            {
+                REQUIRE(oscA->wt.TableF32WeakPointers[l][t] == oscB->wt.TableF32WeakPointers[l][t]);
+                REQUIRE(oscA->wt.TableI16WeakPointers[l][t] == oscB->wt.TableI16WeakPointers[l][t]);
+            }
+        }
+    }
+
+    SECTION("Copies Share And Writes Copy")
+    {
+        auto copy = std::make_unique<Wavetable>();
+        copy->Copy(&oscA->wt);
+        REQUIRE(copy->getData() == oscA->wt.getData());
+
+        auto before = oscA->wt.TableF32WeakPointers[0][3][17];
+
+        wt_header wh;
+        memset(&wh, 0, sizeof(wt_header));
+        wh.n_samples = 256;
+        wh.n_tables = 1;
+        wh.flags = 0;
+
+        std::vector<float> saw(256);
+        for (int i = 0; i < 256; ++i)
+            saw[i] = i / 128.f - 1.f;
+
+        copy->BuildWT(saw.data(), wh, false);
+
+        REQUIRE(copy->getData() != oscA->wt.getData());
+        REQUIRE(copy->size == 256);
+        REQUIRE(copy->TableF32WeakPointers[0][0][64] == Approx(-0.5));
+        REQUIRE(oscA->wt.size == 2048);
+        REQUIRE(oscA->wt.TableF32WeakPointers[0][3][17] == before);
+    }
+
+    SECTION("Released Tables Leave The Cache")
+    {
+        auto data = std::weak_ptr<WavetableData>(oscA->wt.getData());
+        REQUIRE(!data.expired());
+
+        surgeA.reset();
+        REQUIRE(!data.expired());
+
+        surgeB.reset();
+        REQUIRE(data.expired());
+    }
+}
+
+TEST_CASE("Wavetable Disk Cache Round Trips", "[io]")
+{
+    std::string fn = "resources/test-data/wav/Wavetable.wav";
+    auto cacheDir = fs::temp_directory_path() / "surge-wavetable-disk-cache-test";
+    std::error_code ec;
+    fs::remove_all(cacheDir, ec);
+
+    WavetableCache::Key key;
+    REQUIRE(WavetableCache::keyFor(fn, key));
+
+    auto built = std::make_unique<Wavetable>();
+    {
+        auto surge = Surge::Headless::createSurge(44100);
+        surge->storage.useWavetableDiskCache = false;
+        surge->storage.load_wt(fn, built.get(), nullptr);
+        REQUIRE(built->everBuilt);
+        REQUIRE(WavetableDiskCache::write(cacheDir, key, *built->getData()));
+        REQUIRE(fs::exists(WavetableDiskCache::cacheFileFor(cacheDir, key)));
+    }
+
+    SECTION("Cached Tables Match Built Tables")
+    {
+        auto data = WavetableDiskCache::read(cacheDir, key);
+        REQUIRE(data);
+
+        auto restored = std::make_unique<Wavetable>();
+        restored->adoptData(data);
+
+        REQUIRE(restored->size == built->size);
+        REQUIRE(restored->n_tables == built->n_tables);
+        REQUIRE(restored->size_po2 == built->size_po2);
+        REQUIRE(restored->flags == built->flags);
+
+        for (int l = 0; l < max_mipmap_levels; ++l)
+        {
+            auto s = built->size >> l;
+            for (int t = 0; t < (int)built->n_tables && s > 0; ++t)
+            {
+                INFO("Level " << l << " table " << t);
+                REQUIRE(restored->TableF32WeakPointers[l][t]);
+                REQUIRE(memcmp(restored->TableF32WeakPointers[l][t],
+                               built->TableF32WeakPointers[l][t], s * sizeof(float)) == 0);
+                REQUIRE(memcmp(restored->TableI16WeakPointers[l][t],
+                               built->TableI16WeakPointers[l][t],
+                               (s + FIRipolI16_N) * sizeof(short)) == 0);
+            }
+        }
+    }
+
+    SECTION("Stale Entries Are Ignored")
+    {
+        auto changed = key;
+        changed.mtime++;
+        REQUIRE(!WavetableDiskCache::read(cacheDir, changed));
+
+        changed = key;
+        changed.fileSize++;
+        REQUIRE(!WavetableDiskCache::read(cacheDir, changed));
+    }
+
+    SECTION("Damaged Entries Are Ignored")
+    {
+        auto cf = WavetableDiskCache::cacheFileFor(cacheDir, key);
+        auto full = fs::file_size(cf);
+
+        fs::resize_file(cf, full - 1);
+        REQUIRE(!WavetableDiskCache::read(cacheDir, key));
+
+        REQUIRE(WavetableDiskCache::write(cacheDir, key, *built->getData()));
+        REQUIRE(WavetableDiskCache::read(cacheDir, key));
+
+        // size_po2 lives 48 bytes into the header; a table whose shape disagrees is a miss
+        {
+            std::fstream f(cf, std::ios::binary | std::ios::in | std::ios::out);
+            f.seekp(48);
+            int32_t po2 = built->size_po2 + 1;
+            f.write(reinterpret_cast<const char *>(&po2), sizeof(po2));
+        }
+        REQUIRE(!WavetableDiskCache::read(cacheDir, key));
+    }
+
+    SECTION("Loading Writes The Cache In The Background")
+    {
+        auto cf = WavetableDiskCache::cacheFileFor(cacheDir, key);
+        fs::remove(cf, ec);
+
+        built.reset();
+        REQUIRE(!WavetableCache::find(key));
+
+        auto surge = Surge::Headless::createSurge(44100);
+        surge->storage.userWavetableCachePath = cacheDir;
+        surge->storage.userDataPathValid = true;
+        surge->storage.useWavetableDiskCache = true;
+
+        auto osc = &(surge->storage.getPatch().scene[0].osc[0]);
+        surge->storage.load_wt(fn, &osc->wt, osc);
+        REQUIRE(osc->wt.everBuilt);
+
+        surge->storage.wavetableDiskCacheWriter.flush();
+        REQUIRE(fs::exists(cf));
+        REQUIRE(WavetableDiskCache::read(cacheDir, key));
+    }
+
+    SECTION("Loading Uses The Cache")
+    {
+        // mark the cached copy so we can tell it from a fresh build
+        auto src = built->getData();
+        auto marked = std::make_shared<WavetableData>(src->dataSizes);
+        memcpy(marked->TableF32Data, src->TableF32Data, src->dataSizes * sizeof(float));
+        memcpy(marked->TableI16Data, src->TableI16Data, src->dataSizes * sizeof(short));
+        marked->size = src->size;
+        marked->n_tables = src->n_tables;
+        marked->size_po2 = src->size_po2;
+        marked->flags = src->flags;
+
+        auto offset = built->TableF32WeakPointers[0][1] - src->TableF32Data;
+        marked->TableF32Data[offset] = 42.f;
+        REQUIRE(WavetableDiskCache::write(cacheDir, key, *marked));
+
+        // and make sure the in-memory cache can't answer instead
+        src.reset();
+        built.reset();
+        REQUIRE(!WavetableCache::find(key));
+
+        auto surge = Surge::Headless::createSurge(44100);
+        surge->storage.userWavetableCachePath = cacheDir;
+        surge->storage.userDataPathValid = true;
+        surge->storage.useWavetableDiskCache = true;
+
+        auto osc = &(surge->storage.getPatch().scene[0].osc[0]);
+        surge->storage.load_wt(fn, &osc->wt, osc);
+
+        REQUIRE(osc->wt.n_tables == 256);
+        REQUIRE(osc->wt.TableF32WeakPointers[0][1][0] == 42.f);
+        REQUIRE(osc->wavetable_display_name == "Wavetable");
+    }
+
+    SECTION("The Cache Directory Is Bounded")
+    {
+        auto entrySize = fs::file_size(WavetableDiskCache::cacheFileFor(cacheDir, key));
+        auto now = fs::file_time_type::clock::now();
+        std::vector<fs::path> files;
+
+        for (int i = 0; i < 4; ++i)
+        {
+            auto k = key;
+            k.path += std::to_string(i);
+            REQUIRE(WavetableDiskCache::write(cacheDir, k, *built->getData()));
+
+            auto cf = WavetableDiskCache::cacheFileFor(cacheDir, k);
+            fs::last_write_time(cf, now - std::chrono::hours(4 - i));
+            files.push_back(cf);
+        }
+        fs::last_write_time(WavetableDiskCache::cacheFileFor(cacheDir, key),
+                            now - std::chrono::hours(10));
+
+        WavetableDiskCache::trim(cacheDir, entrySize * 2);
+
+        REQUIRE(!fs::exists(WavetableDiskCache::cacheFileFor(cacheDir, key)));
+        REQUIRE(!fs::exists(files[0]));
+        REQUIRE(!fs::exists(files[1]));
+        REQUIRE(fs::exists(files[2]));
+        REQUIRE(fs::exists(files[3]));
+    }
+
+    fs::remove_all(cacheDir, ec);
+}
+
+TEST_CASE("Mapped Wavetables Match Read Wavetables", "[io]")
+{
+    auto surge = Surge::Headless::createSurge(44100);
+    REQUIRE(surge.get());
+
+    std::string fn = "resources/data/wavetables_3rdparty/Damon Armani/Damon Armani 11.wt";
+
+    auto mapped = std::make_unique<Wavetable>();
+    REQUIRE(surge->storage.load_wt_wt_mapped(fn, mapped.get()));
+    REQUIRE(mapped->getData()->mapping);
+    REQUIRE(mapped->size == 1024);
+    REQUIRE(mapped->n_tables == 33);
+
+    // and the same file through a buffer and BuildWT
+    std::ifstream ifs(string_to_path(fn), std::ios::binary);
+    std::vector<char> contents((std::istreambuf_iterator<char>(ifs)),
+                               std::istreambuf_iterator<char>());
+    REQUIRE(contents.size() > sizeof(wt_header));
+
+    wt_header wh;
+    memcpy(&wh, contents.data(), sizeof(wt_header));
+
+    auto built = std::make_unique<Wavetable>();
+    REQUIRE(built->BuildWT(contents.data() + sizeof(wt_header), wh, false));
+
+    SECTION("Every Level Matches")
+    {
+        for (int l = 0; l < max_mipmap_levels; ++l)
+        {
+            auto s = built->size >> l;
+            for (int t = 0; t < (int)built->n_tables && s > 0; ++t)
+            {
+                INFO("Level " << l << " table " << t);
+                REQUIRE(memcmp(mapped->TableF32WeakPointers[l][t],
+                               built->TableF32WeakPointers[l][t], s * sizeof(float)) == 0);
+                REQUIRE(memcmp(mapped->TableI16WeakPointers[l][t],
+                               built->TableI16WeakPointers[l][t],
+                               (s + FIRipolI16_N) * sizeof(short)) == 0);
+            }
+        }
+    }
+
+    SECTION("Level 0 Is The Mapping")
+    {
+        auto d = mapped->getData();
+        REQUIRE(d->mappedF32Samples == 1024 * 33);
+        REQUIRE(mapped->TableF32WeakPointers[0][0] == d->mappedF32);
+        REQUIRE(mapped->TableF32WeakPointers[1][0] == d->TableF32Data);
+    }
+
+    SECTION("Rebuilding Leaves The Mapping")
+    {
+        auto copy = std::make_unique<Wavetable>();
+        copy->Copy(mapped.get());
+        REQUIRE(copy->getData() == mapped->getData());
+
+        copy->BuildWT(contents.data() + sizeof(wt_header), wh, false);
+        REQUIRE(!copy->getData()->mapping);
+        REQUIRE(mapped->getData()->mapping);
+        REQUIRE(memcmp(copy->TableF32WeakPointers[0][5], mapped->TableF32WeakPointers[0][5],
+                       1024 * sizeof(float)) == 0);
+    }
+
+    SECTION("Only Factory Files Are Mapped")
+    {
+        auto origDataPath = surge->storage.datapath;
+        surge->storage.datapath = fs::path{"resources/data"};
+
+        auto factory = std::make_unique<Wavetable>();
+        REQUIRE(surge->storage.load_wt_wt(fn, factory.get()));
+        REQUIRE(factory->getData()->mapping);
+
+        auto userFile = fs::temp_directory_path() / "surge-mapped-wavetable-test.wt";
+        std::error_code ec;
+        fs::copy_file(string_to_path(fn), userFile, fs::copy_options::overwrite_existing, ec);
+        REQUIRE(!ec);
+
+        auto user = std::make_unique<Wavetable>();
+        REQUIRE(surge->storage.load_wt_wt(path_to_string(userFile), user.get()));
+        REQUIRE(!user->getData()->mapping);
+        REQUIRE(memcmp(user->TableF32WeakPointers[0][5], mapped->TableF32WeakPointers[0][5],
+                       1024 * sizeof(float)) == 0);
+
+        fs::remove(userFile, ec);
+        surge->storage.datapath = origDataPath;
+    }
+}
+
 TEST_CASE("All Patches Are Loadable", "[io]")
 {
     auto surge = Surge::Headless::createSurge(44100, true);
@@ -331,6 +660,48 @@ TEST_CASE("DAW Streaming And Unstreaming", "[io][mpe][tun]")
         REQUIRE(surgeDest->storage.controllers[2] == 75);
         REQUIRE(surgeDest->storage.controllers[4] == 79);
     }
+
+    SECTION("Processing Options Save")
+    {
+        auto surgeSrc = Surge::Headless::createSurge(44100);
+        auto surgeDest = Surge::Headless::createSurge(44100);
+
+        REQUIRE(!surgeDest->storage.approximateWaveshapers);
+
+        surgeSrc->storage.approximateWaveshapers = true;
+        fromto(surgeSrc, surgeDest);
+        REQUIRE(surgeDest->storage.approximateWaveshapers);
+
+        surgeSrc->storage.approximateWaveshapers = false;
+        fromto(surgeSrc, surgeDest);
+        REQUIRE(!surgeDest->storage.approximateWaveshapers);
+    }
+
+    SECTION("Processing Options Missing From Older Sessions")
+    {
+        auto surgeSrc = Surge::Headless::createSurge(44100);
+        auto surgeDest = Surge::Headless::createSurge(44100);
+
+        surgeSrc->storage.oddsoundRetuneMode = SurgeStorage::RETUNE_NOTE_ON_ONLY;
+        surgeSrc->populateDawExtraState();
+
+        void *d = nullptr;
+        auto sz = surgeSrc->storage.getPatch().save_xml(&d);
+        std::string xml((const char *)d, sz);
+        free(d);
+
+        // a session saved before the option existed has no key for it
+        auto from = xml.find("<approximateWaveshapers");
+        REQUIRE(from != std::string::npos);
+        xml.erase(from, xml.find("/>", from) + 2 - from);
+        REQUIRE(xml.find("<approximateWaveshapers") == std::string::npos);
+
+        surgeDest->storage.getPatch().load_xml(xml.c_str(), xml.size(), false);
+        surgeDest->loadFromDawExtraState();
+        REQUIRE(surgeDest->storage.getPatch().dawExtraState.isPopulated);
+        REQUIRE(surgeDest->storage.oddsoundRetuneMode == SurgeStorage::RETUNE_NOTE_ON_ONLY);
+        REQUIRE(!surgeDest->storage.approximateWaveshapers);
+    }
 }
 
 TEST_CASE("Stream Wavetable Names", "[io]")
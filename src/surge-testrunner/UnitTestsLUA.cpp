@@ -661,6 +661,76 @@ end)FN");
         REQUIRE(outOfBounds > 0);
     }
 }
+
+TEST_CASE("Formula State Round Trip", "[formula]")
+{
+    SECTION("Inputs And Vector Outputs")
+    {
+        SurgeStorage storage;
+        FormulaModulatorStorage fs;
+        fs.setFormula(R"FN(
+function process(state)
+    state.output = { state.phase, state.cycle / 10, state.tempo / 1000, state.deform }
+    state.clamp_output = false
+    return state
+end)FN");
+
+        // none of this tests the round trip unless valueAt goes through the bound io struct
+        Surge::Formula::EvaluatorState es;
+        Surge::Formula::prepareForEvaluation(&storage, &fs, es, true);
+        REQUIRE(es.ioRef != 0);
+        REQUIRE(es.ioBoundTo == &es.io);
+
+        auto runIt = runFormula(&storage, &fs, 0.0321, 3, 0.4);
+        REQUIRE(!runIt.empty());
+        for (auto c : runIt)
+        {
+            REQUIRE(c.vVec[0] == Approx(c.fPhase));
+            REQUIRE(c.vVec[1] == Approx(c.iPhase / 10.0));
+            REQUIRE(c.vVec[2] == Approx(0.12));
+            REQUIRE(c.vVec[3] == Approx(0.4));
+            REQUIRE(c.vVec[4] == 0);
+        }
+    }
+
+    SECTION("A Fresh Table Each Block")
+    {
+        SurgeStorage storage;
+        FormulaModulatorStorage fs;
+        fs.setFormula(R"FN(
+function process(state)
+    return { output = state.phase * 0.5, count = (state.count or 0) + 1 }
+end)FN");
+
+        auto runIt = runFormula(&storage, &fs, 0.0321, 3);
+        REQUIRE(!runIt.empty());
+        for (auto c : runIt)
+        {
+            REQUIRE(c.v == Approx(c.fPhase * 0.5));
+        }
+    }
+
+    SECTION("Vector Outputs With Unusual Keys")
+    {
+        SurgeStorage storage;
+        FormulaModulatorStorage fs;
+        fs.setFormula(R"FN(
+function process(state)
+    state.output = { 0.5 }
+    state.output["2"] = 0.25
+    return state
+end)FN");
+
+        auto runIt = runFormula(&storage, &fs, 0.0321, 3);
+        REQUIRE(!runIt.empty());
+        for (auto c : runIt)
+        {
+            REQUIRE(c.vVec[0] == 0.5);
+            REQUIRE(c.vVec[1] == 0.25);
+        }
+    }
+}
+
 TEST_CASE("Wavetable Script", "[formula]")
 {
     SECTION("Just The Sines")
@@ -687,6 +757,88 @@ end
             }
         }
     }
+
+    SECTION("Whole Table Matches Frames")
+    {
+        const std::string s = R"FN(
+function generate(config)
+    res = {}
+    for i,x in ipairs(config.xs) do
+        res[i] = math.sin(x * (config.n+1) * 2 * math.pi) * (config.n + 1) / config.nTables
+    end
+    return res
+end
+        )FN";
+        const int res = 256, nf = 23;
+        SurgeStorage storage;
+
+        // the second construction comes from the cache, and has to be the same
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            wt_header wh;
+            float *wd = nullptr;
+            REQUIRE(Surge::WavetableScript::constructWavetable(&storage, s, res, nf, wh, &wd));
+            REQUIRE(wh.n_samples == res);
+            REQUIRE(wh.n_tables == nf);
+
+            for (int fno = 0; fno < nf; ++fno)
+            {
+                auto fr = Surge::WavetableScript::evaluateScriptAtFrame(s, res, fno, nf);
+                REQUIRE(fr.size() == res);
+                for (int i = 0; i < res; ++i)
+                    REQUIRE(wd[fno * res + i] == fr[i]);
+            }
+            delete[] wd;
+        }
+    }
+
+    SECTION("Random Tables Are Fresh But Don't Depend On Scheduling")
+    {
+        const std::string s = R"FN(
+function generate(config)
+    res = {}
+    for i,x in ipairs(config.xs) do
+        res[i] = math.random() * 2 - 1
+    end
+    return res
+end
+        )FN";
+        const int res = 128, nf = 16;
+        SurgeStorage storage;
+
+        std::vector<std::vector<float>> tables;
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            wt_header wh;
+            float *wd = nullptr;
+            REQUIRE(Surge::WavetableScript::constructWavetable(&storage, s, res, nf, wh, &wd));
+            tables.emplace_back(wd, wd + res * nf);
+            delete[] wd;
+        }
+
+        // a second generate isn't served from the cache, and draws new noise
+        REQUIRE(tables[0] != tables[1]);
+
+        // frames within a table are seeded apart, so don't repeat each other
+        for (int f = 1; f < nf; ++f)
+        {
+            INFO("Frame " << f);
+            REQUIRE(!std::equal(tables[0].begin(), tables[0].begin() + res,
+                                tables[0].begin() + f * res));
+        }
+
+        // the same seed gives the same table, however the frames were shared out
+        Surge::WavetableScript::GeneratorPool pool;
+        std::vector<float> a(res * nf), b(res * nf);
+        REQUIRE(pool.generate(s, res, nf, 1000, a.data()));
+        REQUIRE(pool.generate(s, res, nf, 1000, b.data()));
+        REQUIRE(a == b);
+
+        auto single = Surge::WavetableScript::evaluateScriptAtFrame(s, res, 3, nf);
+        std::vector<float> zeroSeeded(res * nf);
+        REQUIRE(pool.generate(s, res, nf, 0, zeroSeeded.data()));
+        REQUIRE(std::equal(single.begin(), single.end(), zeroSeeded.begin() + 3 * res));
+    }
 }
 
 TEST_CASE("Simple Used Formula Modulator", "[formula]")
@@ -730,6 +882,249 @@ end)FN");
     }
 }
 
+TEST_CASE("Formula Time Budget", "[formula]")
+{
+    // long enough to run over a tiny budget
+    const std::string slow = R"FN(
+function process(state)
+    local x = 0
+    for i = 1, 200000 do
+        x = x + math.sin(i)
+    end
+    state.output = 0.5 + x * 0
+    return state
+end)FN";
+
+    auto setup = [](float budgetInBlocks, const std::string &formula) {
+        auto surge = Surge::Test::surgeOnSine();
+        surge->storage.formulaTimeBudgetInBlocks = budgetInBlocks;
+        surge->storage.getPatch().scene[0].lfo[0].shape.val.i = lt_formula;
+        surge->storage.getPatch().scene[0].lfo[0].unipolar.val.b = false;
+        auto pitchId = surge->storage.getPatch().scene[0].osc[0].pitch.id;
+        surge->setModDepth01(pitchId, ms_lfo1, 0, 0, 0.1);
+        surge->storage.getPatch().formulamods[0][0].setFormula(formula);
+
+        for (int i = 0; i < 10; ++i)
+            surge->process();
+
+        return surge;
+    };
+
+    auto lfoFor = [](std::shared_ptr<SurgeSynthesizer> &surge, int key) {
+        for (auto *v : surge->voices[0])
+        {
+            if (v->state.key == key)
+            {
+                return dynamic_cast<LFOModulationSource *>(v->modsources[ms_lfo1]);
+            }
+        }
+        return (LFOModulationSource *)nullptr;
+    };
+
+    auto switchedOff = [](std::shared_ptr<SurgeSynthesizer> &surge) {
+        auto *fs = &surge->storage.getPatch().formulamods[0][0];
+
+        for (auto &r : surge->storage.formulaGlobalData->audioBudget.overruns)
+        {
+            if (r.isFor(fs) && r.switchedOff)
+                return true;
+        }
+        return false;
+    };
+
+    SECTION("One Overrun Only Stops That Block")
+    {
+        auto surge = setup(0.01f, slow);
+        surge->playNote(0, 60, 100, 0);
+        surge->process();
+
+        auto lms = lfoFor(surge, 60);
+        REQUIRE(lms);
+        REQUIRE(lms->formulastate.isvalid);
+        REQUIRE(lms->get_output(0) == 0.f);
+    }
+
+    SECTION("Repeated Overruns Switch It Off Until It Is Set Again")
+    {
+        auto surge = setup(0.01f, slow);
+
+        surge->playNote(0, 60, 100, 0);
+        for (int i = 0; i < 20; ++i)
+            surge->process();
+
+        auto lms = lfoFor(surge, 60);
+        REQUIRE(lms);
+        REQUIRE(!lms->formulastate.isvalid);
+        REQUIRE(switchedOff(surge));
+        REQUIRE(surge->storage.formulaGlobalData->knownBadFunctions.count(
+                    lms->formulastate.funcName) == 0);
+
+        surge->playNote(0, 62, 100, 0);
+        surge->process();
+        lms = lfoFor(surge, 62);
+        REQUIRE(lms);
+        REQUIRE(!lms->formulastate.isvalid);
+
+        // setting the same formula again switches it back on
+        surge->storage.formulaTimeBudgetInBlocks = 0.f;
+        surge->storage.getPatch().formulamods[0][0].setFormula(slow);
+        surge->playNote(0, 64, 100, 0);
+        surge->process();
+        lms = lfoFor(surge, 64);
+        REQUIRE(lms);
+        REQUIRE(lms->formulastate.isvalid);
+        REQUIRE(lms->get_output(0) != 0.f);
+    }
+
+    SECTION("Endless Loops Are Stopped")
+    {
+        // this is JIT compiled, so only the checks parsed into it can stop it
+        auto surge = setup(0.01f, R"FN(
+local function spin(x)
+    while true do
+        x = x + 1
+    end
+end
+
+function process(state)
+    state.output = spin(0)
+    return state
+end)FN");
+
+        surge->playNote(0, 60, 100, 0);
+        for (int i = 0; i < 20; ++i)
+            surge->process();
+
+        auto lms = lfoFor(surge, 60);
+        REQUIRE(lms);
+        REQUIRE(!lms->formulastate.isvalid);
+        REQUIRE(switchedOff(surge));
+    }
+
+    SECTION("Checks Leave Formulas Working")
+    {
+        // loops and functions in every form, with the keywords the checks go after also turning
+        // up in strings and comments, where they must be left alone
+        auto surge = setup(1000.f, R"FN(
+-- do and function( in a comment
+--[==[ a long comment with repeat ]] and goto ]==]
+local s = [[do repeat "function(" ]]
+local q = "do \" function( goto"
+local obj = {}
+function obj:m(a, b) return a + b end
+local anon = function(...) return select('#', ...) end
+local function count(n)
+    local t = 0
+    for i = 1, n do
+        if i % 2 == 0 then goto continue end
+        local y = i * 1e2 + 0x1p4 - 1.5e-3
+        t = t + 1
+        ::continue::
+    end
+    local k = 0
+    repeat k = k + 1 until k >= 3
+    while k < 6 do k = k + 1 end
+    do k = k + 0 end
+    ::top::
+    if k < 9 then k = k + 1 goto top end
+    return t + k
+end
+function process(state)
+    local v = count(10) + obj:m(1, 2) + anon(1, 2, 3) + #s + #q
+    state.output = (v == 61) and 0.75 or -0.75
+    return state
+end)FN");
+
+        surge->playNote(0, 60, 100, 0);
+        for (int i = 0; i < 5; ++i)
+            surge->process();
+
+        auto lms = lfoFor(surge, 60);
+        REQUIRE(lms);
+        REQUIRE(lms->formulastate.isvalid);
+        REQUIRE(lms->get_output(0) > 0.f);
+    }
+
+    SECTION("No Budget Lets It Run")
+    {
+        auto surge = setup(0.f, slow);
+        surge->playNote(0, 60, 100, 0);
+        for (int i = 0; i < 5; ++i)
+            surge->process();
+
+        auto lms = lfoFor(surge, 60);
+        REQUIRE(lms);
+        REQUIRE(lms->formulastate.isvalid);
+        REQUIRE(lms->get_output(0) != 0.f);
+    }
+}
+
+TEST_CASE("Formula Voice States Are Pooled", "[formula]")
+{
+    auto surge = Surge::Test::surgeOnSine();
+    surge->storage.getPatch().scene[0].lfo[0].shape.val.i = lt_formula;
+    surge->storage.getPatch().scene[0].adsr[0].r.val.f =
+        surge->storage.getPatch().scene[0].adsr[0].r.val_min.f;
+    auto pitchId = surge->storage.getPatch().scene[0].osc[0].pitch.id;
+    surge->setModDepth01(pitchId, ms_lfo1, 0, 0, 0.1);
+
+    // a reused table which wasn't emptied would show an older generation
+    surge->storage.getPatch().formulamods[0][0].setFormula(R"FN(
+function init(state)
+    state.generation = (state.generation or 0) + 1
+    state.subscriptions["voice"] = true
+    return state
+end
+
+function process(state)
+    state.output = state.phase * 2 - 1
+    state.leftover = state.key
+    return state
+end)FN");
+
+    for (int i = 0; i < 10; ++i)
+        surge->process();
+
+    std::string firstName;
+
+    for (int note = 0; note < 4; ++note)
+    {
+        INFO("Note " << note);
+        surge->playNote(0, 60 + note, 100, 0);
+        for (int i = 0; i < 10; ++i)
+            surge->process();
+
+        REQUIRE(surge->voices[0].size() == 1);
+        auto lms = dynamic_cast<LFOModulationSource *>(
+            surge->voices[0].front()->modsources[ms_lfo1]);
+        REQUIRE(lms);
+
+        auto &fs = lms->formulastate;
+        std::string name = fs.stateName;
+
+        if (note == 0)
+            firstName = name;
+        else
+            REQUIRE(name == firstName);
+
+        auto g = Surge::Formula::extractModStateKeyForTesting("generation", fs);
+        REQUIRE(std::get_if<float>(&g));
+        REQUIRE(*std::get_if<float>(&g) == 1);
+
+        auto k = Surge::Formula::extractModStateKeyForTesting("leftover", fs);
+        REQUIRE(std::get_if<float>(&k));
+        REQUIRE(*std::get_if<float>(&k) == 60 + note);
+
+        surge->releaseNote(0, 60 + note, 0);
+        for (int i = 0; i < 1000 && !surge->voices[0].empty(); ++i)
+            surge->process();
+
+        REQUIRE(surge->voices[0].empty());
+    }
+
+    REQUIRE(!surge->storage.formulaGlobalData->statePool.empty());
+}
+
 TEST_CASE("Voice Features And Flags", "[formula]")
 {
     SECTION("is_voice Is Set Correctly")
@@ -24,6 +24,7 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <random>
 
 #include "HeadlessUtils.h"
 #include "Player.h"
@@ -527,6 +528,76 @@ TEST_CASE("ADSR Envelope Behaviour", "[mod]")
     }
 }
 
+TEST_CASE("Quad ADSR Matches Single Envelopes", "[mod]")
+{
+    std::shared_ptr<SurgeSynthesizer> surge(Surge::Headless::createSurge(44100));
+    REQUIRE(surge.get());
+
+    auto *adsrstorage = &(surge->storage.getPatch().scene[0].adsr[0]);
+
+    int ids, ide;
+    setupStorageRanges(&(adsrstorage->a), &(adsrstorage->mode), ids, ide);
+    copyScenedataSubset(&(surge->storage), 0, ids, ide);
+
+    // six envelopes, a mix of analog and digital with different times, so a full quad and
+    // a partial one which is mixed too
+    static constexpr int nEnv = 6;
+    std::vector<std::vector<pdata>> lcs;
+
+    for (int i = 0; i < nEnv; ++i)
+    {
+        auto *sd = surge->storage.getPatch().scenedata[0];
+        lcs.emplace_back(sd, sd + n_scene_params);
+
+        auto &lc = lcs.back();
+        lc[adsrstorage->a.param_id_in_scene].f = -6.f + i;
+        lc[adsrstorage->d.param_id_in_scene].f = -3.f + 0.5f * i;
+        lc[adsrstorage->s.param_id_in_scene].f = 0.1f * (i + 1);
+        lc[adsrstorage->r.param_id_in_scene].f = -4.f + 0.7f * i;
+        lc[adsrstorage->mode.param_id_in_scene].b = (i % 3) != 1;
+    }
+
+    ADSRModulationSource single[nEnv], quad[nEnv];
+
+    for (int i = 0; i < nEnv; ++i)
+    {
+        single[i].init(&(surge->storage), adsrstorage, lcs[i].data(), nullptr);
+        quad[i].init(&(surge->storage), adsrstorage, lcs[i].data(), nullptr);
+        single[i].attack();
+        quad[i].attack();
+    }
+
+    for (int b = 0; b < 8000; ++b)
+    {
+        if (b == 700)
+        {
+            for (int i = 0; i < nEnv; ++i)
+            {
+                single[i].release();
+                quad[i].release();
+            }
+        }
+
+        for (int i = 0; i < nEnv; ++i)
+            single[i].process_block();
+
+        ADSRModulationSource *q0[4] = {&quad[0], &quad[1], &quad[2], &quad[3]};
+        ADSRModulationSource *q1[2] = {&quad[4], &quad[5]};
+        ADSRModulationSource::process_block_quad(q0, 4);
+        ADSRModulationSource::process_block_quad(q1, 2);
+
+        for (int i = 0; i < nEnv; ++i)
+        {
+            INFO("Envelope " << i << " block " << b);
+            REQUIRE(quad[i].get_output(0) == single[i].get_output(0));
+            REQUIRE(quad[i].getEnvState() == single[i].getEnvState());
+        }
+    }
+
+    for (int i = 0; i < nEnv; ++i)
+        REQUIRE(quad[i].is_idle());
+}
+
 TEST_CASE("Non-MPE Pitch Bend", "[mod]")
 {
     SECTION("Simple Bend Distances")
@@ -841,6 +912,87 @@ TEST_CASE("LFO Tempo Sync Drift in Latch Mode", "[mod]")
     }
 }
 
+TEST_CASE("LFO Quad Matches Single LFOs", "[mod]")
+{
+    for (auto shape : {lt_sine, lt_tri, lt_ramp, lt_square})
+    {
+        for (auto dt : {type_1, type_2})
+        {
+            DYNAMIC_SECTION("Shape " << shape << " deform type " << dt)
+            {
+                auto surge = Surge::Headless::createSurge(44100);
+                REQUIRE(surge);
+
+                auto ss = std::make_unique<StepSequencerStorage>();
+                auto lfostorage = &(surge->storage.getPatch().scene[0].lfo[0]);
+                lfostorage->shape.val.i = shape;
+                lfostorage->deform.deform_type = dt;
+
+                surge->storage.getPatch().copy_scenedata(
+                    surge->storage.getPatch().scenedata[0], 0);
+
+                // six voices; the first two share a rate, the rest are modulated apart
+                static constexpr int nLFO = 6;
+                std::vector<std::vector<pdata>> lcs;
+
+                for (int i = 0; i < nLFO; ++i)
+                {
+                    auto *sd = surge->storage.getPatch().scenedata[0];
+                    lcs.emplace_back(sd, sd + n_scene_params);
+
+                    auto &lc = lcs.back();
+                    lc[lfostorage->rate.param_id_in_scene].f = 2.f + 0.37f * std::max(i, 1);
+                    lc[lfostorage->deform.param_id_in_scene].f = -0.9f + 0.35f * i;
+                }
+
+                std::vector<std::unique_ptr<LFOModulationSource>> single, quad;
+
+                for (int i = 0; i < nLFO; ++i)
+                {
+                    for (auto *set : {&single, &quad})
+                    {
+                        set->push_back(std::make_unique<LFOModulationSource>());
+                        set->back()->assign(&(surge->storage), lfostorage, lcs[i].data(), nullptr,
+                                            ss.get(), nullptr, nullptr);
+                        set->back()->attack();
+                    }
+                }
+
+                for (int b = 0; b < 5000; ++b)
+                {
+                    if (b == 3000)
+                    {
+                        for (int i = 0; i < nLFO; ++i)
+                        {
+                            single[i]->release();
+                            quad[i]->release();
+                        }
+                    }
+
+                    for (auto &l : single)
+                        l->process_block();
+
+                    LFOModulationSource *q0[4] = {quad[0].get(), quad[1].get(), quad[2].get(),
+                                                  quad[3].get()};
+                    LFOModulationSource *q1[2] = {quad[4].get(), quad[5].get()};
+                    LFOModulationSource::process_block_quad(q0, 4);
+                    LFOModulationSource::process_block_quad(q1, 2);
+
+                    for (int i = 0; i < nLFO; ++i)
+                    {
+                        INFO("LFO " << i << " block " << b);
+                        for (int o = 0; o < 3; ++o)
+                        {
+                            REQUIRE(quad[i]->get_output(o) ==
+                                    Approx(single[i]->get_output(o)).margin(1e-6));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
 TEST_CASE("MIDI Controller Smoothing", "[mod]")
 {
     SECTION("Legacy Mode")
@@ -946,6 +1098,67 @@ TEST_CASE("MIDI Controller Smoothing", "[mod]")
             REQUIRE(a.get_output(0) == r);
         }
     }
+
+    SECTION("Quads Match Single Controllers")
+    {
+        auto surge = Surge::Headless::createSurge(44100);
+        REQUIRE(surge);
+
+        std::mt19937 gen(27);
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+        for (auto untilClose : {false, true})
+        {
+            for (int trial = 0; trial < 200; ++trial)
+            {
+                int n = 1 + trial % 4;
+                ControllerModulationSource single[4], quad[4];
+                ControllerModulationSource *q[4];
+
+                for (int i = 0; i < n; ++i)
+                {
+                    // a mix of modes, LEGACY to DIRECT, some starting close to their target
+                    auto mode = (Modulator::SmoothingMode)((trial + i) % 5 - 1);
+                    float v = dist(gen);
+                    float t = (trial % 7 == 0) ? v + dist(gen) * 0.001f : dist(gen);
+
+                    for (auto *c : {&single[i], &quad[i]})
+                    {
+                        c->smoothingMode = mode;
+                        c->set_samplerate(surge->storage.samplerate,
+                                          surge->storage.samplerate_inv);
+                        c->init(v);
+                        c->set_target(t);
+                    }
+                    q[i] = &quad[i];
+                }
+
+                for (int blk = 0; blk < 50; ++blk)
+                {
+                    bool singleCont[4], quadCont[4];
+
+                    for (int i = 0; i < n; ++i)
+                    {
+                        if (untilClose)
+                            singleCont[i] = single[i].process_block_until_close(0.001f);
+                        else
+                            single[i].process_block();
+                    }
+
+                    ControllerModulationSource::processSmoothingQuad(q, n, untilClose, 0.001f,
+                                                                     quadCont);
+
+                    for (int i = 0; i < n; ++i)
+                    {
+                        INFO("Trial " << trial << " block " << blk << " controller " << i);
+                        REQUIRE(quad[i].get_output(0) == single[i].get_output(0));
+                        if (untilClose)
+                            REQUIRE(quadCont[i] == singleCont[i]);
+                    }
+                }
+            }
+        }
+    }
 }
 
 TEST_CASE("Keytrack Morph", "[mod]")
@@ -23,6 +23,7 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <random>
 
 #include "HeadlessUtils.h"
 #include "catch2/catch_amalgamated.hpp"
@@ -542,6 +543,116 @@ TEST_CASE("Zero Size Loops", "[mseg]")
     }
 }
 
+TEST_CASE("Indexed Segment Lookup Matches Linear Search", "[mseg]")
+{
+    /*
+     * Without a time index (or with coefficients which don't match the segment) the lookup and
+     * evaluation fall back to the search and the inline computation, so compare the two.
+     */
+    auto unindexed = [](const MSEGStorage &ms) {
+        auto res = ms;
+        res.timeIndexScale = 0;
+
+        for (auto &c : res.segmentCoefficients)
+        {
+            c.valid = false;
+        }
+
+        return res;
+    };
+
+    std::minstd_rand gen(1492);
+    std::uniform_real_distribution<float> urd(0.f, 1.f);
+    const MSEGStorage::segment::Type types[] = {
+        MSEGStorage::segment::LINEAR,   MSEGStorage::segment::QUAD_BEZIER,
+        MSEGStorage::segment::SCURVE,   MSEGStorage::segment::SINE,
+        MSEGStorage::segment::STAIRS,   MSEGStorage::segment::SQUARE,
+        MSEGStorage::segment::TRIANGLE, MSEGStorage::segment::HOLD,
+        MSEGStorage::segment::SAWTOOTH, MSEGStorage::segment::BUMP,
+        MSEGStorage::segment::SMOOTH_STAIRS};
+
+    for (int trial = 0; trial < 50; ++trial)
+    {
+        INFO("Trial " << trial);
+
+        MSEGStorage ms;
+        ms.n_activeSegments = (trial < 10) ? (trial + 1) : (int)(urd(gen) * (max_msegs - 1)) + 1;
+        ms.endpointMode = MSEGStorage::EndpointMode::FREE;
+        ms.loopMode = (MSEGStorage::LoopMode)(trial % 3 + 1);
+
+        for (int i = 0; i < ms.n_activeSegments; ++i)
+        {
+            // every so often a zero length segment, which the lookup has to step past
+            ms.segments[i].duration = (urd(gen) < 0.1) ? 0.f : urd(gen) * urd(gen) * 2.f;
+            ms.segments[i].type = types[(int)(urd(gen) * 11) % 11];
+            ms.segments[i].v0 = urd(gen) * 2 - 1;
+            ms.segments[i].nv1 = urd(gen) * 2 - 1;
+        }
+
+        if (trial % 2)
+        {
+            ms.loop_start = (int)(urd(gen) * ms.n_activeSegments);
+            ms.loop_end = ms.loop_start + (int)(urd(gen) * (ms.n_activeSegments - ms.loop_start));
+        }
+
+        resetCP(&ms);
+
+        for (int i = 0; i < ms.n_activeSegments; ++i)
+        {
+            ms.segments[i].cpv = urd(gen) * 2 - 1;
+        }
+
+        Surge::MSEG::rebuildCache(&ms);
+
+        if (ms.totalDuration <= 0)
+        {
+            continue;
+        }
+
+        REQUIRE(ms.timeIndexScale > 0);
+
+        auto linear = unindexed(ms);
+
+        for (int i = 0; i < 500; ++i)
+        {
+            double t = (urd(gen) * 1.5 - 0.1) * ms.totalDuration * (i % 2 ? 1 : 3);
+
+            // and the boundaries themselves
+            if (i % 5 == 0)
+            {
+                t = ms.segmentEnd[(int)(urd(gen) * ms.n_activeSegments)];
+            }
+
+            for (bool ignoreLoops : {false, true})
+            {
+                float alongIndexed = -1, alongLinear = -1;
+                auto expected = Surge::MSEG::timeToSegment(&linear, t, ignoreLoops, alongLinear);
+                auto hint = (int)(urd(gen) * (ms.n_activeSegments + 2)) - 1;
+
+                INFO("t " << t << " ignoreLoops " << ignoreLoops << " hint " << hint);
+                REQUIRE(Surge::MSEG::timeToSegment(&ms, t, ignoreLoops, alongIndexed) ==
+                        expected);
+                REQUIRE(alongIndexed == alongLinear);
+                REQUIRE(Surge::MSEG::timeToSegment(&ms, t, ignoreLoops, alongIndexed, hint) ==
+                        expected);
+                REQUIRE(alongIndexed == alongLinear);
+            }
+        }
+
+        // The evaluator remembers its last segment, and the release search uses it as well
+        auto indexedRun = runMSEG(&ms, 0.0173, ms.totalDuration * 3, 0.3, ms.totalDuration);
+        auto linearRun = runMSEG(&linear, 0.0173, ms.totalDuration * 3, 0.3, ms.totalDuration);
+
+        REQUIRE(indexedRun.size() == linearRun.size());
+
+        for (auto i = 0U; i < indexedRun.size(); ++i)
+        {
+            INFO("Observation " << i << " at " << indexedRun[i].phase);
+            REQUIRE(indexedRun[i].v == linearRun[i].v);
+        }
+    }
+}
+
 /*
  * Tests to add
  * - loop point 0 (start = end + 1)
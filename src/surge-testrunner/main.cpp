@@ -73,6 +73,30 @@ int main(int argc, char **argv)
         {
             Surge::Headless::NonTest::performancePlay(argv[3], std::atoi(argv[4]));
         }
+        if (strcmp(argv[2], "--wavetable-cache-benchmark") == 0)
+        {
+            Surge::Headless::NonTest::wavetableCacheBenchmark();
+        }
+        if (strcmp(argv[2], "--string-delay-footprint") == 0)
+        {
+            Surge::Headless::NonTest::stringDelayFootprint();
+        }
+        if (strcmp(argv[2], "--window-osc-benchmark") == 0)
+        {
+            Surge::Headless::NonTest::windowOscillatorBenchmark();
+        }
+        if (strcmp(argv[2], "--filter-chain-benchmark") == 0)
+        {
+            Surge::Headless::NonTest::filterChainBenchmark();
+        }
+        if (strcmp(argv[2], "--fixed-filter-chain-benchmark") == 0)
+        {
+            Surge::Headless::NonTest::fixedFilterChainBenchmark();
+        }
+        if (strcmp(argv[2], "--waveshaper-approx-benchmark") == 0)
+        {
+            Surge::Headless::NonTest::waveshaperApproxBenchmark();
+        }
         return 0;
     }
     else
@@ -87,6 +111,18 @@ int main(int argc, char **argv)
                 << "   --non-test --stats-from-every-patch    # play every patch and show RMS\n"
                 << "   --non-test --filter-analyzer ft fst    # analyze filter type/subtype for "
                    "response\n"
+                << "   --non-test --wavetable-cache-benchmark # time factory wavetable loads "
+                   "with and without the disk cache\n"
+                << "   --non-test --string-delay-footprint    # string delay memory and time, "
+                   "tiered vs 16k\n"
+                << "   --non-test --window-osc-benchmark      # window oscillator per window shape "
+                   "vs classic\n"
+                << "   --non-test --filter-chain-benchmark    # filter block per filter type, "
+                   "4 vs 8 voice lanes\n"
+                << "   --non-test --fixed-filter-chain-benchmark # filter block per config, "
+                   "filter kernel called vs inlined\n"
+                << "   --non-test --waveshaper-approx-benchmark # filter block waveshaper, "
+                   "table vs approximation\n"
                 << "\n"
                 << "If you exclude the `--non-test` argument, standard catch2 arguments, below, "
                    "apply\n\n";
@@ -815,6 +815,7 @@ class SurgeGUIEditor : public Surge::GUI::IComponentTagValue::Listener,
     juce::PopupMenu makeDevMenu(const juce::Point<int> &rect);
     juce::PopupMenu makeLfoMenu(const juce::Point<int> &rect);
     juce::PopupMenu makeMonoModeOptionsMenu(const juce::Point<int> &rect, bool updateDefaults);
+    juce::PopupMenu makeProcessingMenu(const juce::Point<int> &rect, bool updateDefaults);
     juce::PopupMenu makeOSCMenu(const juce::Point<int> &where);
 
     void makeScopeEntry(juce::PopupMenu &menu);
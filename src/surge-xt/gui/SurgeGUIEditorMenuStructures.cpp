@@ -30,6 +30,7 @@
 #include "AccessibleHelpers.h"
 #include "DebugHelpers.h"
 #include "ModulatorPresetManager.h"
+#include "CPUFeatures.h"
 
 #include "fmt/core.h"
 
@@ -319,6 +320,46 @@ juce::PopupMenu SurgeGUIEditor::makeMonoModeOptionsMenu(const juce::Point<int> &
     return monoSubMenu;
 }
 
+// options which trade exactness for speed; each instance saves its own with the DAW state
+juce::PopupMenu SurgeGUIEditor::makeProcessingMenu(const juce::Point<int> &where,
+                                                   bool updateDefaults)
+{
+    auto procSubMenu = juce::PopupMenu();
+
+    bool approxWS = synth->storage.approximateWaveshapers;
+
+    if (updateDefaults)
+    {
+        approxWS = Surge::Storage::getUserDefaultValue(
+            &(this->synth->storage), Surge::Storage::ApproximateWaveshapers, false);
+    }
+
+    procSubMenu.addItem(Surge::GUI::toOSCase("Compute Asymmetric and Sine Waveshapers"), true,
+                        approxWS, [this, approxWS, updateDefaults]() {
+                            if (updateDefaults)
+                            {
+                                Surge::Storage::updateUserDefaultValue(
+                                    &(this->synth->storage),
+                                    Surge::Storage::ApproximateWaveshapers, !approxWS);
+                            }
+                            else
+                            {
+                                synth->storage.approximateWaveshapers = !approxWS;
+                                synth->storage.getPatch().isDirty = true;
+                            }
+                        });
+
+    if (!updateDefaults)
+    {
+        procSubMenu.addSeparator();
+
+        auto defMenu = makeProcessingMenu(where, true);
+        procSubMenu.addSubMenu(Surge::GUI::toOSCase("Defaults for New Instances"), defMenu);
+    }
+
+    return procSubMenu;
+}
+
 juce::PopupMenu SurgeGUIEditor::makeTuningMenu(const juce::Point<int> &where, bool showhelp)
 {
     bool isTuningEnabled = !synth->storage.isStandardTuning;
@@ -1821,6 +1862,26 @@ juce::PopupMenu SurgeGUIEditor::makeDevMenu(const juce::Point<int> &where)
     devSubMenu.addItem(Surge::GUI::toOSCase("Dump Undo/Redo Stack to stdout"), true, false,
                        [this]() { undoManager()->dumpStack(); });
 
+    bool useOct = synth->storage.useOctFilterChain;
+
+    devSubMenu.addItem(Surge::GUI::toOSCase("Process Filters Eight Voices at a Time (AVX2)"),
+                       Surge::CPUFeatures::detectedSIMDLevel() >= Surge::CPUFeatures::simd_avx2_fma,
+                       useOct, [this, useOct]() {
+                           synth->storage.useOctFilterChain = !useOct;
+                           Surge::Storage::updateUserDefaultValue(
+                               &(this->synth->storage), Surge::Storage::UseOctFilterChain, !useOct);
+                       });
+
+    bool useFixed = synth->storage.useFixedFilterChains;
+
+    devSubMenu.addItem(Surge::GUI::toOSCase("Compile Common Filter Kernels Into the Chain"), true,
+                       useFixed, [this, useFixed]() {
+                           synth->storage.useFixedFilterChains = !useFixed;
+                           Surge::Storage::updateUserDefaultValue(
+                               &(this->synth->storage), Surge::Storage::UseFixedFilterChains,
+                               !useFixed);
+                       });
+
     if (melatoninInspector)
     {
         devSubMenu.addItem("Close Melatonin Inspector", [this]() {
@@ -1925,6 +1986,9 @@ void SurgeGUIEditor::showSettingsMenu(const juce::Point<int> &where,
     auto tuningSubMenu = makeTuningMenu(where, false);
     settingsMenu.addSubMenu("Tuning", tuningSubMenu);
 
+    auto procSubMenu = makeProcessingMenu(where, false);
+    settingsMenu.addSubMenu("Processing", procSubMenu);
+
     settingsMenu.addSeparator();
 
 #if BUILD_IS_DEBUG
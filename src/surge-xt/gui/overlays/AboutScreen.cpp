@@ -26,6 +26,7 @@
 #include "version.h"
 #include "RuntimeFont.h"
 #include "SurgeImage.h"
+#include "CPUFeatures.h"
 #include "sst/plugininfra/paths.h"
 #include "sst/plugininfra/cpufeatures.h"
 #include <fmt/core.h>
@@ -183,9 +184,10 @@ void AboutScreen::populateData()
                     ramsize >= 1024 ? "GB" : "MB");
 
     const auto bitness = (sizeof(size_t) == 4 ? std::string("32") : std::string("64")) + "-bit";
-    const auto system = fmt::format("{} {}{} on {}, {}", platform, bitness,
-                                    wrapper == "Undefined" ? "" : " " + wrapper,
-                                    sst::plugininfra::cpufeatures::brand(), ramString);
+    const auto system = fmt::format(
+        "{} {}{} on {} ({}), {}", platform, bitness, wrapper == "Undefined" ? "" : " " + wrapper,
+        sst::plugininfra::cpufeatures::brand(),
+        Surge::CPUFeatures::simdLevelName(Surge::CPUFeatures::activeSIMDLevel()), ramString);
 
     lowerLeft.clear();
     lowerLeft.emplace_back("Version:", version, "");